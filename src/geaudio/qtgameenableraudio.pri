@@ -13,24 +13,43 @@ HEADERS  += \
     $${GE_PATH}/src/audiobuffer.h \
     $${GE_PATH}/src/audiobufferplayinstance.h \
     $${GE_PATH}/src/audiomixer.h \
+    $${GE_PATH}/src/audiocommandqueue.h \
+    $${GE_PATH}/src/audiovoice.h \
+    $${GE_PATH}/src/audiomixkernels.h \
+    $${GE_PATH}/src/audioringbuffer.h \
+    $${GE_PATH}/src/streamingaudiosource.h \
+    $${GE_PATH}/src/soundbank.h \
+    $${GE_PATH}/src/soundbankformat.h \
     $${GE_PATH}/src/audioout.h \
     $${GE_PATH}/src/pushaudioout.h \
     $${GE_PATH}/src/pullaudioout.h \
+    $${GE_PATH}/src/offlineaudioout.h \
     $${GE_PATH}/src/audiosourceif.h \
     $${GE_PATH}/src/audioeffect.h \
+    $${GE_PATH}/src/dspeffect.h \
+    $${GE_PATH}/src/dspkernels.h \
     $${GE_PATH}/src/echoeffect.h \
-    $${GE_PATH}/src/cutoffeffect.h
+    $${GE_PATH}/src/cutoffeffect.h \
+    $${GE_PATH}/src/filtereffect.h
 
 SOURCES += \
     $${GE_PATH}/src/audiobuffer.cpp \
     $${GE_PATH}/src/audiobufferplayinstance.cpp \
     $${GE_PATH}/src/audiomixer.cpp \
+    $${GE_PATH}/src/audiocommandqueue.cpp \
+    $${GE_PATH}/src/audiovoice.cpp \
+    $${GE_PATH}/src/audioringbuffer.cpp \
+    $${GE_PATH}/src/streamingaudiosource.cpp \
+    $${GE_PATH}/src/soundbank.cpp \
     $${GE_PATH}/src/pushaudioout.cpp \
     $${GE_PATH}/src/pullaudioout.cpp \
+    $${GE_PATH}/src/offlineaudioout.cpp \
     $${GE_PATH}/src/audiosourceif.cpp \
     $${GE_PATH}/src/audioeffect.cpp \
+    $${GE_PATH}/src/dspeffect.cpp \
     $${GE_PATH}/src/echoeffect.cpp \
-    $${GE_PATH}/src/cutoffeffect.cpp
+    $${GE_PATH}/src/cutoffeffect.cpp \
+    $${GE_PATH}/src/filtereffect.cpp
 
 QT += core gui
 
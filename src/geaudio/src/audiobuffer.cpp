@@ -11,6 +11,9 @@
 #include "audiobuffer.h"
 
 #include <QFile>
+#include <QVector>
+#include <stddef.h>
+#include <qmath.h>
 
 #include "audiobufferplayinstance.h"
 #include "audiomixer.h"
@@ -18,6 +21,10 @@
 
 using namespace GE;
 
+// Constants
+const int GESincTaps(16); // Per side, for the load time resampler
+const int GEGuardFrames(2); // Read past the end by the interpolation
+
 
 /*!
   Header for wav data
@@ -59,7 +66,10 @@ AudioBuffer::AudioBuffer(QObject *parent)
       m_nofChannels(0),
       m_bitsPerSample(0),
       m_signedData(false),
-      m_samplesPerSec(0)
+      m_nativeFormat(false),
+      m_ownsData(true),
+      m_samplesPerSec(0),
+      m_maxVoices(0)
 {
     DEBUG_INFO(this);
 }
@@ -80,9 +90,10 @@ AudioBuffer::~AudioBuffer()
 */
 void AudioBuffer::reallocate(int length)
 {
-    if (m_data)
+    if (m_data && m_ownsData)
         delete [] ((char*)m_data);
 
+    m_ownsData = true;
     m_dataLength = length;
 
     if (m_dataLength > 0)
@@ -95,11 +106,14 @@ void AudioBuffer::reallocate(int length)
 /*!
   Loads a .wav file from file with \a fileName. Note that this method can be
   used for loading .wav from Qt resources as well. If \a parent is given, it
-  is set as the parent of the constructed buffer.
+  is set as the parent of the constructed buffer. If \a convert is true, the
+  samples are converted with convertToNativeFormat(), which is better done
+  at load time than when the sound is first played.
 
   Returns a new buffer if successful, NULL otherwise.
 */
-AudioBuffer *AudioBuffer::loadWav(QString fileName, QObject *parent)
+AudioBuffer *AudioBuffer::loadWav(QString fileName, QObject *parent,
+                                  bool convert /* = false */)
 {
     QFile wavFile(fileName);
 
@@ -108,6 +122,8 @@ AudioBuffer *AudioBuffer::loadWav(QString fileName, QObject *parent)
 
         if (!buffer)
             DEBUG_INFO("Failed to load data from " << fileName << "!");
+        else if (convert && !buffer->convertToNativeFormat())
+            DEBUG_INFO("Failed to convert " << fileName << "!");
 
         wavFile.close();
         return buffer;
@@ -119,62 +135,93 @@ AudioBuffer *AudioBuffer::loadWav(QString fileName, QObject *parent)
 
 
 /*!
-  Protected method, called from AudioBuffer::loadWav(QString, QObject*).
+  Constructs a buffer that plays \a length bytes of \a data in place,
+  without a copy. The data must be in the native format of the mixer (see
+  convertToNativeFormat()), including the guard frames, with
+  \a nofChannels interleaved channels. The data must stay valid and
+  unchanged as long as the buffer exists.
+*/
+AudioBuffer *AudioBuffer::fromRawData(const void *data, int length,
+                                      short nofChannels,
+                                      QObject *parent /* = 0 */)
+{
+    if (!data || length < 1 || nofChannels < 1 || nofChannels > 2) {
+        DEBUG_INFO("Invalid raw data!");
+        return NULL;
+    }
 
-  Loads a .wav file from a preopened \a wavFile. If \a parent is given, it is
-  set as the parent of the constructed buffer.
+    AudioBuffer *buffer = new AudioBuffer(parent);
 
-  Returns a new buffer if successful, NULL otherwise.
+    // The buffer never writes to the data it does not own.
+    buffer->m_data = const_cast<void*>(data);
+    buffer->m_dataLength = length;
+    buffer->m_ownsData = false;
+    buffer->m_nofChannels = nofChannels;
+    buffer->m_bitsPerSample = 16;
+    buffer->m_signedData = true;
+    buffer->m_samplesPerSec = AUDIO_FREQUENCY;
+    buffer->m_nativeFormat = true;
+    setSampleFunction(*buffer);
+    return buffer;
+}
+
+
+/*!
+  Reads the header of the .wav file \a wavFile and stores its format to
+  \a nofChannels, \a bitsPerSample and \a samplesPerSec, and the length of
+  the sample data in bytes to \a dataLength. On success the file is left at
+  the beginning of the sample data.
+
+  Returns true if successful, false otherwise.
 */
-AudioBuffer *AudioBuffer::loadWav(QFile &wavFile, QObject *parent)
+bool AudioBuffer::readWavHeader(QFile &wavFile,
+                                short *nofChannels,
+                                short *bitsPerSample,
+                                int *samplesPerSec,
+                                qint64 *dataLength)
 {
     if (!wavFile.isOpen()) {
         // The file is not open!
         DEBUG_INFO("The given file must be opened before calling this method!");
-        return NULL;
+        return false;
     }
 
     SWavHeader header;
 
-    wavFile.read(header.chunkID, 4);
+    // The RIFF header and the format chunk are read in one go.
+    const qint64 formatLength = offsetof(SWavHeader, subchunk2id);
+
+    if (wavFile.read((char*)&header, formatLength) != formatLength)
+        return false;
 
     if (header.chunkID[0] != 'R' || header.chunkID[1] != 'I' ||
         header.chunkID[2] != 'F' || header.chunkID[3] != 'F') {
         // Incorrect header
-        return NULL;
+        return false;
     }
 
-    wavFile.read((char*)&header.chunkSize, 4);
-    wavFile.read((char*)&header.format, 4);
-
     if (header.format[0] != 'W' || header.format[1] != 'A' ||
         header.format[2] != 'V' || header.format[3] != 'E') {
         // Incorrect header
-        return NULL;
+        return false;
     }
 
-    wavFile.read((char*)&header.subchunk1id, 4);
-
     if (header.subchunk1id[0] != 'f' || header.subchunk1id[1] != 'm' ||
-        header.subchunk1id[2] != 't' || header.subchunk1id[3] != ' ') {
+        header.subchunk1id[2] != 't' || header.subchunk1id[3] != ' ' ||
+        header.subchunk1size < 16) {
         // Incorrect header
-        return NULL;
+        return false;
     }
 
-    wavFile.read((char*)&header.subchunk1size, 4);
-    wavFile.read((char*)&header.audioFormat, 2);
-    wavFile.read((char*)&header.nofChannels, 2);
-    wavFile.read((char*)&header.sampleRate, 4);
-    wavFile.read((char*)&header.byteRate, 4);
-    wavFile.read((char*)&header.blockAlign, 2);
-    wavFile.read((char*)&header.bitsPerSample, 2);
+    // Skip the extension of the format chunk, if any.
+    qint64 chunkEnd = 20 + header.subchunk1size;
 
     while (1) {
-        if (wavFile.read((char*)&header.subchunk2id, 4) != 4)
-            return NULL;
+        if (!wavFile.seek(chunkEnd))
+            return false;
 
-        if (wavFile.read((char*)&header.subchunk2size, 4) != 4)
-            return NULL;
+        if (wavFile.read((char*)&header.subchunk2id, 8) != 8)
+            return false;
 
         if (header.subchunk2id[0] == 'd' && header.subchunk2id[1] == 'a' &&
             header.subchunk2id[2] == 't' && header.subchunk2id[3] == 'a') {
@@ -182,31 +229,61 @@ AudioBuffer *AudioBuffer::loadWav(QFile &wavFile, QObject *parent)
             break;
         }
 
-        // This was not the data-chunk. Skip it.
+        // This was not the data-chunk. Skip it, chunks are word aligned.
         if (header.subchunk2size < 1) {
             // Error in file!
-            return NULL;
+            return false;
         }
 
-        char *unused = new char[header.subchunk2size];
-        wavFile.read(unused, header.subchunk2size);
-        delete [] unused;
+        chunkEnd = wavFile.pos() + header.subchunk2size +
+                   (header.subchunk2size & 1);
     }
 
-    // The data follows.
-    if (header.subchunk2size < 1)
+    *nofChannels = header.nofChannels;
+    *bitsPerSample = header.bitsPerSample;
+    *samplesPerSec = header.sampleRate;
+
+    // Writers that stream the file may leave the size of the chunk wrong.
+    *dataLength = qMin((qint64)header.subchunk2size,
+                       wavFile.size() - wavFile.pos());
+
+    return *dataLength > 0;
+}
+
+
+/*!
+  Protected method, called from AudioBuffer::loadWav(QString, QObject*).
+
+  Loads a .wav file from a preopened \a wavFile. If \a parent is given, it is
+  set as the parent of the constructed buffer.
+
+  Returns a new buffer if successful, NULL otherwise.
+*/
+AudioBuffer *AudioBuffer::loadWav(QFile &wavFile, QObject *parent)
+{
+    short nofChannels(0);
+    short bitsPerSample(0);
+    int samplesPerSec(0);
+    qint64 dataLength(0);
+
+    if (!readWavHeader(wavFile, &nofChannels, &bitsPerSample, &samplesPerSec,
+                       &dataLength)) {
         return NULL;
+    }
 
     // Construct the buffer.
     AudioBuffer *buffer = new AudioBuffer(parent);
 
-    buffer->m_nofChannels = header.nofChannels;
-    buffer->m_bitsPerSample = header.bitsPerSample;
-    buffer->m_samplesPerSec = header.sampleRate;
-    buffer->m_signedData = 0; // Where to look for this?
-    buffer->reallocate(header.subchunk2size);
+    buffer->m_nofChannels = nofChannels;
+    buffer->m_bitsPerSample = bitsPerSample;
+    buffer->m_samplesPerSec = samplesPerSec;
+    buffer->m_signedData = bitsPerSample != 8; // As per WAV format
+    buffer->reallocate(dataLength);
 
-    wavFile.read((char*)buffer->m_data, header.subchunk2size);
+    if (wavFile.read((char*)buffer->m_data, dataLength) != dataLength) {
+        delete buffer;
+        return NULL;
+    }
 
     // Select a good sampling function.
     if (!setSampleFunction(*buffer)) {
@@ -218,6 +295,119 @@ AudioBuffer *AudioBuffer::loadWav(QFile &wavFile, QObject *parent)
     return buffer;
 }
 
+/*!
+  Returns the windowed sinc kernel of the load time resampler at the
+  distance of \a x source frames, for the \a cutoff frequency relative to
+  the Nyquist frequency of the source.
+*/
+static qreal sincKernel(qreal x, qreal cutoff)
+{
+    const qreal taps = x * cutoff;
+
+    if (taps <= -GESincTaps || taps >= GESincTaps)
+        return 0;
+
+    // Blackman window over the taps.
+    const qreal window = 0.42 + 0.5 * qCos(M_PI * taps / GESincTaps) +
+                         0.08 * qCos(2 * M_PI * taps / GESincTaps);
+    const qreal phase = M_PI * taps;
+
+    if (qAbs(phase) < 1e-9)
+        return cutoff * window;
+
+    return cutoff * qSin(phase) / phase * window;
+}
+
+
+/*!
+  Converts the buffer to the native format of the mixer: signed 16-bit
+  samples at AUDIO_FREQUENCY, with the channels interleaved. Mono buffers
+  stay mono, and channels beyond the first two are dropped. Other sample
+  rates are converted with a windowed sinc resampler, which sounds better
+  than the linear interpolation of the mixer and leaves the mixer nothing
+  to interpolate at normal speed.
+
+  The buffer ends with guard frames repeating its first frames, so the
+  interpolation of the mixer can read past the last frame, and every
+  frame of the sound gets played and loops seamlessly.
+
+  Returns false if the format is not supported. Must not be called while
+  the buffer is being played.
+*/
+bool AudioBuffer::convertToNativeFormat()
+{
+    if (m_nativeFormat)
+        return true;
+
+    if (!m_sampleFunction || !m_data) {
+        DEBUG_INFO("Nothing to convert!");
+        return false;
+    }
+
+    const int channels = qMin((int)m_nofChannels, 2);
+    const int frames = m_dataLength / (m_nofChannels * getBytesPerSample());
+
+    if (frames < 1 || m_samplesPerSec <= 0)
+        return false;
+
+    // Decode the channels first to keep the resampler simple.
+    QVector<float> source(frames * channels);
+
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < channels; c++)
+            source[i * channels + c] = m_sampleFunction(this, i, c);
+    }
+
+    const qreal ratio = (qreal)m_samplesPerSec / AUDIO_FREQUENCY;
+    const int outFrames =
+        qMax(1, (int)((qint64)frames * AUDIO_FREQUENCY / m_samplesPerSec));
+    QVector<qint16> target((outFrames + GEGuardFrames) * channels);
+
+    if (m_samplesPerSec == AUDIO_FREQUENCY) {
+        for (int i = 0; i < frames * channels; i++)
+            target[i] = (qint16)source[i];
+    }
+    else {
+        // Downsampling lowers the cutoff to the new Nyquist frequency.
+        const qreal cutoff = qMin((qreal)1, 1 / ratio);
+        const qreal reach = GESincTaps / cutoff;
+
+        for (int i = 0; i < outFrames; i++) {
+            const qreal pos = i * ratio;
+            const int first = qMax(0, qCeil(pos - reach));
+            const int last = qMin(frames - 1, qFloor(pos + reach));
+
+            for (int c = 0; c < channels; c++) {
+                qreal sum = 0;
+
+                for (int j = first; j <= last; j++) {
+                    sum += source[j * channels + c] *
+                           sincKernel(pos - j, cutoff);
+                }
+
+                target[i * channels + c] =
+                    (qint16)qBound(-32768, qRound(sum), 32767);
+            }
+        }
+    }
+
+    for (int i = 0; i < GEGuardFrames * channels; i++) {
+        target[outFrames * channels + i] =
+            target[i % (outFrames * channels)];
+    }
+
+    reallocate(target.count() * sizeof(qint16));
+    memcpy(m_data, target.constData(), m_dataLength);
+
+    m_nofChannels = channels;
+    m_bitsPerSample = 16;
+    m_signedData = true;
+    m_samplesPerSec = AUDIO_FREQUENCY;
+    m_nativeFormat = true;
+    return setSampleFunction(*this);
+}
+
+
 // Mix to  mono versions.
 
 AUDIO_SAMPLE_TYPE AudioBuffer::sampleFunction8bitMono(AudioBuffer *buffer,
@@ -225,7 +415,7 @@ AUDIO_SAMPLE_TYPE AudioBuffer::sampleFunction8bitMono(AudioBuffer *buffer,
                                                       int channel)
 {
     Q_UNUSED(channel);
-    return (AUDIO_SAMPLE_TYPE)(((quint8*)(buffer->m_data))[pos] - 128) << 8;
+    return (AUDIO_SAMPLE_TYPE)((((quint8*)(buffer->m_data))[pos] - 128) * 256);
 }
 
 
@@ -234,7 +424,7 @@ AUDIO_SAMPLE_TYPE AudioBuffer::sampleFunction16bitMono(AudioBuffer *buffer,
                                                         int channel)
 {
     Q_UNUSED(channel);
-    return (AUDIO_SAMPLE_TYPE)(((quint16*)(buffer->m_data))[pos]);
+    return ((qint16*)(buffer->m_data))[pos];
 }
 
 
@@ -253,8 +443,9 @@ AUDIO_SAMPLE_TYPE AudioBuffer::sampleFunction8bitStereo(AudioBuffer *buffer,
                                                          int pos,
                                                          int channel)
 {
-    return ((AUDIO_SAMPLE_TYPE)
-        (((quint8*)(buffer->m_data))[pos * buffer->m_nofChannels + channel]) << 8);
+    return (AUDIO_SAMPLE_TYPE)
+        ((((quint8*)(buffer->m_data))[pos * buffer->m_nofChannels + channel] -
+          128) * 256);
 }
 
 
@@ -262,8 +453,7 @@ AUDIO_SAMPLE_TYPE AudioBuffer::sampleFunction16bitStereo(AudioBuffer *buffer,
                                                           int pos,
                                                           int channel)
 {
-    return (AUDIO_SAMPLE_TYPE)
-        (((quint16*)(buffer->m_data))[pos * buffer->m_nofChannels + channel]);
+    return ((qint16*)(buffer->m_data))[pos * buffer->m_nofChannels + channel];
 }
 
 
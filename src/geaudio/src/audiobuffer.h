@@ -36,10 +36,20 @@ class Q_GE_EXPORT AudioBuffer : public QObject
 public:
     explicit AudioBuffer(QObject *parent = 0);
     virtual ~AudioBuffer();
-    static AudioBuffer *loadWav(QString fileName, QObject *parent = 0);
+    static AudioBuffer *loadWav(QString fileName, QObject *parent = 0,
+                                bool convert = false);
+    static AudioBuffer *fromRawData(const void *data, int length,
+                                    short nofChannels, QObject *parent = 0);
+    static bool readWavHeader(QFile &wavFile,
+                              short *nofChannels,
+                              short *bitsPerSample,
+                              int *samplesPerSec,
+                              qint64 *dataLength);
 
 public:
     void reallocate(int length);
+    bool convertToNativeFormat();
+    inline bool isNativeFormat() const { return m_nativeFormat; }
 
     // Getters for raw sample data and sample details
     inline void* getRawData() { return m_data; }
@@ -50,6 +60,10 @@ public:
     inline short getNofChannels() { return m_nofChannels; }
     inline SAMPLE_FUNCTION_TYPE getSampleFunction() { return m_sampleFunction; }
 
+    // Polyphony limit for AudioMixer::playVoice(), 0 means no limit
+    inline int maxVoices() const { return m_maxVoices; }
+    inline void setMaxVoices(int count) { m_maxVoices = count; }
+
     // Static implementations of sample functions
     static AUDIO_SAMPLE_TYPE sampleFunction8bitMono(
         AudioBuffer *buffer, int pos, int channel);
@@ -72,12 +86,15 @@ protected:
 
 protected: // Data
     SAMPLE_FUNCTION_TYPE m_sampleFunction;
-    void *m_data; // Owned
+    void *m_data; // Owned, unless set with fromRawData()
     int m_dataLength; // In bytes
     short m_nofChannels;
     short m_bitsPerSample;
     bool m_signedData;
+    bool m_nativeFormat;
+    bool m_ownsData;
     int m_samplesPerSec;
+    int m_maxVoices;
 };
 
 } // namespace GE
@@ -11,12 +11,13 @@
 #include "audiobufferplayinstance.h"
 #include "audiobuffer.h"
 #include "audioeffect.h"
+#include "audiocommandqueue.h"
+#include "audiomixer.h"
 #include "trace.h"
 
 using namespace GE;
 
 // Constants
-const float GEMaxAudioSpeedValue(4096.0f);
 const float GEDefaultAudioVolume(1.0f); // 1.0 => 100 %
 const float GEDefaultAudioSpeed(1.0f); // 1.0 => 100 %
 
@@ -24,6 +25,10 @@ const float GEDefaultAudioSpeed(1.0f); // 1.0 => 100 %
 /*!
  * \class AudioBufferPlayInstance
  * \brief An AudioSource instance capable of playing a single audio buffer.
+ *
+ * Once the instance has been added to a mixer, the public slots only post
+ * commands to the mixer, and the playback state is changed on the audio
+ * thread at the start of the next block.
  */
 
 
@@ -33,16 +38,11 @@ const float GEDefaultAudioSpeed(1.0f); // 1.0 => 100 %
 AudioBufferPlayInstance::AudioBufferPlayInstance(AudioBuffer *buffer /* = 0 */,
                                                  QObject *parent /* = 0 */)
     : AudioSource(parent),
-      m_buffer(0),
+      m_leftVolume(GEDefaultAudioVolume),
+      m_rightVolume(GEDefaultAudioVolume),
       m_effect(0),
       m_finished(false),
-      m_destroyWhenFinished(true),
-      m_fixedPos(0),
-      m_fixedInc(0),
-      m_fixedLeftVolume((int)GEMaxAudioVolumeValue),
-      m_fixedRightVolume((int)GEMaxAudioVolumeValue),
-      m_fixedCenter(0),
-      m_loopCount(0)
+      m_destroyWhenFinished(true)
 {
     if (buffer) {
         // Start playing the given buffer.
@@ -64,10 +64,7 @@ AudioBufferPlayInstance::~AudioBufferPlayInstance()
 */
 bool AudioBufferPlayInstance::isPlaying() const
 {
-    if (m_buffer)
-        return true;
-
-    return false;
+    return m_voice.isPlaying();
 }
 
 
@@ -94,83 +91,22 @@ bool AudioBufferPlayInstance::canBeDestroyed()
 int AudioBufferPlayInstance::pullAudio(AUDIO_SAMPLE_TYPE *target,
                                        int bufferLength)
 {
-    if (!m_buffer) {
+    if (!m_voice.isPlaying()) {
         // No sample!
         return 0;
     }
 
-    int divider(m_buffer->getNofChannels() * m_buffer->getBytesPerSample());
-    int channelLength(0);
-
-    // Check in case of division by zero.
-    if (divider) {
-        channelLength = m_buffer->getDataLength() / divider - 2;
-    }
-    else {
-        DEBUG_INFO("Warning: Catched division by zero error!");
-    }
-
-    int samplesToWrite(bufferLength / 2);
-    int amount(0);
-    int totalMixed(0);
-
-
-    while (samplesToWrite > 0) {
-        int samplesLeft = channelLength - (m_fixedPos >> 12);
-
-        if (m_fixedInc == 0) {
-            // No speed set. Will lead to division by zero error if not set.
-            setSpeed(GEDefaultAudioSpeed);
-        }
+    int mixed = m_voice.pullAudio(target, bufferLength);
 
-        // This is how much we can mix at least.
-        int maxMixAmount = (int)(((long long int)(samplesLeft) << 12) /
-                                 m_fixedInc);
-
-        if (maxMixAmount > samplesToWrite) {
-            maxMixAmount = samplesToWrite;
-        }
-
-        if (maxMixAmount > 0) {
-            amount = mixBlock(target+totalMixed * 2, maxMixAmount);
-
-            if (amount == 0) {
-                // Error!
-                break;
-            }
-
-            totalMixed += amount;
-        }
-        else {
-            amount = 0;
-            m_fixedPos = channelLength<<12;
-        }
-
-        // The sample ended. Check the looping variables and see what to do.
-        if ((m_fixedPos >> 12) >= channelLength) {
-            m_fixedPos -= (channelLength << 12);
-
-            if (m_loopCount > 0)
-                m_loopCount--;
-
-            if (m_loopCount == 0) {
-                // No more loops, stop the sample and return the amount of
-                // samples already mixed.
-                stop();
-                break;
-            }
-        }
-
-        samplesToWrite -= amount;
-
-        if (samplesToWrite < 1)
-            break;
+    if (!m_voice.isPlaying()) {
+        // The last loop ended.
+        finish();
     }
 
     if (!m_effect.isNull())
-        return m_effect->process(target, totalMixed * 2);
+        return m_effect->process(target, mixed);
 
-    return totalMixed * 2;
+    return mixed;
 }
 
 
@@ -182,9 +118,10 @@ int AudioBufferPlayInstance::pullAudio(AUDIO_SAMPLE_TYPE *target,
 void AudioBufferPlayInstance::playBuffer(AudioBuffer *buffer,
                                          int loopCount /* = 0 */)
 {
-    m_buffer = buffer;
-    m_loopCount = loopCount;
-    m_fixedPos = 0;
+    AudioCommand command(AudioCommand::Play, this);
+    command.buffer = buffer;
+    command.count = loopCount;
+    post(command);
 }
 
 
@@ -199,8 +136,8 @@ void AudioBufferPlayInstance::playBuffer(AudioBuffer *buffer,
                                          float speed,
                                          int loopCount /* = 0 */)
 {
-    setLeftVolume(volume);
-    m_fixedRightVolume = m_fixedLeftVolume;
+    m_leftVolume = volume;
+    setRightVolume(volume);
     setSpeed(speed);
     playBuffer(buffer, loopCount);
 }
@@ -211,9 +148,7 @@ void AudioBufferPlayInstance::playBuffer(AudioBuffer *buffer,
 */
 void AudioBufferPlayInstance::stop()
 {
-    m_buffer = 0;
-    m_finished = true;
-    emit finished();
+    post(AudioCommand(AudioCommand::Stop, this));
 }
 
 
@@ -224,7 +159,9 @@ void AudioBufferPlayInstance::stop()
 void AudioBufferPlayInstance::setLoopCount(int count)
 {
     DEBUG_INFO("Setting the loop count to " << count);
-    m_loopCount = count;
+    AudioCommand command(AudioCommand::SetLoopCount, this);
+    command.count = count;
+    post(command);
 }
 
 
@@ -234,13 +171,9 @@ void AudioBufferPlayInstance::setLoopCount(int count)
 */
 void AudioBufferPlayInstance::setSpeed(float speed)
 {
-    if (!m_buffer)
-        return;
-
-    m_fixedInc =
-        (int)(((float)m_buffer->getSamplesPerSec() *
-               GEMaxAudioSpeedValue * speed) /
-              (float)AUDIO_FREQUENCY);
+    AudioCommand command(AudioCommand::SetSpeed, this);
+    command.value[0] = speed;
+    post(command);
 }
 
 
@@ -250,7 +183,12 @@ void AudioBufferPlayInstance::setSpeed(float speed)
 */
 void AudioBufferPlayInstance::setLeftVolume(float volume)
 {
-    m_fixedLeftVolume = (int)(GEMaxAudioVolumeValue * volume);
+    m_leftVolume = volume;
+
+    AudioCommand command(AudioCommand::SetVolume, this);
+    command.value[0] = m_leftVolume;
+    command.value[1] = m_rightVolume;
+    post(command);
 }
 
 
@@ -260,70 +198,63 @@ void AudioBufferPlayInstance::setLeftVolume(float volume)
 */
 void AudioBufferPlayInstance::setRightVolume(float volume)
 {
-    m_fixedRightVolume = (int)(GEMaxAudioVolumeValue * volume);
+    m_rightVolume = volume;
+
+    AudioCommand command(AudioCommand::SetVolume, this);
+    command.value[0] = m_leftVolume;
+    command.value[1] = m_rightVolume;
+    post(command);
 }
 
 
 /*!
-  TODO: Document this method.
-
-  Note: Does not do any bound checking, must be checked before called!
+  Posts \a command to the mixer playing the instance. Before the instance has
+  been added to a mixer, the command is applied immediately.
 */
-int AudioBufferPlayInstance::mixBlock(AUDIO_SAMPLE_TYPE *target,
-                                      int samplesToMix)
+void AudioBufferPlayInstance::post(const AudioCommand &command)
 {
-    SAMPLE_FUNCTION_TYPE sampleFunction = m_buffer->getSampleFunction();
-
-    if (!sampleFunction) {
-        // Unsupported sample type.
-        return 0;
-    }
-
-    AUDIO_SAMPLE_TYPE *t_target = target + samplesToMix * 2;
-    int sourcepos(0);
-
-    if (m_buffer->getNofChannels() == 2) {
-        // Stereo
-        while (target != t_target) {
-            sourcepos = m_fixedPos >> 12;
-
-            target[0] = (((((sampleFunction)
-                            (m_buffer, sourcepos, 0) *
-                            (4096 - (m_fixedPos & 4095)) +
-                            (sampleFunction)(m_buffer, sourcepos + 1, 0) *
-                            (m_fixedPos & 4095)) >> 12) *
-                          m_fixedLeftVolume) >> 12);
-
-            target[1] = (((((sampleFunction)
-                            (m_buffer, sourcepos, 1) *
-                            (4096 - (m_fixedPos & 4095)) +
-                            (sampleFunction)(m_buffer, sourcepos + 1, 1) *
-                            (m_fixedPos & 4095) ) >> 12) *
-                          m_fixedRightVolume) >> 12);
-
-            m_fixedPos += m_fixedInc;
-            target += 2;
-        }
-    }
-    else {
-        // Mono
-        int temp(0);
-
-        while (target != t_target) {
-            sourcepos = m_fixedPos >> 12;
+    if (m_mixer)
+        m_mixer->post(command);
+    else
+        applyCommand(command);
+}
 
-            temp = (((sampleFunction)(m_buffer, sourcepos, 0 ) *
-                     (4096 - (m_fixedPos & 4095)) +
-                     (sampleFunction)(m_buffer, sourcepos + 1, 0) *
-                     (m_fixedPos & 4095)) >> 12);
 
-            target[0] = ((temp * m_fixedLeftVolume) >> 12);
-            target[1] = ((temp * m_fixedRightVolume) >> 12);
+/*!
+  From AudioSource.
 
-            m_fixedPos += m_fixedInc;
-            target += 2;
-        }
+  Applies \a command to the playback state.
+*/
+void AudioBufferPlayInstance::applyCommand(const AudioCommand &command)
+{
+    switch (command.type) {
+    case AudioCommand::Play:
+        m_voice.play(command.buffer, command.count);
+        break;
+    case AudioCommand::Stop:
+        finish();
+        break;
+    case AudioCommand::SetLoopCount:
+        m_voice.setLoopCount(command.count);
+        break;
+    case AudioCommand::SetSpeed:
+        m_voice.setSpeed(command.value[0]);
+        break;
+    case AudioCommand::SetVolume:
+        m_voice.setVolume(command.value[0], command.value[1]);
+        break;
+    default:
+        break;
     }
+}
+
 
-    return samplesToMix;
+/*!
+  Gets rid of the buffer and signals that the playback has finished.
+*/
+void AudioBufferPlayInstance::finish()
+{
+    m_voice.stop();
+    m_finished = true;
+    emit finished();
 }
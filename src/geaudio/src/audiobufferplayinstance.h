@@ -15,6 +15,7 @@
 #include "geglobal.h"
 #include "audiosourceif.h"
 #include "audioeffect.h"
+#include "audiovoice.h"
 
 namespace GE {
 
@@ -53,23 +54,26 @@ public slots:
     void setRightVolume(float volume);
     void setEffect(AudioEffect *effect) { m_effect = effect; }
 
+protected: // From AudioSource
+    void applyCommand(const AudioCommand &command);
+
 protected:
-    int mixBlock(AUDIO_SAMPLE_TYPE *target, int bufferLength);
+    void post(const AudioCommand &command);
+    void finish();
 
 signals:
     void finished();
 
 protected: // Data
-    AudioBuffer *m_buffer; // Not owned
+    // Set by the game thread
+    float m_leftVolume;
+    float m_rightVolume;
+
+    // Used by the audio thread once the instance has been added to a mixer
+    AudioVoice m_voice;
     QPointer<AudioEffect> m_effect; // Not owned
     bool m_finished;
     bool m_destroyWhenFinished;
-    int m_fixedPos;
-    int m_fixedInc;
-    int m_fixedLeftVolume;
-    int m_fixedRightVolume;
-    int m_fixedCenter;
-    int m_loopCount;
 };
 
 } // namespace GE
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "audiocommandqueue.h"
+
+using namespace GE;
+
+
+/*!
+  \class AudioCommandQueue
+  \brief A fixed size single-producer/single-consumer ring buffer of audio
+         commands.
+
+  Usually the game thread pushes commands and the audio thread pops them;
+  the mixer also hands the finished sources back to the game thread through
+  a queue of its own. Neither side ever blocks: push() fails when the queue is full and pop() when it
+  is empty. One slot is always left free to tell a full queue from an empty
+  one.
+*/
+
+
+/*!
+  Constructor.
+*/
+AudioCommandQueue::AudioCommandQueue()
+    : m_head(0),
+      m_tail(0)
+{
+}
+
+
+/*!
+  Appends \a command to the queue. Returns false if the queue is full. Must
+  only be called from the producer thread.
+*/
+bool AudioCommandQueue::push(const AudioCommand &command)
+{
+    const int tail = m_tail.fetchAndAddRelaxed(0);
+    const int next = (tail + 1) & (Capacity - 1);
+
+    if (next == m_head.fetchAndAddAcquire(0))
+        return false;
+
+    m_commands[tail] = command;
+    m_tail.fetchAndStoreRelease(next);
+    return true;
+}
+
+
+/*!
+  Takes the oldest command of the queue into \a command. Returns false if the
+  queue is empty. Must only be called from the consumer thread.
+*/
+bool AudioCommandQueue::pop(AudioCommand &command)
+{
+    const int head = m_head.fetchAndAddRelaxed(0);
+
+    if (head == m_tail.fetchAndAddAcquire(0))
+        return false;
+
+    command = m_commands[head];
+    m_head.fetchAndStoreRelease((head + 1) & (Capacity - 1));
+    return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEAUDIOCOMMANDQUEUE_H
+#define GEAUDIOCOMMANDQUEUE_H
+
+#include <QAtomicInt>
+#include "geglobal.h"
+
+namespace GE {
+
+// Forward declarations
+class AudioSource;
+class AudioBuffer;
+
+
+struct AudioCommand
+{
+    enum Type {
+        AddSource,
+        RemoveSource,
+        DestroySources,
+        SetGeneralVolume,
+        Play,
+        Stop,
+        SetLoopCount,
+        SetSpeed,
+        SetVolume,
+        SourceFinished // From the audio thread, the source can be deleted
+    };
+
+    AudioCommand(Type type = Stop, AudioSource *source = 0)
+        : type(type), source(source), voice(0), buffer(0), count(0), frame(0)
+    {
+        value[0] = 0.0f;
+        value[1] = 0.0f;
+    }
+
+    Type type;
+    AudioSource *source;
+    quint32 voice; // Addresses a pooled voice instead of the source if set
+    AudioBuffer *buffer;
+    int count;
+    quint32 frame; // Mixer clock frame to start at, see AudioMixer::time()
+    float value[2];
+};
+
+
+class Q_GE_EXPORT AudioCommandQueue
+{
+public:
+    AudioCommandQueue();
+
+public:
+    bool push(const AudioCommand &command);
+    bool pop(AudioCommand &command);
+
+private:
+    enum { Capacity = 256 }; // Must be a power of two
+
+    AudioCommand m_commands[Capacity];
+    QAtomicInt m_head; // Written by the consumer only
+    QAtomicInt m_tail; // Written by the producer only
+};
+
+} // namespace GE
+
+#endif // GEAUDIOCOMMANDQUEUE_H
@@ -9,6 +9,9 @@
  */
 
 #include "audiomixer.h"
+#include "audiobuffer.h"
+#include "audiomixkernels.h"
+#include <QTimerEvent>
 #include <memory.h>
 #include "trace.h" // For debug macros
 
@@ -19,6 +22,29 @@ using namespace GE;
   \class AudioMixer
   \brief An AudioSource capable of combining all of its child sources into
          a single audio stream.
+
+  The mixer is driven from two threads. The game thread adds, removes and
+  controls the sources, and the audio thread calls pullAudio(). The game
+  thread never touches the source list: its requests are posted to a
+  single-producer/single-consumer command queue that pullAudio() drains at
+  the start of each block, so neither thread ever waits for the other. All
+  the requests must be made from the same (game) thread. The sources that
+  the audio thread removes, because they have finished or destroyList()
+  was called, go back to the game thread through a second queue and are
+  deleted there, see deleteFinishedSources().
+
+  Besides the sources, the mixer owns a fixed pool of MaxVoices voices for
+  short fire-and-forget sounds, see playVoice(). Playing a voice allocates
+  nothing on either thread. When the polyphony limit of the mixer or of the
+  played AudioBuffer is reached, a playing voice is stolen according to
+  voiceStealing(). The returned handles carry the generation of the voice,
+  so a handle of a voice that has ended or has been stolen is simply
+  ignored.
+
+  The voices can also be scheduled to start at a given time() of the
+  mixer clock, which counts the frames mixed. The mixer starts such a
+  voice at the exact frame inside the block, so sounds triggered together
+  keep their spacing regardless of the size of the output buffer.
 */
 
 
@@ -28,25 +54,57 @@ using namespace GE;
 AudioMixer::AudioMixer(QObject *parent)
     : AudioSource(parent),
       m_mixingBuffer(0),
+      m_mixBus(0),
       m_effect(0),
+      m_sourceCount(0),
       m_mixingBufferLength(0),
-      m_fixedGeneralVolume((int)GEMaxAudioVolumeValue)
+      m_fixedGeneralVolume((int)GEMaxAudioVolumeValue),
+      m_fixedMixVolume((int)GEMaxAudioVolumeValue),
+      m_maxVoices(MaxVoices),
+      m_voiceStealing(StealOldest),
+      m_startOrder(0),
+      m_clockFrame(0),
+      m_publishedClockFrame(0)
 {
     DEBUG_INFO(this);
+
+    m_releaseTimerId = startTimer(ReleaseInterval);
+
+    for (int i = 0; i < MaxVoices; i++) {
+        m_slots[i].buffer = 0;
+        m_slots[i].generation = 0;
+        m_slots[i].startOrder = 0;
+        m_slots[i].volume = 0.0f;
+    }
+
+    // Adding sources on the audio thread should not need to allocate.
+    m_sourceList.reserve(64);
+    m_releasedSources.reserve(64);
 }
 
 
 /*!
-  Destructor.
+  Destructor. The audio output using the mixer must have been stopped.
 */
 AudioMixer::~AudioMixer()
 {
-    destroyList();
+    // Take the sources still waiting in the queue into the list so that
+    // they get destroyed with the others.
+    processCommands();
+    deleteSources(false);
+
+    // The audio thread has stopped, the sources it has handed back can be
+    // deleted here directly.
+    deleteFinishedSources();
+    qDeleteAll(m_releasedSources);
+    m_releasedSources.clear();
 
     if (m_mixingBuffer) {
         delete [] m_mixingBuffer;
         m_mixingBuffer = 0;
     }
+
+    delete [] m_mixBus;
 }
 
 
@@ -70,8 +128,9 @@ float AudioMixer::generalVolume()
 
 
 /*!
-  Adds \a source to the list of audio sources. Returns true if the given audio
-  source was added into the list, false otherwise.
+  Queues \a source to be added to the list of audio sources. The mixer
+  takes the ownership of the source. Returns true if the source was queued,
+  false otherwise.
 */
 bool AudioMixer::addAudioSource(AudioSource *source)
 {
@@ -81,53 +140,467 @@ bool AudioMixer::addAudioSource(AudioSource *source)
         return false;
     }
 
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker); // To prevent warnings.
-    m_sourceList.push_back(source);
+    if (!post(AudioCommand(AudioCommand::AddSource, source))) {
+        return false;
+    }
+
+    source->m_mixer = this;
+    m_sourceCount.ref();
     return true;
 }
 
 
 /*!
-  Removes \a source from the list of audio sources. Returns true if
-  found and removed, false otherwise.
+  Queues \a source to be removed from the list of audio sources. Returns
+  true if the request was queued, false otherwise.
 
   Note: The removed item is not deleted!
 */
 bool AudioMixer::removeAudioSource(AudioSource *source)
 {
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker); // To prevent warnings
-    return m_sourceList.removeOne(source);
+    return post(AudioCommand(AudioCommand::RemoveSource, source));
 }
 
 
 /*!
-  Destroys all the sources in the list.
+  Queues the destruction of all the sources in the list.
 */
 void AudioMixer::destroyList()
 {
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker); // To prevent warnings
+    post(AudioCommand(AudioCommand::DestroySources));
+}
+
+
+/*!
+  Returns the audio source list count, including the sources still waiting
+  in the command queue.
+*/
+int AudioMixer::audioSourceCount()
+{
+    return m_sourceCount.fetchAndAddAcquire(0);
+}
+
+
+/*!
+  Posts \a command to the audio thread, which applies it at the start of
+  the next block. Returns false if the command queue is full, in which case
+  the command is dropped.
+*/
+bool AudioMixer::post(const AudioCommand &command)
+{
+    deleteFinishedSources();
+
+    if (!m_commands.push(command)) {
+        DEBUG_INFO("The command queue is full, dropping command"
+                   << command.type);
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+  Starts to play \a buffer on a voice of the pool with the given \a volume
+  and \a speed, 1.0 indicating 100 %. The buffer is repeated according to
+  \a loopCount, -1 meaning forever. Returns the handle of the voice, or 0 if
+  the voice could not be started.
+*/
+AudioVoiceHandle AudioMixer::playVoice(AudioBuffer *buffer,
+                                       float volume /* = 1.0f */,
+                                       float speed /* = 1.0f */,
+                                       int loopCount /* = 0 */)
+{
+    return playVoiceAt(time(), buffer, volume, speed, loopCount);
+}
+
+
+/*!
+  Like playVoice(), but starts the voice when the mixer clock reaches
+  \a time, in seconds of time(). A time already passed starts the voice at
+  the beginning of the next block. The voice occupies its slot while it
+  waits.
+*/
+AudioVoiceHandle AudioMixer::playVoiceAt(double time,
+                                         AudioBuffer *buffer,
+                                         float volume /* = 1.0f */,
+                                         float speed /* = 1.0f */,
+                                         int loopCount /* = 0 */)
+{
+    if (!buffer) {
+        DEBUG_INFO("The given buffer is NULL!");
+        return 0;
+    }
+
+    int slot = findVoiceSlot(buffer);
+
+    if (slot < 0) {
+        DEBUG_INFO("No voice available for buffer" << buffer);
+        return 0;
+    }
+
+    VoiceSlot &voiceSlot = m_slots[slot];
+    quint32 generation = (voiceSlot.generation + 1) & 0xffffff;
+
+    if (!generation)
+        generation = 1;
+
+    AudioCommand command(AudioCommand::Play);
+    command.voice = (generation << 8) | slot;
+    command.buffer = buffer;
+    command.count = loopCount;
+    command.value[0] = volume;
+    command.value[1] = speed;
+    command.frame = (quint32)qRound64(time * AUDIO_FREQUENCY);
+
+    if (!post(command))
+        return 0;
+
+    voiceSlot.buffer = buffer;
+    voiceSlot.generation = generation;
+    voiceSlot.startOrder = m_startOrder++;
+    voiceSlot.volume = volume;
+    return command.voice;
+}
+
+
+/*!
+  Returns the time of the mixer clock in seconds: the amount of audio mixed
+  so far. The clock runs ahead of what is heard by the latency of the audio
+  output, and wraps around after about 54 hours.
+*/
+double AudioMixer::time() const
+{
+    // QAtomicInt has no const load in Qt 4.
+    QAtomicInt &clock = const_cast<QAtomicInt&>(m_publishedClockFrame);
+    return (quint32)clock.fetchAndAddAcquire(0) / (double)AUDIO_FREQUENCY;
+}
+
 
+/*!
+  Returns true if the voice identified by \a voice is still playing.
+*/
+bool AudioMixer::isVoicePlaying(AudioVoiceHandle voice) const
+{
+    return slotOf(voice) >= 0;
+}
+
+
+/*!
+  Stops the voice identified by \a voice.
+*/
+void AudioMixer::stopVoice(AudioVoiceHandle voice)
+{
+    AudioCommand command(AudioCommand::Stop);
+    postToVoice(voice, command);
+}
+
+
+/*!
+  Sets the volume of the \a left and \a right channel of the voice
+  identified by \a voice.
+*/
+void AudioMixer::setVoiceVolume(AudioVoiceHandle voice, float left,
+                                float right)
+{
+    AudioCommand command(AudioCommand::SetVolume);
+    command.value[0] = left;
+    command.value[1] = right;
+
+    if (postToVoice(voice, command))
+        m_slots[voice & 0xff].volume = qMax(left, right);
+}
+
+
+/*!
+  Sets \a speed as the speed of the voice identified by \a voice.
+*/
+void AudioMixer::setVoiceSpeed(AudioVoiceHandle voice, float speed)
+{
+    AudioCommand command(AudioCommand::SetSpeed);
+    command.value[0] = speed;
+    postToVoice(voice, command);
+}
+
+
+/*!
+  Sets the loop count of the voice identified by \a voice to \a count.
+*/
+void AudioMixer::setVoiceLoopCount(AudioVoiceHandle voice, int count)
+{
+    AudioCommand command(AudioCommand::SetLoopCount);
+    command.count = count;
+    postToVoice(voice, command);
+}
+
+
+/*!
+  Sets the maximum amount of voices playing at the same time to \a count,
+  at most MaxVoices. The voices above the new limit are let to finish.
+*/
+void AudioMixer::setMaxVoices(int count)
+{
+    m_maxVoices = qBound(1, count, (int)MaxVoices);
+}
+
+
+/*!
+  Returns true if the voice last started in \a slot has not yet ended.
+*/
+bool AudioMixer::isSlotBusy(int slot) const
+{
+    // QAtomicInt has no const load in Qt 4.
+    QAtomicInt &ended = const_cast<QAtomicInt&>(m_endedGenerations[slot]);
+    return m_slots[slot].generation !=
+           (quint32)ended.fetchAndAddAcquire(0);
+}
+
+
+/*!
+  Returns the slot of \a voice, or -1 if the handle is invalid or the voice
+  has already ended.
+*/
+int AudioMixer::slotOf(AudioVoiceHandle voice) const
+{
+    int slot = voice & 0xff;
+
+    if (!voice || slot >= MaxVoices ||
+        m_slots[slot].generation != (voice >> 8) || !isSlotBusy(slot)) {
+        return -1;
+    }
+
+    return slot;
+}
+
+
+/*!
+  Returns the slot to play \a buffer in: a free slot if both the polyphony
+  limit of the buffer and of the mixer allow it, a stolen one otherwise.
+  Returns -1 if there is nothing to steal.
+*/
+int AudioMixer::findVoiceSlot(AudioBuffer *buffer) const
+{
+    int freeSlot = -1;
+    int playing = 0;
+    int playingBuffer = 0;
+
+    for (int i = 0; i < MaxVoices; i++) {
+        if (!isSlotBusy(i)) {
+            if (freeSlot < 0)
+                freeSlot = i;
+
+            continue;
+        }
+
+        playing++;
+
+        if (m_slots[i].buffer == buffer)
+            playingBuffer++;
+    }
+
+    // The voices of the same buffer are stolen first, so that a sound
+    // played rapidly does not cut off the others.
+    const bool bufferFull =
+        buffer->maxVoices() > 0 && playingBuffer >= buffer->maxVoices();
+
+    if (!bufferFull && playing < m_maxVoices && freeSlot >= 0)
+        return freeSlot;
+
+    int victim = -1;
+
+    for (int i = 0; i < MaxVoices; i++) {
+        if (!isSlotBusy(i) || (bufferFull && m_slots[i].buffer != buffer))
+            continue;
+
+        if (victim < 0) {
+            victim = i;
+        }
+        else if (m_voiceStealing == StealQuietest) {
+            if (m_slots[i].volume < m_slots[victim].volume)
+                victim = i;
+        }
+        else if ((qint32)(m_slots[i].startOrder -
+                          m_slots[victim].startOrder) < 0) {
+            victim = i;
+        }
+    }
+
+    return victim;
+}
+
+
+/*!
+  Posts \a command to the voice identified by \a voice. Returns false if
+  the voice has already ended or the command could not be queued.
+*/
+bool AudioMixer::postToVoice(AudioVoiceHandle voice, AudioCommand &command)
+{
+    if (slotOf(voice) < 0)
+        return false;
+
+    command.voice = voice;
+    return post(command);
+}
+
+
+/*!
+  Applies the commands posted by the game thread. Commands for sources that
+  are not in the list any more, for example ones that have already been
+  auto-destroyed, are ignored.
+*/
+void AudioMixer::processCommands()
+{
+    AudioCommand command;
+
+    while (m_commands.pop(command)) {
+        if (command.voice) {
+            applyVoiceCommand(command);
+            continue;
+        }
+
+        switch (command.type) {
+        case AudioCommand::AddSource:
+            m_sourceList.push_back(command.source);
+            break;
+        case AudioCommand::RemoveSource:
+            if (m_sourceList.removeOne(command.source))
+                m_sourceCount.deref();
+            break;
+        case AudioCommand::DestroySources:
+            deleteSources(true);
+            break;
+        case AudioCommand::SetGeneralVolume:
+            m_fixedMixVolume = command.count;
+            break;
+        default:
+            if (m_sourceList.contains(command.source))
+                command.source->applyCommand(command);
+            break;
+        }
+    }
+}
+
+
+/*!
+  Applies \a command to a voice of the pool. Commands for a previous
+  generation of the voice are ignored.
+*/
+void AudioMixer::applyVoiceCommand(const AudioCommand &command)
+{
+    const int slot = command.voice & 0xff;
+    const quint32 generation = command.voice >> 8;
+    AudioVoice &voice = m_voices[slot];
+
+    if (command.type == AudioCommand::Play) {
+        // Possibly steals the voice that was playing in the slot.
+        voice.setGeneration(generation);
+        voice.setVolume(command.value[0], command.value[0]);
+        voice.setSpeed(command.value[1]);
+        voice.play(command.buffer, command.count,
+                   qMax((qint32)(command.frame - m_clockFrame), 0));
+        return;
+    }
+
+    if (voice.generation() != generation || !voice.isPlaying())
+        return;
+
+    switch (command.type) {
+    case AudioCommand::Stop:
+        voice.stop();
+        m_endedGenerations[slot].fetchAndStoreRelease(generation);
+        break;
+    case AudioCommand::SetLoopCount:
+        voice.setLoopCount(command.count);
+        break;
+    case AudioCommand::SetSpeed:
+        voice.setSpeed(command.value[0]);
+        break;
+    case AudioCommand::SetVolume:
+        voice.setVolume(command.value[0], command.value[1]);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/*!
+  Destroys all the sources in the list. If \a later is true, which it must
+  be on the audio thread, the sources are handed back to the game thread
+  with releaseSource() and destroyed there.
+*/
+void AudioMixer::deleteSources(bool later)
+{
     QList<AudioSource*>::iterator iter;
 
     for (iter = m_sourceList.begin(); iter != m_sourceList.end(); iter++) {
-        delete *iter;
+        if (later)
+            releaseSource(*iter);
+        else
+            delete *iter;
     }
 
+    m_sourceCount.fetchAndAddOrdered(-m_sourceList.count());
     m_sourceList.clear();
 }
 
 
 /*!
-  Returns the audio source list count.
+  Hands \a source, which has been removed from the list, back to the game
+  thread to be deleted. Called on the audio thread, where deleting the
+  source or posting an event for it could allocate, block or take a lock.
+  If the queue is full, the source waits for room in a preallocated list.
 */
-int AudioMixer::audioSourceCount()
+void AudioMixer::releaseSource(AudioSource *source)
+{
+    if (!m_releasedSources.isEmpty() ||
+        !m_finishedSources.push(
+            AudioCommand(AudioCommand::SourceFinished, source)))
+        m_releasedSources.push_back(source);
+}
+
+
+/*!
+  Moves the sources waiting in the list into the queue of finished sources
+  as far as there is room. Called on the audio thread.
+*/
+void AudioMixer::flushReleasedSources()
+{
+    while (!m_releasedSources.isEmpty() &&
+           m_finishedSources.push(
+               AudioCommand(AudioCommand::SourceFinished,
+                            m_releasedSources.first())))
+        m_releasedSources.removeFirst();
+}
+
+
+/*!
+  Deletes the sources that the audio thread has handed back. Called on the
+  game thread when it posts a command, periodically from timerEvent(), and
+  from the destructor.
+*/
+void AudioMixer::deleteFinishedSources()
 {
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker); // To prevent warnings
-    return m_sourceList.count();
+    AudioCommand command;
+
+    while (m_finishedSources.pop(command))
+        delete command.source;
+}
+
+
+/*!
+  From QObject.
+
+  Deletes the finished sources on the game thread.
+*/
+void AudioMixer::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_releaseTimerId) {
+        AudioSource::timerEvent(event);
+        return;
+    }
+
+    deleteFinishedSources();
 }
 
 
@@ -139,25 +612,28 @@ int AudioMixer::audioSourceCount()
 */
 int AudioMixer::pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength)
 {
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker); // To prevent warnings
+    processCommands();
+    flushReleasedSources();
 
-    if (m_sourceList.isEmpty() && m_effect.isNull())
+    if (m_sourceList.isEmpty() && m_effect.isNull() && !hasPlayingVoices()) {
+        advanceClock(bufferLength);
         return 0;
+    }
 
     if (m_mixingBufferLength < bufferLength) {
         if (m_mixingBuffer)
             delete [] m_mixingBuffer;
 
+        delete [] m_mixBus;
+
         m_mixingBufferLength = bufferLength;
         m_mixingBuffer = new AUDIO_SAMPLE_TYPE[m_mixingBufferLength];
+        m_mixBus = new qint32[m_mixingBufferLength];
     }
 
-    memset(target, 0, sizeof(AUDIO_SAMPLE_TYPE) *bufferLength);
-
-    AUDIO_SAMPLE_TYPE *t;
-    AUDIO_SAMPLE_TYPE *t_target;
-    AUDIO_SAMPLE_TYPE *s;
+    // Everything is summed up in 32 bits and saturated only once at the
+    // end, so that loud overlapping sounds clip instead of wrapping around.
+    memset(m_mixBus, 0, sizeof(qint32) * bufferLength);
 
     QList<AudioSource*>::iterator iter(m_sourceList.begin());
 
@@ -165,38 +641,33 @@ int AudioMixer::pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength)
         if (!(*iter)) {
             // NULL pointer!
             DEBUG_INFO("Warning: stumbled on a null pointer!");
+            iter = m_sourceList.erase(iter);
             continue;
         }
 
         // Process the list item.
         int mixed = (*iter)->pullAudio(m_mixingBuffer, bufferLength);
 
-        if (mixed > 0) {
-            // Mix to main.
-            t = target;
-            t_target = t + mixed;
-            s = m_mixingBuffer;
-
-            while (t != t_target) {
-                *t += (((*s) * m_fixedGeneralVolume) >> 12);
-                t++;
-                s++;
-            }
-        }
+        if (mixed > 0)
+            mixFromBuffer(mixed);
 
         if ((*iter)->canBeDestroyed()) {
-            // Auto-destroy the current audio source.
-            //
-            // Note: The auto-destroy feature is undergoing testing and may
-            // cause unpredictable crashes with some use cases!
-            delete *iter;
+            // Auto-destroy the current audio source. The destructor runs on
+            // the game thread, as it may block or release resources that
+            // the audio thread must not wait for.
+            releaseSource(*iter);
             iter = m_sourceList.erase(iter);
+            m_sourceCount.deref();
         }
         else {
             iter++;
         }
     }
 
+    mixVoices(bufferLength);
+    MixKernels::saturate(target, m_mixBus, bufferLength);
+    advanceClock(bufferLength);
+
     if (!m_effect.isNull())
         return m_effect->process(target, bufferLength);
 
@@ -205,6 +676,68 @@ int AudioMixer::pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength)
 }
 
 
+/*!
+  Returns true if any voice of the pool is playing.
+*/
+bool AudioMixer::hasPlayingVoices() const
+{
+    for (int i = 0; i < MaxVoices; i++) {
+        if (m_voices[i].isPlaying())
+            return true;
+    }
+
+    return false;
+}
+
+
+/*!
+  Mixes \a bufferLength samples of the playing voices to the mixing bus,
+  and reports the voices that ended to the game thread.
+*/
+void AudioMixer::mixVoices(int bufferLength)
+{
+    for (int i = 0; i < MaxVoices; i++) {
+        AudioVoice &voice = m_voices[i];
+
+        if (!voice.isPlaying())
+            continue;
+
+        voice.mixAudio(m_mixBus, bufferLength, m_fixedMixVolume);
+
+        if (!voice.isPlaying())
+            m_endedGenerations[i].fetchAndStoreRelease(voice.generation());
+    }
+}
+
+
+/*!
+  Moves the mixer clock past the block of \a bufferLength samples and
+  publishes it to the game thread.
+*/
+void AudioMixer::advanceClock(int bufferLength)
+{
+    m_clockFrame += bufferLength / AUDIO_CHANNELS;
+    m_publishedClockFrame.fetchAndStoreRelease((int)m_clockFrame);
+}
+
+
+/*!
+  Adds \a length samples of the mixing buffer to the mixing bus with the
+  general volume.
+*/
+void AudioMixer::mixFromBuffer(int length)
+{
+    if (MixKernels::fitsInt16(m_fixedMixVolume)) {
+        MixKernels::accumulate16(m_mixBus, m_mixingBuffer, length,
+                                 m_fixedMixVolume, m_fixedMixVolume);
+        return;
+    }
+
+    for (int i = 0; i < length; i++)
+        m_mixBus[i] += (m_mixingBuffer[i] * m_fixedMixVolume) >> 12;
+}
+
+
 /*!
   Sets \a volume as the absolute volume.
 */
@@ -212,6 +745,7 @@ void AudioMixer::setAbsoluteVolume(float volume)
 {
     DEBUG_INFO(volume);
     m_fixedGeneralVolume = GEMaxAudioVolumeValue * volume;
+    postGeneralVolume();
     emit absoluteVolumeChanged(m_fixedGeneralVolume);
 }
 
@@ -235,6 +769,17 @@ void AudioMixer::setGeneralVolume(float volume)
             (GEMaxAudioVolumeValue / (float)audioSourceCount() * volume);
     }
 
+    postGeneralVolume();
     emit generalVolumeChanged(m_fixedGeneralVolume);
 }
 
+
+/*!
+  Passes the general volume set by the game thread to the audio thread.
+*/
+void AudioMixer::postGeneralVolume()
+{
+    AudioCommand command(AudioCommand::SetGeneralVolume);
+    command.count = m_fixedGeneralVolume;
+    post(command);
+}
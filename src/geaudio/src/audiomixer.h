@@ -11,10 +11,12 @@
 #ifndef GEAUDIOMIXER_H
 #define GEAUDIOMIXER_H
 
-#include <QMutex>
+#include <QAtomicInt>
 #include "geglobal.h"
 #include "audiosourceif.h"
 #include "audioeffect.h"
+#include "audiocommandqueue.h"
+#include "audiovoice.h"
 
 namespace GE {
 
@@ -22,6 +24,17 @@ class Q_GE_EXPORT AudioMixer : public AudioSource
 {
     Q_OBJECT
 
+public:
+    enum {
+        MaxVoices = 32, // Size of the voice pool
+        ReleaseInterval = 100 // Milliseconds between deleting finished sources
+    };
+
+    enum VoiceStealing {
+        StealOldest,
+        StealQuietest
+    };
+
 public:
     explicit AudioMixer(QObject *parent = 0);
     virtual ~AudioMixer();
@@ -34,6 +47,27 @@ public:
     void destroyList();
     int audioSourceCount();
     void setEffect(AudioEffect *effect) { m_effect = effect; }
+    bool post(const AudioCommand &command);
+
+    AudioVoiceHandle playVoice(AudioBuffer *buffer,
+                               float volume = 1.0f,
+                               float speed = 1.0f,
+                               int loopCount = 0);
+    AudioVoiceHandle playVoiceAt(double time,
+                                 AudioBuffer *buffer,
+                                 float volume = 1.0f,
+                                 float speed = 1.0f,
+                                 int loopCount = 0);
+    double time() const;
+    bool isVoicePlaying(AudioVoiceHandle voice) const;
+    void stopVoice(AudioVoiceHandle voice);
+    void setVoiceVolume(AudioVoiceHandle voice, float left, float right);
+    void setVoiceSpeed(AudioVoiceHandle voice, float speed);
+    void setVoiceLoopCount(AudioVoiceHandle voice, int count);
+    int maxVoices() const { return m_maxVoices; }
+    void setMaxVoices(int count);
+    VoiceStealing voiceStealing() const { return m_voiceStealing; }
+    void setVoiceStealing(VoiceStealing stealing) { m_voiceStealing = stealing; }
 
 public: // From AudioSource
     int pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength);
@@ -46,13 +80,65 @@ signals:
     void absoluteVolumeChanged(float volume);
     void generalVolumeChanged(float volume);
 
+protected: // From QObject
+    void timerEvent(QTimerEvent *event);
+
+protected:
+    void processCommands();
+    void applyVoiceCommand(const AudioCommand &command);
+    void deleteSources(bool later);
+    void releaseSource(AudioSource *source);
+    void flushReleasedSources();
+    void deleteFinishedSources();
+    void postGeneralVolume();
+    bool isSlotBusy(int slot) const;
+    int slotOf(AudioVoiceHandle voice) const;
+    int findVoiceSlot(AudioBuffer *buffer) const;
+    bool postToVoice(AudioVoiceHandle voice, AudioCommand &command);
+    bool hasPlayingVoices() const;
+    void mixVoices(int bufferLength);
+    void mixFromBuffer(int length);
+    void advanceClock(int bufferLength);
+
+private: // Data types
+    // Bookkeeping of a pooled voice on the game thread
+    struct VoiceSlot {
+        AudioBuffer *buffer;
+        quint32 generation;
+        quint32 startOrder;
+        float volume;
+    };
+
 protected: // Data
-    QList<AudioSource*> m_sourceList; // Owned
+    QList<AudioSource*> m_sourceList; // Owned, used by the audio thread only
     AUDIO_SAMPLE_TYPE *m_mixingBuffer; // Owned
+    qint32 *m_mixBus; // Owned, the sum of all the sources
     QPointer<AudioEffect> m_effect; // Not owned
-    QMutex m_mutex;
+    AudioCommandQueue m_commands;
+
+    // The sources that the audio thread has removed are deleted on the game
+    // thread. Those that do not fit into the queue wait in the list.
+    AudioCommandQueue m_finishedSources;
+    QList<AudioSource*> m_releasedSources; // Used by the audio thread only
+    int m_releaseTimerId;
+    QAtomicInt m_sourceCount;
     int m_mixingBufferLength;
-    int m_fixedGeneralVolume;
+    int m_fixedGeneralVolume; // Set by the game thread
+    int m_fixedMixVolume; // Used by the audio thread
+
+    // The voice pool. The game thread allocates the slots, the audio thread
+    // plays the voices and reports back the generation of the voice that
+    // ended last in each slot.
+    VoiceSlot m_slots[MaxVoices]; // Used by the game thread
+    AudioVoice m_voices[MaxVoices]; // Used by the audio thread
+    QAtomicInt m_endedGenerations[MaxVoices];
+    int m_maxVoices;
+    VoiceStealing m_voiceStealing;
+    quint32 m_startOrder;
+
+    // The mixer clock in frames, which the scheduled voices are started by.
+    quint32 m_clockFrame; // Used by the audio thread
+    QAtomicInt m_publishedClockFrame; // For reading on the game thread
 };
 
 } // namespace GE
@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEAUDIOMIXKERNELS_H
+#define GEAUDIOMIXKERNELS_H
+
+#include "geglobal.h"
+#include "audiosourceif.h"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define GE_MIX_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define GE_MIX_NEON
+#endif
+
+/*
+  The inner loops of the mixer. The samples are resampled with linear
+  interpolation in 4.12 fixed point, and the volumes are 4.12 fixed point
+  as well (4096 is 100 %). The mixer accumulates all its sources into a
+  32-bit bus, which is converted to AUDIO_SAMPLE_TYPE with saturation only
+  once, so overlapping sounds clip instead of wrapping around.
+*/
+
+namespace GE {
+namespace MixKernels {
+
+// Source formats. Each reads one sample of one channel as a 16-bit value.
+struct Pcm8 {
+    enum { Native = 0 };
+    typedef quint8 Type;
+    static inline int read(const quint8 *data) { return (*data - 128) * 256; }
+};
+
+struct Pcm16 {
+    enum { Native = 1 }; // Same as AUDIO_SAMPLE_TYPE
+    typedef qint16 Type;
+    static inline int read(const qint16 *data) { return *data; }
+};
+
+struct Float32 {
+    enum { Native = 0 };
+    typedef float Type;
+    static inline int read(const float *data)
+    {
+        const float value = *data * 32768.0f;
+
+        if (value >= 32767.0f)
+            return 32767;
+
+        if (value <= -32768.0f)
+            return -32768;
+
+        return (int)value;
+    }
+};
+
+
+// Output modes, storing to a 16-bit buffer or adding to the 32-bit bus.
+struct Store {
+    enum { Bus = 0 };
+    typedef AUDIO_SAMPLE_TYPE Type;
+    static inline void put(AUDIO_SAMPLE_TYPE *target, int value)
+    {
+        *target = (AUDIO_SAMPLE_TYPE)qBound(-32768, value, 32767);
+    }
+};
+
+struct Accumulate {
+    enum { Bus = 1 };
+    typedef qint32 Type;
+    static inline void put(qint32 *target, int value) { *target += value; }
+};
+
+
+/*
+  Resamples \a frames stereo frames from \a data, which has \a stride
+  samples per frame, to \a target, advancing \a fixedPos by \a fixedInc per
+  frame. Mono sources (Channels == 1) are played on both channels.
+
+  Note: Does not do any bound checking, must be checked before called!
+*/
+template <class Format, int Channels, class Output>
+inline void resample(const typename Format::Type *data, int stride,
+                     int &fixedPos, int fixedInc, int leftVolume,
+                     int rightVolume, typename Output::Type *target,
+                     int frames)
+{
+    const int right = Channels == 1 ? 0 : 1;
+    typename Output::Type *t_target = target + frames * 2;
+
+    while (target != t_target) {
+        const typename Format::Type *s = data + (fixedPos >> 12) * stride;
+        const int frac = fixedPos & 4095;
+
+        const int leftSample =
+            (Format::read(s) * (4096 - frac) +
+             Format::read(s + stride) * frac) >> 12;
+
+        Output::put(target, (leftSample * leftVolume) >> 12);
+
+        if (Channels == 1) {
+            Output::put(target + 1, (leftSample * rightVolume) >> 12);
+        }
+        else {
+            const int rightSample =
+                (Format::read(s + right) * (4096 - frac) +
+                 Format::read(s + stride + right) * frac) >> 12;
+
+            Output::put(target + 1, (rightSample * rightVolume) >> 12);
+        }
+
+        fixedPos += fixedInc;
+        target += 2;
+    }
+}
+
+
+inline bool fitsInt16(int value)
+{
+    return value >= -32768 && value <= 32767;
+}
+
+
+#if defined(GE_MIX_SSE2)
+
+// Returns (samples * gains) >> 12 for the low or high four samples.
+inline __m128i scaleLow(__m128i samples, __m128i gains)
+{
+    return _mm_srai_epi32(
+        _mm_unpacklo_epi16(_mm_mullo_epi16(samples, gains),
+                           _mm_mulhi_epi16(samples, gains)), 12);
+}
+
+inline __m128i scaleHigh(__m128i samples, __m128i gains)
+{
+    return _mm_srai_epi32(
+        _mm_unpackhi_epi16(_mm_mullo_epi16(samples, gains),
+                           _mm_mulhi_epi16(samples, gains)), 12);
+}
+
+#endif
+
+
+/*
+  Adds \a length interleaved stereo samples of \a source, scaled by
+  \a leftGain and \a rightGain, to \a bus. The gains must fit in 16 bits.
+  If \a mono is set, \a source has one sample per frame, which is played
+  on both channels.
+*/
+inline void accumulate16(qint32 *bus, const qint16 *source, int length,
+                         int leftGain, int rightGain, bool mono = false)
+{
+    int i = 0;
+
+#if defined(GE_MIX_SSE2)
+    const __m128i gains = _mm_set_epi16(rightGain, leftGain, rightGain,
+                                        leftGain, rightGain, leftGain,
+                                        rightGain, leftGain);
+
+    for (; i + 8 <= length; i += 8) {
+        __m128i samples;
+
+        if (mono) {
+            samples = _mm_loadl_epi64((const __m128i*)(source + i / 2));
+            samples = _mm_unpacklo_epi16(samples, samples);
+        }
+        else {
+            samples = _mm_loadu_si128((const __m128i*)(source + i));
+        }
+
+        __m128i *b = (__m128i*)(bus + i);
+        _mm_storeu_si128(b, _mm_add_epi32(_mm_loadu_si128(b),
+                                          scaleLow(samples, gains)));
+        _mm_storeu_si128(b + 1, _mm_add_epi32(_mm_loadu_si128(b + 1),
+                                              scaleHigh(samples, gains)));
+    }
+#elif defined(GE_MIX_NEON)
+    const int16_t gainValues[4] = { (int16_t)leftGain, (int16_t)rightGain,
+                                    (int16_t)leftGain, (int16_t)rightGain };
+    const int16x4_t gains = vld1_s16(gainValues);
+
+    for (; i + 8 <= length; i += 8) {
+        int16x4_t low;
+        int16x4_t high;
+
+        if (mono) {
+            const int16x4x2_t frames =
+                vzip_s16(vld1_s16(source + i / 2), vld1_s16(source + i / 2));
+            low = frames.val[0];
+            high = frames.val[1];
+        }
+        else {
+            low = vld1_s16(source + i);
+            high = vld1_s16(source + i + 4);
+        }
+
+        vst1q_s32(bus + i, vaddq_s32(vld1q_s32(bus + i),
+                                     vshrq_n_s32(vmull_s16(low, gains), 12)));
+        vst1q_s32(bus + i + 4,
+                  vaddq_s32(vld1q_s32(bus + i + 4),
+                            vshrq_n_s32(vmull_s16(high, gains), 12)));
+    }
+#endif
+
+    for (; i < length; i++) {
+        const int sample = mono ? source[i / 2] : source[i];
+        bus[i] += (sample * ((i & 1) ? rightGain : leftGain)) >> 12;
+    }
+}
+
+
+/*
+  The fast path of resample() for a step of exactly one source frame from a
+  whole frame position, where no interpolation is needed. Gives the same
+  result as resample().
+*/
+template <class Format, int Channels, class Output>
+inline void copyFrames(const typename Format::Type *data, int stride,
+                       int leftVolume, int rightVolume,
+                       typename Output::Type *target, int frames)
+{
+    if (Format::Native && Output::Bus && stride == Channels &&
+        fitsInt16(leftVolume) && fitsInt16(rightVolume)) {
+        accumulate16((qint32*)target, (const qint16*)data, frames * 2,
+                     leftVolume, rightVolume, Channels == 1);
+        return;
+    }
+
+    const int right = Channels == 1 ? 0 : 1;
+    typename Output::Type *t_target = target + frames * 2;
+
+    while (target != t_target) {
+        Output::put(target, (Format::read(data) * leftVolume) >> 12);
+        Output::put(target + 1,
+                    (Format::read(data + right) * rightVolume) >> 12);
+        data += stride;
+        target += 2;
+    }
+}
+
+
+/*
+  Converts \a length samples of the 32-bit \a bus to \a target, saturating
+  the values that do not fit.
+*/
+inline void saturate(AUDIO_SAMPLE_TYPE *target, const qint32 *bus, int length)
+{
+    int i = 0;
+
+#if defined(GE_MIX_SSE2)
+    for (; i + 8 <= length; i += 8) {
+        const __m128i low = _mm_loadu_si128((const __m128i*)(bus + i));
+        const __m128i high = _mm_loadu_si128((const __m128i*)(bus + i + 4));
+        _mm_storeu_si128((__m128i*)(target + i), _mm_packs_epi32(low, high));
+    }
+#elif defined(GE_MIX_NEON)
+    for (; i + 8 <= length; i += 8) {
+        vst1q_s16(target + i,
+                  vcombine_s16(vqmovn_s32(vld1q_s32(bus + i)),
+                               vqmovn_s32(vld1q_s32(bus + i + 4))));
+    }
+#endif
+
+    for (; i < length; i++)
+        target[i] = (AUDIO_SAMPLE_TYPE)qBound(-32768, bus[i], 32767);
+}
+
+} // namespace MixKernels
+} // namespace GE
+
+#endif // GEAUDIOMIXKERNELS_H
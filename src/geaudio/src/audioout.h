@@ -19,6 +19,8 @@ namespace GE {
 const QString GEDefaultAudioCodec("audio/pcm");
 const QAudioFormat::Endian GEByteOrder(QAudioFormat::LittleEndian);
 const QAudioFormat::SampleType GESampleType(QAudioFormat::SignedInt);
+const int GEDefaultAudioLatency(20); // Milliseconds
+const int GEDefaultBlockLength(1024); // Samples
 
 class AudioOut
 {
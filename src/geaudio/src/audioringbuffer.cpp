@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "audioringbuffer.h"
+#include <memory.h>
+
+using namespace GE;
+
+
+/*!
+  \class AudioRingBuffer
+  \brief A single-producer/single-consumer ring buffer of audio samples.
+
+  Like AudioCommandQueue, but copies blocks of samples at a time. Neither
+  side ever blocks: read() and write() transfer as many samples as are
+  available and return the amount.
+*/
+
+
+/*!
+  Constructor. The buffer holds at least \a capacity samples, the size is
+  rounded up to a power of two.
+*/
+AudioRingBuffer::AudioRingBuffer(int capacity)
+    : m_samples(0),
+      m_mask(1),
+      m_head(0),
+      m_tail(0)
+{
+    while (m_mask < capacity + 1)
+        m_mask <<= 1;
+
+    m_samples = new AUDIO_SAMPLE_TYPE[m_mask];
+    m_mask--;
+}
+
+
+/*!
+  Destructor.
+*/
+AudioRingBuffer::~AudioRingBuffer()
+{
+    delete [] m_samples;
+}
+
+
+/*!
+  Returns the amount of samples that can be read. Must only be called from
+  the consumer thread.
+*/
+int AudioRingBuffer::readAvailable() const
+{
+    return (m_tail.fetchAndAddAcquire(0) - m_head.fetchAndAddRelaxed(0)) &
+           m_mask;
+}
+
+
+/*!
+  Returns the amount of samples that can be written. Must only be called
+  from the producer thread.
+*/
+int AudioRingBuffer::writeAvailable() const
+{
+    return (m_head.fetchAndAddAcquire(0) - m_tail.fetchAndAddRelaxed(0) - 1) &
+           m_mask;
+}
+
+
+/*!
+  Reads at most \a count samples to \a target. Returns the amount read.
+  Must only be called from the consumer thread.
+*/
+int AudioRingBuffer::read(AUDIO_SAMPLE_TYPE *target, int count)
+{
+    const int head = m_head.fetchAndAddRelaxed(0);
+    count = qMin(count, readAvailable());
+
+    const int first = qMin(count, m_mask + 1 - head);
+    memcpy(target, m_samples + head, first * sizeof(AUDIO_SAMPLE_TYPE));
+    memcpy(target + first, m_samples,
+           (count - first) * sizeof(AUDIO_SAMPLE_TYPE));
+
+    m_head.fetchAndStoreRelease((head + count) & m_mask);
+    return count;
+}
+
+
+/*!
+  Writes at most \a count samples from \a source. Returns the amount
+  written. Must only be called from the producer thread.
+*/
+int AudioRingBuffer::write(const AUDIO_SAMPLE_TYPE *source, int count)
+{
+    const int tail = m_tail.fetchAndAddRelaxed(0);
+    count = qMin(count, writeAvailable());
+
+    const int first = qMin(count, m_mask + 1 - tail);
+    memcpy(m_samples + tail, source, first * sizeof(AUDIO_SAMPLE_TYPE));
+    memcpy(m_samples, source + first,
+           (count - first) * sizeof(AUDIO_SAMPLE_TYPE));
+
+    m_tail.fetchAndStoreRelease((tail + count) & m_mask);
+    return count;
+}
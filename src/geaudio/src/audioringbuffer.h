@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEAUDIORINGBUFFER_H
+#define GEAUDIORINGBUFFER_H
+
+#include <QAtomicInt>
+#include "geglobal.h"
+#include "audiosourceif.h"
+
+namespace GE {
+
+class Q_GE_EXPORT AudioRingBuffer
+{
+public:
+    explicit AudioRingBuffer(int capacity);
+    ~AudioRingBuffer();
+
+public:
+    inline int capacity() const { return m_mask; }
+    int readAvailable() const;
+    int writeAvailable() const;
+    int read(AUDIO_SAMPLE_TYPE *target, int count);
+    int write(const AUDIO_SAMPLE_TYPE *source, int count);
+
+private:
+    Q_DISABLE_COPY(AudioRingBuffer)
+
+    AUDIO_SAMPLE_TYPE *m_samples; // Owned
+    int m_mask; // The size of the buffer minus one
+    mutable QAtomicInt m_head; // Written by the consumer only
+    mutable QAtomicInt m_tail; // Written by the producer only
+};
+
+} // namespace GE
+
+#endif // GEAUDIORINGBUFFER_H
@@ -23,7 +23,8 @@ using namespace GE;
   Constructor.
 */
 AudioSource::AudioSource(QObject *parent /* = 0 */)
-    : QObject(parent)
+    : QObject(parent),
+      m_mixer(0)
 {
 }
 
@@ -47,3 +48,17 @@ bool AudioSource::canBeDestroyed()
 {
     return false;
 }
+
+
+/*!
+  Applies \a command, which the mixer has taken from its command queue, to
+  this source. Called on the audio thread at the start of a block, before
+  pullAudio().
+
+  To be implemented in the derived class. This default implementation does
+  nothing.
+*/
+void AudioSource::applyCommand(const AudioCommand &command)
+{
+    Q_UNUSED(command);
+}
@@ -24,6 +24,10 @@ namespace GE {
 // Constants
 const float GEMaxAudioVolumeValue(4096.0f);
 
+// Forward declarations
+class AudioMixer;
+struct AudioCommand;
+
 
 class AudioSource : public QObject
 {
@@ -34,8 +38,17 @@ public:
     virtual ~AudioSource();
 
 public:
+    inline AudioMixer *mixer() const { return m_mixer; }
     virtual bool canBeDestroyed();
     virtual int pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength ) = 0;
+
+protected:
+    virtual void applyCommand(const AudioCommand &command);
+
+protected: // Data
+    AudioMixer *m_mixer; // Not owned
+
+    friend class AudioMixer;
 };
 
 } // namespace GE
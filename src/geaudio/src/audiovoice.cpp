@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "audiovoice.h"
+#include "audiobuffer.h"
+#include "audiomixkernels.h"
+#include "trace.h"
+
+using namespace GE;
+
+// Constants
+const float GEMaxAudioSpeedValue(4096.0f);
+const float GEDefaultAudioSpeed(1.0f); // 1.0 => 100 %
+
+
+/*!
+  \class AudioVoice
+  \brief The playback state of a single audio buffer: the play position,
+         the speed, the volume and the loops left.
+
+  A voice is a plain value without any allocations, so that the mixer can
+  keep a fixed pool of them. AudioBufferPlayInstance wraps one voice into
+  an AudioSource. All the methods are meant to be called on the audio
+  thread.
+*/
+
+
+/*!
+  Constructor.
+*/
+AudioVoice::AudioVoice()
+    : m_buffer(0),
+      m_generation(0),
+      m_fixedPos(0),
+      m_fixedInc(0),
+      m_fixedLeftVolume((int)GEMaxAudioVolumeValue),
+      m_fixedRightVolume((int)GEMaxAudioVolumeValue),
+      m_loopCount(0),
+      m_delay(0),
+      m_speed(GEDefaultAudioSpeed)
+{
+}
+
+
+/*!
+  Starts to play \a buffer from the beginning and repeats it according to
+  \a loopCount. If the loop count is -1, the buffer is repeated forever.
+  The first \a delay frames rendered are silence, which lets the voice
+  start at an exact frame inside a block.
+*/
+void AudioVoice::play(AudioBuffer *buffer, int loopCount /* = 0 */,
+                      int delay /* = 0 */)
+{
+    m_buffer = buffer;
+    m_loopCount = loopCount;
+    m_delay = delay;
+    m_fixedPos = 0;
+    updateFixedInc();
+}
+
+
+/*!
+  Stops the playback.
+*/
+void AudioVoice::stop()
+{
+    m_buffer = 0;
+}
+
+
+/*!
+  Sets the loop count to \a count. If the argument value is -1, the
+  buffer is looped forever.
+*/
+void AudioVoice::setLoopCount(int count)
+{
+    m_loopCount = count;
+}
+
+
+/*!
+  Sets \a speed as the speed of which the buffer is played in, 1.0
+  indicates 100 %.
+*/
+void AudioVoice::setSpeed(float speed)
+{
+    m_speed = speed;
+    updateFixedInc();
+}
+
+
+/*!
+  Sets the volume of the \a left and \a right channel, 1.0 indicates 100 %.
+*/
+void AudioVoice::setVolume(float left, float right)
+{
+    m_fixedLeftVolume = (int)(GEMaxAudioVolumeValue * left);
+    m_fixedRightVolume = (int)(GEMaxAudioVolumeValue * right);
+}
+
+
+/*!
+  Writes at most \a bufferLength interleaved stereo samples of the buffer to
+  \a target and returns the amount written. When the last loop of the
+  buffer ends the voice stops, and isPlaying() returns false.
+*/
+int AudioVoice::pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength)
+{
+    return render<MixKernels::Store>(target, bufferLength, m_fixedLeftVolume,
+                                     m_fixedRightVolume);
+}
+
+
+/*!
+  Like pullAudio(), but adds the samples to the 32-bit mixing \a bus scaled
+  by \a gain (4096 is 100 %).
+*/
+int AudioVoice::mixAudio(qint32 *bus, int bufferLength, int gain)
+{
+    return render<MixKernels::Accumulate>(bus, bufferLength,
+                                          (m_fixedLeftVolume * gain) >> 12,
+                                          (m_fixedRightVolume * gain) >> 12);
+}
+
+
+/*!
+  Converts the playback speed to the fixed point increment of the play
+  position, which depends on the sample rate of the buffer.
+*/
+void AudioVoice::updateFixedInc()
+{
+    if (!m_buffer)
+        return;
+
+    m_fixedInc =
+        (int)(((float)m_buffer->getSamplesPerSec() *
+               GEMaxAudioSpeedValue * m_speed) /
+              (float)AUDIO_FREQUENCY);
+}
+
+
+/*!
+  Resamples \a frames stereo frames of \a data in the format given by
+  \a Format and \a Channels, taking the fast path when the play position
+  moves exactly one source frame per output frame.
+*/
+template <class Format, int Channels, class Output>
+static void mixFormat(const void *data, int stride, int &fixedPos,
+                      int fixedInc, int leftVolume, int rightVolume,
+                      typename Output::Type *target, int frames)
+{
+    const typename Format::Type *samples =
+        static_cast<const typename Format::Type*>(data);
+
+    if (fixedInc == 4096 && !(fixedPos & 4095)) {
+        MixKernels::copyFrames<Format, Channels, Output>(
+            samples + (fixedPos >> 12) * stride, stride, leftVolume,
+            rightVolume, target, frames);
+        fixedPos += frames << 12;
+    }
+    else {
+        MixKernels::resample<Format, Channels, Output>(
+            samples, stride, fixedPos, fixedInc, leftVolume, rightVolume,
+            target, frames);
+    }
+}
+
+
+/*!
+  Resamples \a samplesToMix stereo samples of the buffer into \a target with
+  linear interpolation, using the inner loop specialized for the format of
+  the buffer. Returns 0 if the format is not supported.
+
+  Note: Does not do any bound checking, must be checked before called!
+*/
+template <class Output>
+int AudioVoice::mixBlock(typename Output::Type *target, int samplesToMix,
+                         int leftVolume, int rightVolume)
+{
+    using namespace MixKernels;
+
+    const void *data = m_buffer->getRawData();
+    const int stride = m_buffer->getNofChannels();
+
+    switch (m_buffer->getBitsPerSample()) {
+    case 8:
+        if (stride == 1) {
+            mixFormat<Pcm8, 1, Output>(data, stride, m_fixedPos, m_fixedInc,
+                                       leftVolume, rightVolume, target,
+                                       samplesToMix);
+        }
+        else {
+            mixFormat<Pcm8, 2, Output>(data, stride, m_fixedPos, m_fixedInc,
+                                       leftVolume, rightVolume, target,
+                                       samplesToMix);
+        }
+        break;
+    case 16:
+        if (stride == 1) {
+            mixFormat<Pcm16, 1, Output>(data, stride, m_fixedPos, m_fixedInc,
+                                        leftVolume, rightVolume, target,
+                                        samplesToMix);
+        }
+        else {
+            mixFormat<Pcm16, 2, Output>(data, stride, m_fixedPos, m_fixedInc,
+                                        leftVolume, rightVolume, target,
+                                        samplesToMix);
+        }
+        break;
+    case 32:
+        if (stride == 1) {
+            mixFormat<Float32, 1, Output>(data, stride, m_fixedPos,
+                                          m_fixedInc, leftVolume,
+                                          rightVolume, target, samplesToMix);
+        }
+        else {
+            mixFormat<Float32, 2, Output>(data, stride, m_fixedPos,
+                                          m_fixedInc, leftVolume,
+                                          rightVolume, target, samplesToMix);
+        }
+        break;
+    default:
+        // Unsupported sample type.
+        return 0;
+    }
+
+    return samplesToMix;
+}
+
+
+/*!
+  Writes at most \a bufferLength interleaved stereo samples of the buffer to
+  \a target with the given volumes and returns the amount written. When
+  the last loop of the buffer ends the voice stops, and isPlaying() returns
+  false.
+*/
+template <class Output>
+int AudioVoice::render(typename Output::Type *target, int bufferLength,
+                       int leftVolume, int rightVolume)
+{
+    if (!m_buffer) {
+        // No sample!
+        return 0;
+    }
+
+    int divider(m_buffer->getNofChannels() * m_buffer->getBytesPerSample());
+    int channelLength(0);
+
+    // Check in case of division by zero.
+    if (divider) {
+        channelLength = m_buffer->getDataLength() / divider - 2;
+    }
+    else {
+        DEBUG_INFO("Warning: Catched division by zero error!");
+    }
+
+    if (channelLength <= 0) {
+        // Nothing to play, looping would never end.
+        stop();
+        return 0;
+    }
+
+    int samplesToWrite(bufferLength / 2);
+    int amount(0);
+    int totalMixed(0);
+
+    if (m_delay > 0) {
+        // The voice has not started yet.
+        totalMixed = qMin(m_delay, samplesToWrite);
+
+        for (int i = 0; i < totalMixed * 2; i++)
+            Output::put(target + i, 0);
+
+        m_delay -= totalMixed;
+        samplesToWrite -= totalMixed;
+    }
+
+    while (samplesToWrite > 0) {
+        int samplesLeft = channelLength - (m_fixedPos >> 12);
+
+        if (m_fixedInc == 0) {
+            // No speed set. Will lead to division by zero error if not set.
+            setSpeed(GEDefaultAudioSpeed);
+        }
+
+        // This is how much we can mix at least.
+        int maxMixAmount = (int)(((long long int)(samplesLeft) << 12) /
+                                 m_fixedInc);
+
+        if (maxMixAmount > samplesToWrite) {
+            maxMixAmount = samplesToWrite;
+        }
+
+        if (maxMixAmount > 0) {
+            amount = mixBlock<Output>(target + totalMixed * 2, maxMixAmount,
+                                      leftVolume, rightVolume);
+
+            if (amount == 0) {
+                // Unsupported format, the voice would never reach its end.
+                // Stop it so that the mixer releases its pool slot.
+                stop();
+                break;
+            }
+
+            totalMixed += amount;
+        }
+        else {
+            amount = 0;
+            m_fixedPos = channelLength << 12;
+        }
+
+        // The sample ended. Check the looping variables and see what to do.
+        if ((m_fixedPos >> 12) >= channelLength) {
+            m_fixedPos -= (channelLength << 12);
+
+            if (m_loopCount > 0)
+                m_loopCount--;
+
+            if (m_loopCount == 0) {
+                // No more loops, stop the sample and return the amount of
+                // samples already mixed.
+                stop();
+                break;
+            }
+        }
+
+        samplesToWrite -= amount;
+    }
+
+    return totalMixed * 2;
+}
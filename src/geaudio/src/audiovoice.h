@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEAUDIOVOICE_H
+#define GEAUDIOVOICE_H
+
+#include "geglobal.h"
+#include "audiosourceif.h"
+
+namespace GE {
+
+// Forward declarations
+class AudioBuffer;
+
+// Identifies a voice of an AudioMixer, see AudioMixer::playVoice().
+typedef quint32 AudioVoiceHandle;
+
+
+class Q_GE_EXPORT AudioVoice
+{
+public:
+    AudioVoice();
+
+public:
+    inline bool isPlaying() const { return m_buffer != 0; }
+    inline AudioBuffer *buffer() const { return m_buffer; }
+    inline quint32 generation() const { return m_generation; }
+    inline void setGeneration(quint32 generation) { m_generation = generation; }
+
+    void play(AudioBuffer *buffer, int loopCount = 0, int delay = 0);
+    void stop();
+    void setLoopCount(int count);
+    void setSpeed(float speed);
+    void setVolume(float left, float right);
+
+    int pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength);
+    int mixAudio(qint32 *bus, int bufferLength, int gain);
+
+protected:
+    void updateFixedInc();
+
+    template <class Output>
+    int render(typename Output::Type *target, int bufferLength,
+               int leftVolume, int rightVolume);
+
+    template <class Output>
+    int mixBlock(typename Output::Type *target, int samplesToMix,
+                 int leftVolume, int rightVolume);
+
+protected: // Data
+    AudioBuffer *m_buffer; // Not owned
+    quint32 m_generation;
+    int m_fixedPos;
+    int m_fixedInc;
+    int m_fixedLeftVolume;
+    int m_fixedRightVolume;
+    int m_loopCount;
+    int m_delay; // Frames of silence before the start
+    float m_speed;
+};
+
+} // namespace GE
+
+#endif // GEAUDIOVOICE_H
@@ -8,105 +8,76 @@
  * the distribution.
  */
 
-#include <math.h>
-#include <QMutexLocker>
+#include <memory.h>
 #include "cutoffeffect.h"
+#include "dspkernels.h"
 #include "trace.h"
 
 using namespace GE;
 
+/*!
+  \class CutOffEffect
+  \brief A resonant low-pass filter, a state variable filter in fixed
+         point. The cut-off and the resonance are changed smoothly.
+*/
+
 CutOffEffect::CutOffEffect(QObject *parent)
-    : AudioEffect(parent),
-      m_lp(NULL),
-      m_hp(NULL),
-      m_bp(NULL)
+    : DspEffect(parent),
+      m_cutOff(1.0f),
+      m_resonance(1.0f)
 {
     DEBUG_INFO(this);
-    setResonance(1.0f);
-    setCutOff(1.0f);
-    setup();
+    reset();
 }
 
 CutOffEffect::~CutOffEffect()
 {
     DEBUG_POINT;
-    delete []m_lp;
-    delete []m_hp;
-    delete []m_bp;
 }
 
 void CutOffEffect::setCutOff(float value)
 {
-    m_cutOff = value;
-    m_fixedCutOff = value * 4096.0f;
+    m_cutOff.setTarget(value);
 }
 
 float CutOffEffect::cutOff()
 {
-    return m_cutOff;
+    return m_cutOff.target();
 }
 
 void CutOffEffect::setResonance(float value)
 {
-    m_resonance = value;
-    m_fixedResonance = value * 4096.0f;
+    m_resonance.setTarget(value);
 }
 
 float CutOffEffect::resonance()
 {
-    return m_resonance;
+    return m_resonance.target();
 }
 
-void CutOffEffect::flush()
-{
-    setup();
-    AudioEffect::flush();
-}
+/*!
+  From DspEffect.
 
-void CutOffEffect::setup()
+  Clears the filter state.
+*/
+void CutOffEffect::reset()
 {
-    delete []m_lp;
-    m_lp = new int[AUDIO_CHANNELS];
-    memset(m_lp, 0, sizeof(int) * AUDIO_CHANNELS);
-    delete []m_bp;
-    m_bp = new int[AUDIO_CHANNELS];
-    memset(m_bp, 0, sizeof(int) * AUDIO_CHANNELS);
-    delete []m_hp;
-    m_hp = new int[AUDIO_CHANNELS];
-    memset(m_hp, 0, sizeof(int) * AUDIO_CHANNELS);
+    memset(m_lp, 0, sizeof(m_lp));
+    memset(m_bp, 0, sizeof(m_bp));
+    m_cutOff.jump();
+    m_resonance.jump();
 }
 
-int CutOffEffect::process(AUDIO_SAMPLE_TYPE *target, int bufferLength)
-{
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker);
-
-    AUDIO_SAMPLE_TYPE *p_max = target + bufferLength;
-    AUDIO_SAMPLE_TYPE *p = target;
-    int i, input;
-    qint64 pos = 0;
+/*!
+  From DspEffect.
 
-    while (p < p_max) {
-        for (i = 0; i < AUDIO_CHANNELS; i++) {
-            input = ((*p * (2047^(pos & 2047)) +
-                    *(p + AUDIO_CHANNELS) *
-                    (pos & 2047)) >> 11);
-            m_lp[i] += ((m_bp[i] * m_fixedCutOff) >> 12);
-            m_hp[i] = input - m_lp[i] - ((m_bp[i] * m_fixedResonance) >> 12);
-            m_bp[i] += ((m_hp[i] * m_fixedCutOff) >> 12);
-
-            input = m_lp[i];
-            if (input < -32767)
-                input = -32767;
-
-            if (input > 32767)
-                input = 32767;
-
-            *(p++) = input;
-        }
-        pos += 2048;
-    }
+  Filters \a frames frames of \a target in place.
+*/
+void CutOffEffect::processBlock(AUDIO_SAMPLE_TYPE *target, int frames)
+{
+    const float step = smoothing(frames);
+    const int cutOff = (int)(m_cutOff.next(step) * 4096.0f);
+    const int resonance = (int)(m_resonance.next(step) * 4096.0f);
 
-    return AudioEffect::process(target, bufferLength);
+    DspKernels::stateVariable(target, frames, cutOff, resonance, m_lp, m_bp);
 }
-
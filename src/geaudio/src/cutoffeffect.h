@@ -12,13 +12,12 @@
 #define CUTOFFEFFECT_H
 
 #include <QObject>
-#include <QMutex>
 #include "geglobal.h"
-#include "audioeffect.h"
+#include "dspeffect.h"
 
 namespace GE {
 
-class Q_GE_EXPORT CutOffEffect : public AudioEffect
+class Q_GE_EXPORT CutOffEffect : public DspEffect
 {
     Q_OBJECT
 
@@ -32,25 +31,17 @@ public:
     void setResonance(float value);
     float resonance();
 
-public:
-    void flush();
-    int process(AUDIO_SAMPLE_TYPE *target, int bufferLength);
-
-private:
-    void setup();
+protected: // From DspEffect
+    void reset();
+    void processBlock(AUDIO_SAMPLE_TYPE *target, int frames);
 
 private:
-    QMutex m_mutex;
-    float m_cutOff;
-    int m_fixedCutOff;
-    float m_resonance;
-    int m_fixedResonance;
-    int *m_lp;
-    int *m_hp;
-    int *m_bp;
+    DspParameter m_cutOff;
+    DspParameter m_resonance;
+    int m_lp[AUDIO_CHANNELS]; // Used by the audio thread
+    int m_bp[AUDIO_CHANNELS];
 };
 
 } // namespace GE
 
 #endif // CUTOFFEFFECT_H
-
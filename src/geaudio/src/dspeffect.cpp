@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "dspeffect.h"
+#include <math.h>
+#include <memory.h>
+#include "trace.h"
+
+using namespace GE;
+
+// Constants
+const float GEParameterSmoothingTime(0.02f); // Seconds
+
+
+/*!
+  \class DspParameter
+  \brief A parameter of a DspEffect, set by the game thread and followed
+         smoothly by the audio thread.
+
+  The target is stored atomically, so setting it never waits for the audio
+  thread. The audio thread moves the value towards the target once per
+  block, which avoids the clicks of sudden parameter changes.
+*/
+
+
+/*!
+  Constructor. Both the value and the target are set to \a value.
+*/
+DspParameter::DspParameter(float value /* = 0.0f */)
+    : m_value(value)
+{
+    setTarget(value);
+}
+
+
+/*!
+  Sets \a value as the target of the parameter.
+*/
+void DspParameter::setTarget(float value)
+{
+    int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    m_target.fetchAndStoreRelease(bits);
+}
+
+
+/*!
+  Returns the target of the parameter.
+*/
+float DspParameter::target() const
+{
+    // QAtomicInt has no const load in Qt 4.
+    const int bits = const_cast<QAtomicInt&>(m_target).fetchAndAddAcquire(0);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/*!
+  Moves the value towards the target by the fraction \a smoothing of the
+  difference and returns the new value.
+*/
+float DspParameter::next(float smoothing)
+{
+    const float target = this->target();
+
+    m_value += (target - m_value) * smoothing;
+
+    if (fabsf(target - m_value) <= fabsf(target) * 1.0e-4f)
+        m_value = target;
+
+    return m_value;
+}
+
+
+/*!
+  Sets the value to the target at once.
+*/
+void DspParameter::jump()
+{
+    m_value = target();
+}
+
+
+/*!
+  \class DspEffect
+  \brief The base of the effects processing whole blocks on the audio
+         thread without locks.
+
+  The parameters of the effects are DspParameter targets, and flush() only
+  requests the audio thread to clear the state at the start of the next
+  block. Subclasses implement reset() and processBlock().
+*/
+
+
+/*!
+  Constructor.
+*/
+DspEffect::DspEffect(QObject *parent /* = 0 */)
+    : AudioEffect(parent),
+      m_flushRequested(0)
+{
+}
+
+
+/*!
+  Destructor.
+*/
+DspEffect::~DspEffect()
+{
+}
+
+
+/*!
+  From AudioEffect.
+
+  Clears the state of the effect before the next block.
+*/
+void DspEffect::flush()
+{
+    m_flushRequested.fetchAndStoreRelease(1);
+    AudioEffect::flush();
+}
+
+
+/*!
+  From AudioEffect.
+
+  Processes \a bufferLength samples of \a target in place and passes them
+  on to the next effect.
+*/
+int DspEffect::process(AUDIO_SAMPLE_TYPE *target, int bufferLength)
+{
+    if (m_flushRequested.fetchAndStoreAcquire(0))
+        reset();
+
+    processBlock(target, bufferLength / AUDIO_CHANNELS);
+    return AudioEffect::process(target, bufferLength);
+}
+
+
+/*!
+  Returns the fraction of the distance the parameters move towards their
+  targets in a block of \a frames frames.
+*/
+float DspEffect::smoothing(int frames)
+{
+    return 1.0f - expf(-(float)frames /
+                       (GEParameterSmoothingTime * AUDIO_FREQUENCY));
+}
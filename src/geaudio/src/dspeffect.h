@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEDSPEFFECT_H
+#define GEDSPEFFECT_H
+
+#include <QAtomicInt>
+#include "geglobal.h"
+#include "audioeffect.h"
+
+namespace GE {
+
+class Q_GE_EXPORT DspParameter
+{
+public:
+    explicit DspParameter(float value = 0.0f);
+
+public:
+    // Game thread
+    void setTarget(float value);
+    float target() const;
+
+    // Audio thread
+    float next(float smoothing);
+    inline float value() const { return m_value; }
+    void jump();
+
+private:
+    QAtomicInt m_target; // The bits of a float
+    float m_value;
+};
+
+
+class Q_GE_EXPORT DspEffect : public AudioEffect
+{
+    Q_OBJECT
+
+public:
+    explicit DspEffect(QObject *parent = 0);
+    virtual ~DspEffect();
+
+public: // From AudioEffect
+    void flush();
+    int process(AUDIO_SAMPLE_TYPE *target, int bufferLength);
+
+protected:
+    virtual void reset() = 0;
+    virtual void processBlock(AUDIO_SAMPLE_TYPE *target, int frames) = 0;
+    static float smoothing(int frames);
+
+protected: // Data
+    QAtomicInt m_flushRequested;
+};
+
+} // namespace GE
+
+#endif // GEDSPEFFECT_H
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEDSPKERNELS_H
+#define GEDSPKERNELS_H
+
+#include "geglobal.h"
+#include "audiosourceif.h"
+#include "audiomixkernels.h"
+
+/*
+  The inner loops of the effects, each processing a whole block of
+  interleaved AUDIO_CHANNELS samples. The element-wise kernels are
+  vectorized with SSE2 or NEON. The recursive filters cannot be vectorized
+  over time, so they run all the channels of a frame side by side, which
+  the compiler can turn into one vector operation per step.
+*/
+
+namespace GE {
+namespace DspKernels {
+
+// Smaller filter states are flushed to zero to keep out of denormals.
+const float DenormalLimit(1.0e-15f);
+
+
+inline AUDIO_SAMPLE_TYPE saturate16(float value)
+{
+    if (value >= 32767.0f)
+        return 32767;
+
+    if (value <= -32768.0f)
+        return -32768;
+
+    return (AUDIO_SAMPLE_TYPE)value;
+}
+
+
+inline void flushDenormals(float *state, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (state[i] > -DenormalLimit && state[i] < DenormalLimit)
+            state[i] = 0.0f;
+    }
+}
+
+
+/*
+  Adds \a length samples of \a line scaled by \a gain (4.12 fixed point,
+  must fit in 16 bits) to \a target with saturation, and stores the result
+  back to \a line.
+*/
+inline void mixDelayed(AUDIO_SAMPLE_TYPE *target, AUDIO_SAMPLE_TYPE *line,
+                       int length, int gain)
+{
+    int i = 0;
+
+#if defined(GE_MIX_SSE2)
+    const __m128i gains = _mm_set1_epi16((short)gain);
+
+    for (; i + 8 <= length; i += 8) {
+        const __m128i delayed = _mm_loadu_si128((const __m128i*)(line + i));
+        const __m128i scaled =
+            _mm_packs_epi32(MixKernels::scaleLow(delayed, gains),
+                            MixKernels::scaleHigh(delayed, gains));
+        const __m128i result =
+            _mm_adds_epi16(_mm_loadu_si128((const __m128i*)(target + i)),
+                           scaled);
+
+        _mm_storeu_si128((__m128i*)(target + i), result);
+        _mm_storeu_si128((__m128i*)(line + i), result);
+    }
+#elif defined(GE_MIX_NEON)
+    const int16x4_t gains = vdup_n_s16((int16_t)gain);
+
+    for (; i + 8 <= length; i += 8) {
+        const int16x8_t delayed = vld1q_s16(line + i);
+        const int16x8_t scaled = vcombine_s16(
+            vqmovn_s32(vshrq_n_s32(vmull_s16(vget_low_s16(delayed), gains),
+                                   12)),
+            vqmovn_s32(vshrq_n_s32(vmull_s16(vget_high_s16(delayed), gains),
+                                   12)));
+        const int16x8_t result = vqaddq_s16(vld1q_s16(target + i), scaled);
+
+        vst1q_s16(target + i, result);
+        vst1q_s16(line + i, result);
+    }
+#endif
+
+    for (; i < length; i++) {
+        const int scaled = qBound(-32768, (line[i] * gain) >> 12, 32767);
+        target[i] = (AUDIO_SAMPLE_TYPE)qBound(-32768, target[i] + scaled,
+                                              32767);
+        line[i] = target[i];
+    }
+}
+
+
+/*
+  A feedback delay: adds the samples of the circular \a line of
+  \a lineLength samples, from \a index on, scaled by \a gain to the
+  \a length samples of \a target, and feeds the result back to the line.
+*/
+inline void feedbackDelay(AUDIO_SAMPLE_TYPE *target, AUDIO_SAMPLE_TYPE *line,
+                          int lineLength, int &index, int length, int gain)
+{
+    while (length > 0) {
+        // Up to the end of the line at a time. Each sample is read before
+        // it is written, so lines shorter than the block work too.
+        const int chunk = qMin(length, lineLength - index);
+
+        mixDelayed(target, line + index, chunk, gain);
+
+        target += chunk;
+        length -= chunk;
+        index += chunk;
+
+        if (index >= lineLength)
+            index = 0;
+    }
+}
+
+
+/*
+  The coefficients of a biquad filter, normalized with a0.
+*/
+struct BiquadCoefficients {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+
+/*
+  Filters \a frames frames of \a target in place with a biquad in the
+  transposed direct form II. \a state holds two values per channel.
+*/
+inline void biquad(AUDIO_SAMPLE_TYPE *target, int frames,
+                   const BiquadCoefficients &c, float *state)
+{
+    float *z1 = state;
+    float *z2 = state + AUDIO_CHANNELS;
+    AUDIO_SAMPLE_TYPE *t_target = target + frames * AUDIO_CHANNELS;
+
+    while (target != t_target) {
+        for (int ch = 0; ch < AUDIO_CHANNELS; ch++) {
+            const float x = target[ch];
+            const float y = c.b0 * x + z1[ch];
+
+            z1[ch] = c.b1 * x - c.a1 * y + z2[ch];
+            z2[ch] = c.b2 * x - c.a2 * y;
+            target[ch] = saturate16(y);
+        }
+
+        target += AUDIO_CHANNELS;
+    }
+
+    flushDenormals(state, AUDIO_CHANNELS * 2);
+}
+
+
+/*
+  Filters \a frames frames of \a target in place with a one-pole low-pass
+  filter, y += a * (x - y). \a state holds one value per channel.
+*/
+inline void onePole(AUDIO_SAMPLE_TYPE *target, int frames, float a,
+                    float *state)
+{
+    AUDIO_SAMPLE_TYPE *t_target = target + frames * AUDIO_CHANNELS;
+
+    while (target != t_target) {
+        for (int ch = 0; ch < AUDIO_CHANNELS; ch++) {
+            state[ch] += a * ((float)target[ch] - state[ch]);
+            target[ch] = saturate16(state[ch]);
+        }
+
+        target += AUDIO_CHANNELS;
+    }
+
+    flushDenormals(state, AUDIO_CHANNELS);
+}
+
+
+/*
+  Filters \a frames frames of \a target in place with the low-pass output
+  of a state variable filter. The \a cutOff and \a resonance are 4.12 fixed
+  point, \a lp and \a bp hold the state of each channel.
+*/
+inline void stateVariable(AUDIO_SAMPLE_TYPE *target, int frames, int cutOff,
+                          int resonance, int *lp, int *bp)
+{
+    AUDIO_SAMPLE_TYPE *t_target = target + frames * AUDIO_CHANNELS;
+
+    while (target != t_target) {
+        for (int ch = 0; ch < AUDIO_CHANNELS; ch++) {
+            lp[ch] += (bp[ch] * cutOff) >> 12;
+            const int hp = target[ch] - lp[ch] - ((bp[ch] * resonance) >> 12);
+            bp[ch] += (hp * cutOff) >> 12;
+            target[ch] = (AUDIO_SAMPLE_TYPE)qBound(-32767, lp[ch], 32767);
+        }
+
+        target += AUDIO_CHANNELS;
+    }
+}
+
+} // namespace DspKernels
+} // namespace GE
+
+#endif // GEDSPKERNELS_H
@@ -8,92 +8,106 @@
  * the distribution.
  */
 
-#include <math.h>
-#include <QMutexLocker>
+#include <memory.h>
 #include "echoeffect.h"
+#include "dspkernels.h"
 #include "trace.h"
 
+// Constants
+const float GEMaxEchoDelay(2.0f); // Seconds
+const int GEMaxEchoDelayInSamples(AUDIO_CHANNELS * (int)(AUDIO_FREQUENCY *
+                                                         GEMaxEchoDelay));
+
 using namespace GE;
 
+/*!
+  \class EchoEffect
+  \brief Repeats the audio after a delay of at most two seconds, decaying
+         by the given factor on each repeat.
+
+  The delay line is allocated once for the longest delay, so the delay can
+  be changed while the audio thread is running. Changing the delay clears
+  the line, and the decay is changed smoothly.
+*/
+
 EchoEffect::EchoEffect(QObject *parent)
-    : AudioEffect(parent),
-      m_delayBuffer(NULL)
+    : DspEffect(parent),
+      m_delayLine(new AUDIO_SAMPLE_TYPE[GEMaxEchoDelayInSamples]),
+      m_delay(1.0f),
+      m_decay(1.0f),
+      m_delayInSamples(0),
+      m_index(0)
 {
     DEBUG_INFO(this);
-
-    setDelay(1.0f);
-    setDecay(1.0f);
-    setupBuffer();
+    reset();
 }
 
 EchoEffect::~EchoEffect()
 {
-    delete []m_delayBuffer;
+    delete []m_delayLine;
 }
 
+/*!
+  Sets the delay to \a value seconds, at most two seconds.
+*/
 void EchoEffect::setDelay(float value)
 {
-    m_delay = value;
-    setupBuffer();
+    m_delay.setTarget(qBound(0.0f, value, GEMaxEchoDelay));
 }
 
 float EchoEffect::delay()
 {
-    return m_delay;
+    return m_delay.target();
 }
 
+/*!
+  Sets the decay of the repeats to \a value, 1.0 repeating the audio at
+  the full volume.
+*/
 void EchoEffect::setDecay(float value)
 {
-    m_decay = value;
-    m_fixedDecay = value * 4096;
+    m_decay.setTarget(value);
 }
 
 float EchoEffect::decay()
 {
-    return m_decay;
+    return m_decay.target();
 }
 
-void EchoEffect::flush()
-{
-    setupBuffer();
-    AudioEffect::flush();
-}
+/*!
+  From DspEffect.
 
-void EchoEffect::setupBuffer()
+  Clears the delay line.
+*/
+void EchoEffect::reset()
 {
-    DEBUG_POINT;
-
-    m_delayInSamples = AUDIO_CHANNELS * (int)(AUDIO_FREQUENCY * m_delay);
-
-    DEBUG_INFO("Setting delay to" << m_delayInSamples << "samples");
-
-    delete []m_delayBuffer;
-    m_delayBuffer = new AUDIO_SAMPLE_TYPE[m_delayInSamples];
-    memset(m_delayBuffer, 0, m_delayInSamples * sizeof(AUDIO_SAMPLE_TYPE));
+    memset(m_delayLine, 0, GEMaxEchoDelayInSamples * sizeof(AUDIO_SAMPLE_TYPE));
     m_index = 0;
+    m_decay.jump();
 }
 
-int EchoEffect::process(AUDIO_SAMPLE_TYPE *target, int bufferLength)
-{
-    QMutexLocker locker(&m_mutex);
-    Q_UNUSED(locker);
+/*!
+  From DspEffect.
 
-    if (!m_delayBuffer) {
-        setupBuffer();
-        if (!m_delayBuffer)
-            return 0;
+  Adds the delayed audio to \a frames frames of \a target, and feeds the
+  result back to the delay line.
+*/
+void EchoEffect::processBlock(AUDIO_SAMPLE_TYPE *target, int frames)
+{
+    const int delayInSamples =
+        AUDIO_CHANNELS * qMax(1, (int)(AUDIO_FREQUENCY * m_delay.target()));
+
+    if (delayInSamples != m_delayInSamples) {
+        DEBUG_INFO("Setting delay to" << delayInSamples << "samples");
+        m_delayInSamples = delayInSamples;
+        memset(m_delayLine, 0, m_delayInSamples * sizeof(AUDIO_SAMPLE_TYPE));
+        m_index = 0;
     }
 
-    AUDIO_SAMPLE_TYPE *max_p = target + bufferLength;
-    AUDIO_SAMPLE_TYPE *p = target;
-
-    while (p < max_p) {
-        *p += (AUDIO_SAMPLE_TYPE)((int)m_delayBuffer[m_index] * m_fixedDecay >> 12);
-        m_delayBuffer[m_index++] = *p;
-        if (m_index >= m_delayInSamples)
-            m_index = 0;
-        p++;
-    }
+    const int gain = qBound(-32768,
+                            (int)(m_decay.next(smoothing(frames)) * 4096.0f),
+                            32767);
 
-    return AudioEffect::process(target, bufferLength);
+    DspKernels::feedbackDelay(target, m_delayLine, m_delayInSamples, m_index,
+                              frames * AUDIO_CHANNELS, gain);
 }
@@ -12,13 +12,12 @@
 #define ECHOEFFECT_H
 
 #include <QObject>
-#include <QMutex>
 #include "geglobal.h"
-#include "audioeffect.h"
+#include "dspeffect.h"
 
 namespace GE {
 
-class Q_GE_EXPORT EchoEffect : public AudioEffect
+class Q_GE_EXPORT EchoEffect : public DspEffect
 {
     Q_OBJECT
 
@@ -32,20 +31,15 @@ public:
     void setDecay(float value);
     float decay();
 
-public:
-    void flush();
-    int process(AUDIO_SAMPLE_TYPE *target, int bufferLength);
-
-private:
-    void setupBuffer();
+protected: // From DspEffect
+    void reset();
+    void processBlock(AUDIO_SAMPLE_TYPE *target, int frames);
 
 private:
-    QMutex m_mutex;
-    AUDIO_SAMPLE_TYPE *m_delayBuffer;
-    float m_delay;
-    float m_decay;
-    int m_fixedDecay;
-    int m_delayInSamples;
+    AUDIO_SAMPLE_TYPE *m_delayLine; // Owned, for the longest delay
+    DspParameter m_delay;
+    DspParameter m_decay;
+    int m_delayInSamples; // Used by the audio thread
     int m_index;
 };
 
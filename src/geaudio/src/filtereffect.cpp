@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "filtereffect.h"
+#include <math.h>
+#include <memory.h>
+#include "dspkernels.h"
+#include "trace.h"
+
+using namespace GE;
+
+// Constants
+const float GEPi(3.14159265f);
+const float GEMinFilterFrequency(10.0f); // Hz
+const float GEMinFilterQ(0.1f);
+
+
+/*!
+  \class FilterEffect
+  \brief A low-pass, high-pass or band-pass biquad filter, or a one-pole
+         low-pass filter.
+
+  The coefficients are computed once per block from the smoothed frequency
+  and Q, so both can be swept without clicks. The Q is not used by the
+  one-pole filter.
+*/
+
+
+/*!
+  Constructor.
+*/
+FilterEffect::FilterEffect(Type type /* = LowPass */,
+                           QObject *parent /* = 0 */)
+    : DspEffect(parent),
+      m_type(type),
+      m_frequency(AUDIO_FREQUENCY / 4),
+      m_q(0.7071f)
+{
+    DEBUG_INFO(this);
+    reset();
+}
+
+
+/*!
+  Destructor.
+*/
+FilterEffect::~FilterEffect()
+{
+}
+
+
+/*!
+  Sets the cut-off or the center frequency to \a value Hz.
+*/
+void FilterEffect::setFrequency(float value)
+{
+    m_frequency.setTarget(value);
+}
+
+
+float FilterEffect::frequency()
+{
+    return m_frequency.target();
+}
+
+
+/*!
+  Sets the quality factor of the biquad filters to \a value, 0.7071 giving
+  a flat pass band.
+*/
+void FilterEffect::setQ(float value)
+{
+    m_q.setTarget(value);
+}
+
+
+float FilterEffect::q()
+{
+    return m_q.target();
+}
+
+
+/*!
+  From DspEffect.
+
+  Clears the filter state.
+*/
+void FilterEffect::reset()
+{
+    memset(m_state, 0, sizeof(m_state));
+    m_frequency.jump();
+    m_q.jump();
+}
+
+
+/*!
+  From DspEffect.
+
+  Filters \a frames frames of \a target in place.
+*/
+void FilterEffect::processBlock(AUDIO_SAMPLE_TYPE *target, int frames)
+{
+    const float step = smoothing(frames);
+    const float frequency = qBound(GEMinFilterFrequency,
+                                   m_frequency.next(step),
+                                   AUDIO_FREQUENCY * 0.49f);
+    const float w0 = 2.0f * GEPi * frequency / AUDIO_FREQUENCY;
+
+    if (m_type == OnePoleLowPass) {
+        DspKernels::onePole(target, frames, 1.0f - expf(-w0), m_state);
+        return;
+    }
+
+    // The biquads of the Audio EQ Cookbook by Robert Bristow-Johnson.
+    const float cosW0 = cosf(w0);
+    const float alpha = sinf(w0) / (2.0f * qMax(GEMinFilterQ, m_q.next(step)));
+    const float a0 = 1.0f + alpha;
+    DspKernels::BiquadCoefficients c;
+
+    switch (m_type) {
+    case HighPass:
+        c.b0 = (1.0f + cosW0) * 0.5f;
+        c.b1 = -(1.0f + cosW0);
+        c.b2 = c.b0;
+        break;
+    case BandPass:
+        c.b0 = alpha;
+        c.b1 = 0.0f;
+        c.b2 = -alpha;
+        break;
+    default:
+        c.b0 = (1.0f - cosW0) * 0.5f;
+        c.b1 = 1.0f - cosW0;
+        c.b2 = c.b0;
+        break;
+    }
+
+    c.b0 /= a0;
+    c.b1 /= a0;
+    c.b2 /= a0;
+    c.a1 = -2.0f * cosW0 / a0;
+    c.a2 = (1.0f - alpha) / a0;
+
+    DspKernels::biquad(target, frames, c, m_state);
+}
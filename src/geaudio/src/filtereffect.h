@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEFILTEREFFECT_H
+#define GEFILTEREFFECT_H
+
+#include <QObject>
+#include "geglobal.h"
+#include "dspeffect.h"
+
+namespace GE {
+
+class Q_GE_EXPORT FilterEffect : public DspEffect
+{
+    Q_OBJECT
+
+public:
+    enum Type {
+        LowPass, // Biquad filters
+        HighPass,
+        BandPass,
+        OnePoleLowPass
+    };
+
+public:
+    explicit FilterEffect(Type type = LowPass, QObject *parent = 0);
+    virtual ~FilterEffect();
+
+    inline Type type() const { return m_type; }
+
+    void setFrequency(float value);
+    float frequency();
+
+    void setQ(float value);
+    float q();
+
+protected: // From DspEffect
+    void reset();
+    void processBlock(AUDIO_SAMPLE_TYPE *target, int frames);
+
+private:
+    Type m_type;
+    DspParameter m_frequency; // In Hz
+    DspParameter m_q;
+    float m_state[AUDIO_CHANNELS * 2]; // Used by the audio thread
+};
+
+} // namespace GE
+
+#endif // GEFILTEREFFECT_H
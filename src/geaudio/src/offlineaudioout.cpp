@@ -0,0 +1,245 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "offlineaudioout.h"
+#include <QTimerEvent>
+#include <QtEndian>
+#include <memory.h>
+#include "trace.h" // For debug macros
+
+// Constants
+const int GEWavHeaderLength(44); // Bytes
+
+using namespace GE;
+
+
+/*!
+  \class OfflineAudioOut
+  \brief An AudioOut without an audio device, pulling the audio from the
+         source as fast as it is asked to.
+
+  The rendered audio can be written to a .wav file, and the time spent in
+  the source is measured for every block, so the output serves for
+  performance and golden output tests on machines with no sound card.
+  By default the blocks are rendered with tick() or render(); with
+  setRealtime() the output keeps in step with the wall clock instead, like
+  a real device would.
+*/
+
+
+/*!
+  Constructor. The audio is pulled from \a source in blocks of
+  \a blockLength samples.
+*/
+OfflineAudioOut::OfflineAudioOut(AudioSource *source,
+                                 QObject *parent /* = 0 */,
+                                 int blockLength /* = GEDefaultBlockLength */)
+    : QObject(parent),
+      m_source(source),
+      m_block(0),
+      m_blockLength(qMax(blockLength - blockLength % AUDIO_CHANNELS,
+                         AUDIO_CHANNELS)),
+      m_samplesRendered(0),
+      m_wavDataLength(0),
+      m_timerId(0),
+      m_clockStart(0),
+      m_blockCount(0),
+      m_lastMixTime(0),
+      m_totalMixTime(0),
+      m_maxMixTime(0)
+{
+    DEBUG_INFO(this);
+    m_block = new AUDIO_SAMPLE_TYPE[m_blockLength];
+}
+
+
+/*!
+  Destructor. Completes the .wav file if one is being written.
+*/
+OfflineAudioOut::~OfflineAudioOut()
+{
+    closeWavFile();
+    delete [] m_block;
+}
+
+
+/*!
+  Pulls one block from the source and writes it to the .wav file, if set.
+  The part of the block the source does not fill is silence.
+*/
+void OfflineAudioOut::tick()
+{
+    if (m_source.isNull()) {
+        DEBUG_INFO("No audio source!");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const int mixedSamples = qMax(m_source->pullAudio(m_block, m_blockLength),
+                                  0);
+    m_lastMixTime = timer.nsecsElapsed();
+
+    if (mixedSamples < m_blockLength) {
+        memset(m_block + mixedSamples, 0,
+               (m_blockLength - mixedSamples) * sizeof(AUDIO_SAMPLE_TYPE));
+    }
+
+    m_blockCount++;
+    m_totalMixTime += m_lastMixTime;
+    m_maxMixTime = qMax(m_maxMixTime, m_lastMixTime);
+    m_samplesRendered += m_blockLength;
+
+    if (m_wavFile.isOpen()) {
+        const qint64 bytes = m_blockLength * sizeof(AUDIO_SAMPLE_TYPE);
+
+        if (m_wavFile.write((const char*)m_block, bytes) == bytes) {
+            m_wavDataLength += bytes;
+        }
+        else {
+            DEBUG_INFO("Failed to write the .wav file, closing it.");
+            closeWavFile();
+        }
+    }
+}
+
+
+/*!
+  Renders at least \a length samples, rounded up to whole blocks, as fast
+  as possible. Returns the amount of samples rendered.
+*/
+qint64 OfflineAudioOut::render(qint64 length)
+{
+    const qint64 start = m_samplesRendered;
+
+    while (m_samplesRendered - start < length && !m_source.isNull())
+        tick();
+
+    return m_samplesRendered - start;
+}
+
+
+/*!
+  Starts to write the rendered audio to the .wav file \a fileName. Returns
+  true if successful, false otherwise.
+*/
+bool OfflineAudioOut::setWavFile(const QString &fileName)
+{
+    closeWavFile();
+    m_wavFile.setFileName(fileName);
+
+    if (!m_wavFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        DEBUG_INFO("Failed to open " << fileName << ": "
+                   << m_wavFile.errorString());
+        return false;
+    }
+
+    if (!writeWavHeader(0)) {
+        m_wavFile.close();
+        return false;
+    }
+
+    m_wavDataLength = 0;
+    return true;
+}
+
+
+/*!
+  Completes the header of the .wav file being written and closes it.
+*/
+void OfflineAudioOut::closeWavFile()
+{
+    if (!m_wavFile.isOpen())
+        return;
+
+    if (!m_wavFile.seek(0) || !writeWavHeader(m_wavDataLength))
+        DEBUG_INFO("Failed to complete the .wav file!");
+
+    m_wavFile.close();
+}
+
+
+/*!
+  If \a realtime is true, renders the audio in step with the wall clock
+  instead of with tick(), for running the game without an audio device.
+*/
+void OfflineAudioOut::setRealtime(bool realtime)
+{
+    if (realtime == (m_timerId != 0))
+        return;
+
+    if (realtime) {
+        m_clock.start();
+        m_clockStart = m_samplesRendered;
+        m_timerId = startTimer(GEDefaultAudioLatency);
+    }
+    else {
+        killTimer(m_timerId);
+        m_timerId = 0;
+    }
+}
+
+
+/*!
+  Clears the mix time statistics.
+*/
+void OfflineAudioOut::resetStatistics()
+{
+    m_blockCount = 0;
+    m_lastMixTime = 0;
+    m_totalMixTime = 0;
+    m_maxMixTime = 0;
+}
+
+
+/*!
+  From QObject.
+
+  Renders the blocks that are due by the wall clock.
+*/
+void OfflineAudioOut::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_timerId) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    const qint64 due = m_clock.elapsed() * AUDIO_FREQUENCY / 1000 *
+                       AUDIO_CHANNELS;
+
+    render(m_clockStart + due - m_samplesRendered);
+}
+
+
+/*!
+  Writes the header of a 16-bit .wav file of the mixer format with
+  \a dataLength bytes of samples at the current position of the file.
+*/
+bool OfflineAudioOut::writeWavHeader(qint64 dataLength)
+{
+    const int frameBytes = AUDIO_CHANNELS * sizeof(AUDIO_SAMPLE_TYPE);
+    uchar header[GEWavHeaderLength];
+
+    memcpy(header, "RIFF", 4);
+    qToLittleEndian<quint32>(GEWavHeaderLength - 8 + dataLength, header + 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, header + 16);
+    qToLittleEndian<quint16>(1, header + 20); // PCM
+    qToLittleEndian<quint16>(AUDIO_CHANNELS, header + 22);
+    qToLittleEndian<quint32>(AUDIO_FREQUENCY, header + 24);
+    qToLittleEndian<quint32>(AUDIO_FREQUENCY * frameBytes, header + 28);
+    qToLittleEndian<quint16>(frameBytes, header + 32);
+    qToLittleEndian<quint16>(sizeof(AUDIO_SAMPLE_TYPE) * 8, header + 34);
+    memcpy(header + 36, "data", 4);
+    qToLittleEndian<quint32>(dataLength, header + 40);
+
+    return m_wavFile.write((const char*)header, GEWavHeaderLength) ==
+           GEWavHeaderLength;
+}
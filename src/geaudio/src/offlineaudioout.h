@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GEOFFLINEAUDIOOUT_H
+#define GEOFFLINEAUDIOOUT_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QPointer>
+#include "geglobal.h"
+#include "audioout.h"
+
+namespace GE {
+
+class Q_GE_EXPORT OfflineAudioOut : public QObject,
+                                    public AudioOut
+{
+    Q_OBJECT
+
+public:
+    OfflineAudioOut(AudioSource *source, QObject *parent = 0,
+                    int blockLength = GEDefaultBlockLength);
+    virtual ~OfflineAudioOut();
+
+public:
+    bool needsManualTick() const { return m_timerId == 0; }
+    void tick();
+    qint64 render(qint64 length);
+
+    bool setWavFile(const QString &fileName);
+    void closeWavFile();
+    void setRealtime(bool realtime);
+
+    inline int blockLength() const { return m_blockLength; }
+    inline qint64 samplesRendered() const { return m_samplesRendered; }
+
+    // Time spent in pullAudio() of the source, in nanoseconds
+    inline int blockCount() const { return m_blockCount; }
+    inline qint64 lastMixTime() const { return m_lastMixTime; }
+    inline qint64 totalMixTime() const { return m_totalMixTime; }
+    inline qint64 maxMixTime() const { return m_maxMixTime; }
+    void resetStatistics();
+
+protected: // From QObject
+    void timerEvent(QTimerEvent *event);
+
+protected:
+    bool writeWavHeader(qint64 dataLength);
+
+protected: // Data
+    QPointer<AudioSource> m_source; // Not owned
+    AUDIO_SAMPLE_TYPE *m_block; // Owned
+    int m_blockLength;
+    qint64 m_samplesRendered;
+    QFile m_wavFile;
+    qint64 m_wavDataLength; // In bytes
+    int m_timerId; // Renders in real time if set
+    QElapsedTimer m_clock;
+    qint64 m_clockStart; // Samples rendered when the clock started
+    int m_blockCount;
+    qint64 m_lastMixTime;
+    qint64 m_totalMixTime;
+    qint64 m_maxMixTime;
+};
+
+} // namespace GE
+
+#endif // GEOFFLINEAUDIOOUT_H
@@ -9,14 +9,21 @@
  */
 
 #include "pushaudioout.h"
+#include <memory.h>
 #include "trace.h" // For debug macros
 
 #if defined(QTGAMEENABLER_USE_VOLUME_HACK) && defined(Q_OS_SYMBIAN)
     #include <sounddevice.h>
 #endif
 
+#if defined(Q_OS_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
 // Constants
-const int GEThreadSleepTime(1); // Milliseconds
+const int GEMinNotifyInterval(5); // Milliseconds
+const int GERealtimePriority(10); // Above the default SCHED_FIFO minimum
 
 using namespace GE;
 
@@ -25,24 +32,145 @@ using namespace GE;
   \class PushAudioOut
   \brief An object deploying QAudioOutput for sending the pre-mixed/processed
          audio data into an actual audio device.
+
+  The audio is written from a thread of its own, which sleeps in its event
+  loop until QAudioOutput notifies that a period has been played, and then
+  tops the device buffer up to the target latency. On Linux the thread asks
+  for real-time scheduling, and falls back to the normal priority if that
+  is not permitted.
 */
 
 
 /*!
-  Constructor.
+  Constructor. The device buffer is kept filled with \a latencyMs
+  milliseconds of audio, which is the delay from AudioMixer to the speaker.
 */
-PushAudioOut::PushAudioOut(AudioSource *source, QObject *parent /* = 0 */)
+PushAudioOut::PushAudioOut(AudioSource *source, QObject *parent /* = 0 */,
+                           int latencyMs /* = GEDefaultAudioLatency */)
     : QThread(parent),
       m_audioOutput(0),
       m_outTarget(0),
       m_sendBuffer(0),
       m_sendBufferSize(0),
-      m_samplesMixed(0),
-      m_threadState(NotRunning),
+      m_latency(qMax(latencyMs, 2 * GEMinNotifyInterval)),
+      m_targetBytes(0),
       m_source(source)
 {
     DEBUG_INFO(this);
 
+#ifdef Q_OS_SYMBIAN
+    m_needsTick = true;
+    startOutput();
+#else // !Q_OS_SYMBIAN
+    // The output is created in run(), so that its notifications are
+    // delivered to the event loop of the audio thread.
+    m_needsTick = false;
+    start(QThread::TimeCriticalPriority);
+#endif // Q_OS_SYMBIAN
+}
+
+
+/*!
+  Destructor.
+*/
+PushAudioOut::~PushAudioOut()
+{
+    if (isRunning()) {
+        // The thread stops the output when its event loop exits.
+        quit();
+        wait();
+    }
+    else {
+        stopOutput();
+    }
+}
+
+
+/*!
+  Writes audio from the source until the device holds the target latency
+  worth of it. The remainder is filled with silence when the source has
+  nothing to play, so that the device keeps running and notifying.
+
+  Call this method manually only if you are not using a thread (with Symbian).
+
+  Note: When using Qt GameEnabler, the GameWindow instance owning this AudioOut
+  instance will handle calling this method and you should not try to call this
+  explicitly.
+*/
+void PushAudioOut::tick()
+{
+    if (m_source.isNull()) {
+        DEBUG_INFO("No audio source!");
+        return;
+    }
+
+    if (!m_outTarget)
+        return;
+
+    const int bytesFree = m_audioOutput->bytesFree();
+    const int bytesQueued = m_audioOutput->bufferSize() - bytesFree;
+    int bytesToWrite = qMin(bytesFree, m_targetBytes - bytesQueued);
+
+    // QAudioOutput does not use period size on Symbian, and periodSize
+    // returns always the bufferSize
+#ifndef Q_OS_SYMBIAN
+    // Use multiples of period size
+    const int periodSize = m_audioOutput->periodSize();
+
+    if (periodSize > 0)
+        bytesToWrite -= bytesToWrite % periodSize;
+#endif // !Q_OS_SYMBIAN
+
+    int samplesToWrite = qMin(bytesToWrite / (int)sizeof(AUDIO_SAMPLE_TYPE),
+                              m_sendBufferSize);
+    samplesToWrite -= samplesToWrite % AUDIO_CHANNELS;
+
+    if (samplesToWrite <= 0)
+        return;
+
+    const int mixedSamples =
+        qMax(m_source->pullAudio(m_sendBuffer, samplesToWrite), 0);
+
+    if (mixedSamples < samplesToWrite) {
+        memset(m_sendBuffer + mixedSamples, 0,
+               (samplesToWrite - mixedSamples) * sizeof(AUDIO_SAMPLE_TYPE));
+    }
+
+    m_outTarget->write((char*)m_sendBuffer,
+                       samplesToWrite * sizeof(AUDIO_SAMPLE_TYPE));
+}
+
+
+/*!
+  From QThread.
+
+  Used only in threaded solutions. Writes the audio on the notifications
+  of the output until quit() is called.
+*/
+void PushAudioOut::run()
+{
+    DEBUG_INFO("Starting thread.");
+
+    if (m_source.isNull()) {
+        DEBUG_INFO("No audio source, exiting the thread!");
+        return;
+    }
+
+    requestRealtimePriority();
+    startOutput();
+    exec();
+    stopOutput();
+
+    DEBUG_INFO("Exiting thread.");
+}
+
+
+/*!
+  Creates the QAudioOutput with a buffer of the target latency, starts it
+  and fills the buffer.
+*/
+void PushAudioOut::startOutput()
+{
     QAudioFormat format;
     format.setFrequency(AUDIO_FREQUENCY);
     format.setChannels(AUDIO_CHANNELS);
@@ -58,27 +186,51 @@ PushAudioOut::PushAudioOut(AudioSource *source, QObject *parent /* = 0 */)
 
     m_audioOutput = new QAudioOutput(info, format);
 
-#if defined(Q_WS_MAEMO_5) || defined(MEEGO_EDITION_HARMATTAN)
-    m_sendBufferSize = 4096 * 4;
-#else
-    m_audioOutput->setBufferSize(4096 * 4);
-#endif
+    const int frameBytes = AUDIO_CHANNELS * sizeof(AUDIO_SAMPLE_TYPE);
+    const int latencyBytes =
+        (int)((qint64)AUDIO_FREQUENCY * m_latency / 1000) * frameBytes;
 
-    m_outTarget = m_audioOutput->start();
+    // Notified twice per latency, so the buffer never runs below half.
+    m_audioOutput->setNotifyInterval(qMax(m_latency / 2, GEMinNotifyInterval));
+
+    connect(m_audioOutput, SIGNAL(notify()), this, SLOT(audioNotify()),
+            Qt::DirectConnection);
+    connect(m_audioOutput, SIGNAL(stateChanged(QAudio::State)),
+            this, SLOT(audioStateChanged(QAudio::State)),
+            Qt::DirectConnection);
 
 #if defined(Q_WS_MAEMO_5) || defined(MEEGO_EDITION_HARMATTAN)
-    m_audioOutput->setBufferSize(4096 * 16);
-    m_sendBufferSize = 4096 * 8;
+    // The buffer size is taken into use only after starting the output.
+    m_outTarget = m_audioOutput->start();
+    m_audioOutput->setBufferSize(latencyBytes * 2);
 #else
-    m_audioOutput->setBufferSize(4096 * 4);
-    m_sendBufferSize = 4096 * 2;
+    m_audioOutput->setBufferSize(latencyBytes * 2);
+    m_outTarget = m_audioOutput->start();
 #endif
 
-    DEBUG_INFO("Buffer size: " << m_audioOutput->bufferSize());
+#ifndef Q_OS_SYMBIAN
+    // Keep at least two periods queued, so that a whole period is still
+    // waiting in the device while the next one is being mixed: the latency
+    // is rounded up to whole periods and one period is added on top.
+    const int periodSize = m_audioOutput->periodSize();
+    if (periodSize > 0) {
+        m_targetBytes = (latencyBytes + periodSize - 1) / periodSize *
+                        periodSize + periodSize;
+    }
+    else {
+        m_targetBytes = latencyBytes;
+    }
+#else
+    // periodSize returns the bufferSize on Symbian, see audioNotify().
+    m_targetBytes = qMax(latencyBytes, m_audioOutput->periodSize());
+#endif // !Q_OS_SYMBIAN
+
+    m_sendBufferSize = m_targetBytes / sizeof(AUDIO_SAMPLE_TYPE);
     m_sendBuffer = new AUDIO_SAMPLE_TYPE[m_sendBufferSize];
 
-#ifdef Q_OS_SYMBIAN
-    m_needsTick = true;
+    DEBUG_INFO("Buffer size: " << m_audioOutput->bufferSize()
+               << "target:" << m_targetBytes);
+
 #if defined(QTGAMEENABLER_USE_VOLUME_HACK) && defined(Q_OS_SYMBIAN)
     DEBUG_INFO("WARNING: Using the volume hack!");
 
@@ -99,100 +251,67 @@ PushAudioOut::PushAudioOut(AudioSource *source, QObject *parent /* = 0 */)
     devSound->SetVolume(devSound->MaxVolume() * 6 / 10);
 #endif
 
-#else // !Q_OS_SYMBIAN
-    m_needsTick = false;
-    start();
-#endif // Q_OS_SYMBIAN
+    tick();
 }
 
 
 /*!
-  Destructor.
+  Stops and destroys the QAudioOutput.
 */
-PushAudioOut::~PushAudioOut()
+void PushAudioOut::stopOutput()
 {
-    if (m_threadState == DoRun) {
-        // Set the thread to exit run().
-        m_threadState = DoExit;
-    }
-
-    if (QThread::isRunning() == false) {
-        m_threadState = NotRunning;
-    }
-
-    while (m_threadState != NotRunning) {
-        // Wait until the thread is finished.
-        msleep(50);
-    }
+    if (!m_audioOutput)
+        return;
 
     m_audioOutput->stop();
 
     delete m_audioOutput;
+    m_audioOutput = 0;
+    m_outTarget = 0;
+
     delete [] m_sendBuffer;
+    m_sendBuffer = 0;
 }
 
-/*!
-  TODO: Document what this method actually does and why it is needed.
 
-  Call this method manually only if you are not using a thread (with Symbian).
-
-  Note: When using Qt GameEnabler, the GameWindow instance owning this AudioOut
-  instance will handle calling this method and you should not try to call this
-  explicitly.
+/*!
+  Switches the calling thread to real-time scheduling where the platform
+  permits it, typically when RLIMIT_RTPRIO allows it for the user.
 */
-void PushAudioOut::tick()
+void PushAudioOut::requestRealtimePriority()
 {
-    if (m_source.isNull()) {
-        DEBUG_INFO("No audio source!");
-        return;
-    }
-
-    // QAudioOutput does not use period size on Symbian, and periodSize
-    // returns always the bufferSize
-#ifdef Q_OS_SYMBIAN
-    // Fill data to the buffer as much as there is free space available.
-    int samplesToWrite(m_audioOutput->bytesFree() / sizeof(AUDIO_SAMPLE_TYPE));
-    if (samplesToWrite <= 0)
-        return;
-#else // !Q_OS_SYMBIAN
-    // Use multiples of period size
-    int samplesToWrite(m_audioOutput->bytesFree() / m_audioOutput->periodSize());
-    if (!samplesToWrite)
-        return;
-    samplesToWrite *= m_audioOutput->periodSize() / sizeof(AUDIO_SAMPLE_TYPE);
-#endif // Q_OS_SYMBIAN
+#if defined(Q_OS_LINUX)
+    sched_param param;
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO),
+                                  GERealtimePriority,
+                                  sched_get_priority_max(SCHED_FIFO));
 
-    if (samplesToWrite > m_sendBufferSize)
-        samplesToWrite = m_sendBufferSize;
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO,
+                                            &param);
 
-    int mixedSamples = m_source->pullAudio(m_sendBuffer, samplesToWrite);
-    m_outTarget->write((char*)m_sendBuffer,
-        mixedSamples * sizeof(AUDIO_SAMPLE_TYPE));
+    if (error) {
+        DEBUG_INFO("Real-time scheduling not permitted, error" << error);
+    }
+#endif
 }
 
 
 /*!
-  From QThread.
-
-  Used only in threaded solutions.
+  Tops up the device buffer after a period has been played.
 */
-void PushAudioOut::run()
+void PushAudioOut::audioNotify()
 {
-    DEBUG_INFO("Starting thread.");
-    m_threadState = DoRun;
+    tick();
+}
 
-    if (m_source.isNull()) {
-        DEBUG_INFO("No audio source, exiting the thread!");
-        m_threadState = NotRunning;
-        return;
-    }
 
-    while (m_threadState == DoRun) {
-        tick();
-        msleep(GEThreadSleepTime);
-    }
+/*!
+  Restarts the writing if the device has run dry.
+*/
+void PushAudioOut::audioStateChanged(QAudio::State state)
+{
+    DEBUG_INFO("AudioStateChanged:" << state);
 
-    DEBUG_INFO("Exiting thread.");
-    m_threadState = NotRunning;
+    if (state == QAudio::IdleState)
+        tick();
 }
-
@@ -26,30 +26,34 @@ class Q_GE_EXPORT PushAudioOut : public QThread,
     Q_OBJECT
 
 public:
-    PushAudioOut(AudioSource *source, QObject *parent = 0);
+    PushAudioOut(AudioSource *source, QObject *parent = 0,
+                 int latencyMs = GEDefaultAudioLatency);
     virtual ~PushAudioOut();
 
 public:
     bool needsManualTick() const { return m_needsTick; }
     void tick();
+    inline int latency() const { return m_latency; }
 
 protected: // From QThread
      virtual void run(); // For the threaded mode only!
 
-private: // Data types
-    enum ThreadStates {
-        NotRunning = 0,
-        DoRun = 1,
-        DoExit = 2
-    };
+protected:
+    void startOutput();
+    void stopOutput();
+    void requestRealtimePriority();
+
+private slots:
+    void audioNotify();
+    void audioStateChanged(QAudio::State state);
 
 protected: // Data
     QAudioOutput *m_audioOutput; // Owned
     QIODevice *m_outTarget; // Not owned
     AUDIO_SAMPLE_TYPE *m_sendBuffer; // Owned
     int m_sendBufferSize;
-    qint64 m_samplesMixed;
-    int m_threadState;
+    int m_latency; // In milliseconds
+    int m_targetBytes; // Kept queued in the device
     bool m_needsTick;
     QPointer<AudioSource> m_source; // Not owned
 };
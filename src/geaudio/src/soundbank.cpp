@@ -0,0 +1,361 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "soundbank.h"
+#include <cstring>
+#include <QResource>
+#include "soundbankformat.h"
+#include "audiobuffer.h"
+#include "trace.h"
+
+using namespace GE;
+
+
+/*!
+  \class SoundBank
+  \brief A set of sounds stored in a single file, which are played in place
+         without loading them into memory.
+
+  A sound bank is written with SoundBank::write(), for example by the
+  soundcooker tool, from sounds already converted to the native format of
+  the mixer. Loading a bank does not parse or copy any samples: local files
+  are memory mapped and uncompressed resources are used directly, and the
+  AudioBuffer of a sound is constructed only when it is first asked for.
+  The pages of a sound become resident when it is played.
+
+  The buffers belong to the bank and refer to its data, so they must not be
+  used after the bank is destroyed.
+*/
+
+
+/*!
+  Constructor.
+*/
+SoundBank::SoundBank(QObject *parent)
+    : QObject(parent),
+      m_data(0),
+      m_size(0)
+{
+    DEBUG_INFO(this);
+}
+
+
+/*!
+  Destructor.
+*/
+SoundBank::~SoundBank()
+{
+    // The buffers refer to the data, destroy them before unmapping.
+    qDeleteAll(m_buffers);
+    m_buffers.clear();
+
+    if (m_file.isOpen() && m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+}
+
+
+/*!
+  Opens the sound bank file with \a fileName, which can be a resource as
+  well. If \a parent is given, it is set as the parent of the bank.
+
+  Returns a new bank if successful, NULL otherwise.
+*/
+SoundBank *SoundBank::load(const QString &fileName, QObject *parent)
+{
+    SoundBank *bank = new SoundBank(parent);
+
+    if (!bank->open(fileName)) {
+        DEBUG_INFO("Failed to load the sound bank " << fileName << "!");
+        delete bank;
+        return NULL;
+    }
+
+    return bank;
+}
+
+
+/*!
+  Returns the contents of a sound bank file with \a buffers named by
+  \a names. The buffers must be in the native format of the mixer, see
+  AudioBuffer::convertToNativeFormat(). Returns an empty array if a buffer
+  is not.
+*/
+QByteArray SoundBank::write(const QStringList &names,
+                            const QList<AudioBuffer*> &buffers)
+{
+    const int count = qMin(names.count(), buffers.count());
+    QByteArray strings(1, '\0'); // The empty string is at offset 0
+    QVector<SoundBankSound> sounds(count);
+
+    for (int i = 0; i < count; i++) {
+        AudioBuffer *buffer = buffers.at(i);
+
+        if (!buffer || !buffer->isNativeFormat()) {
+            DEBUG_INFO("Not in the native format:" << names.at(i));
+            return QByteArray();
+        }
+
+        sounds[i].name = strings.size();
+        sounds[i].nofChannels = buffer->getNofChannels();
+        sounds[i].dataLength = buffer->getDataLength();
+        strings.append(names.at(i).toUtf8());
+        strings.append('\0');
+    }
+
+    const int align = GE_SOUND_BANK_ALIGNMENT;
+
+    SoundBankHeader header;
+    memcpy(header.magic, GE_SOUND_BANK_MAGIC, 4);
+    header.version = GE_SOUND_BANK_VERSION;
+    header.byteOrder = GE_SOUND_BANK_BYTE_ORDER;
+    header.sampleRate = AUDIO_FREQUENCY;
+    header.soundCount = count;
+    header.soundOffset = sizeof(SoundBankHeader);
+    header.stringsOffset =
+        header.soundOffset + count * sizeof(SoundBankSound);
+    header.stringsSize = strings.size();
+
+    quint32 offset = header.stringsOffset + header.stringsSize;
+
+    for (int i = 0; i < count; i++) {
+        offset = (offset + align - 1) & ~(align - 1);
+        sounds[i].dataOffset = offset;
+        offset += sounds[i].dataLength;
+    }
+
+    header.fileSize = offset;
+
+    QByteArray data(offset, '\0');
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + header.soundOffset, sounds.constData(),
+           count * sizeof(SoundBankSound));
+    memcpy(data.data() + header.stringsOffset, strings.constData(),
+           strings.size());
+
+    for (int i = 0; i < count; i++) {
+        memcpy(data.data() + sounds[i].dataOffset,
+               buffers.at(i)->getRawData(), sounds[i].dataLength);
+    }
+
+    return data;
+}
+
+
+/*!
+  Returns the number of sounds in the bank.
+*/
+int SoundBank::count() const
+{
+    return m_data ? header()->soundCount : 0;
+}
+
+
+/*!
+  Returns the name of the sound at \a index.
+*/
+QString SoundBank::name(int index) const
+{
+    const SoundBankSound *s = sound(index);
+
+    if (!s)
+        return QString();
+
+    return QString::fromUtf8(
+        (const char*)m_data + header()->stringsOffset + s->name);
+}
+
+
+/*!
+  Returns the index of the sound with \a name, or -1 if there is none.
+*/
+int SoundBank::indexOf(const QString &name) const
+{
+    if (!m_data)
+        return -1;
+
+    const QByteArray utf8 = name.toUtf8();
+    const char *strings = (const char*)m_data + header()->stringsOffset;
+
+    for (int i = 0; i < count(); i++) {
+        if (utf8 == strings + sound(i)->name)
+            return i;
+    }
+
+    return -1;
+}
+
+
+/*!
+  Returns the buffer of the sound at \a index, which plays the samples in
+  place. The buffer is a child of the bank. Returns NULL if the index is
+  invalid.
+*/
+AudioBuffer *SoundBank::buffer(int index)
+{
+    const SoundBankSound *s = sound(index);
+
+    if (!s)
+        return NULL;
+
+    if (!m_buffers[index]) {
+        m_buffers[index] = AudioBuffer::fromRawData(m_data + s->dataOffset,
+                                                    s->dataLength,
+                                                    s->nofChannels, this);
+    }
+
+    return m_buffers[index];
+}
+
+
+/*!
+  Returns the buffer of the sound with \a name, see buffer(int).
+*/
+AudioBuffer *SoundBank::buffer(const QString &name)
+{
+    return buffer(indexOf(name));
+}
+
+
+/*!
+  Takes the data of the file with \a fileName into use: resources are used
+  in place unless they are compressed, other files are memory mapped and
+  read into memory only if mapping fails. Returns true if successful.
+*/
+bool SoundBank::open(const QString &fileName)
+{
+    if (fileName.startsWith(QLatin1Char(':'))) {
+        QResource resource(fileName);
+
+        if (!resource.isValid())
+            return false;
+
+        if (resource.isCompressed()) {
+            DEBUG_INFO("The resource is compressed, copying " << fileName);
+            m_copy = qUncompress(resource.data(), resource.size());
+        }
+        else {
+            m_data = resource.data();
+            m_size = resource.size();
+        }
+    }
+    else {
+        m_file.setFileName(fileName);
+
+        if (!m_file.open(QIODevice::ReadOnly))
+            return false;
+
+        m_size = m_file.size();
+        m_data = m_file.map(0, m_size);
+
+        if (!m_data) {
+            m_copy = m_file.readAll();
+            m_file.close();
+        }
+    }
+
+    if (m_data && ((quintptr)m_data & 3)) {
+        // Resources are packed without alignment. The samples cannot be read
+        // in place, so the whole bank is copied, which is worth knowing about
+        // also in release builds.
+        qWarning("SoundBank: %s is not 4-byte aligned, copying %d bytes",
+                 qPrintable(fileName), int(m_size));
+        m_copy = QByteArray((const char*)m_data, m_size);
+
+        if (m_file.isOpen()) {
+            m_file.unmap(const_cast<uchar*>(m_data));
+            m_file.close();
+        }
+
+        m_data = 0;
+    }
+
+    if (!m_data) {
+        m_data = (const uchar*)m_copy.constData();
+        m_size = m_copy.size();
+    }
+
+    if (!validate()) {
+        DEBUG_INFO("Not a valid sound bank:" << fileName);
+
+        if (m_file.isOpen())
+            m_file.unmap(const_cast<uchar*>(m_data));
+
+        m_data = 0;
+        return false;
+    }
+
+    m_buffers.fill(0, header()->soundCount);
+    return true;
+}
+
+
+/*!
+  Returns true if the data is a sound bank that this build can play in
+  place, checking that every table and sound lies within the data.
+*/
+bool SoundBank::validate() const
+{
+    if (!m_data || m_size < (qint64)sizeof(SoundBankHeader))
+        return false;
+
+    const SoundBankHeader *h = header();
+
+    if (memcmp(h->magic, GE_SOUND_BANK_MAGIC, 4) ||
+        h->version != GE_SOUND_BANK_VERSION ||
+        h->byteOrder != GE_SOUND_BANK_BYTE_ORDER ||
+        h->sampleRate != AUDIO_FREQUENCY || h->fileSize > m_size) {
+        return false;
+    }
+
+    if ((quint64)h->soundOffset + (quint64)h->soundCount *
+        sizeof(SoundBankSound) > h->fileSize ||
+        (quint64)h->stringsOffset + h->stringsSize > h->fileSize ||
+        h->stringsSize < 1 ||
+        m_data[h->stringsOffset + h->stringsSize - 1] != '\0') {
+        return false;
+    }
+
+    for (quint32 i = 0; i < h->soundCount; i++) {
+        const SoundBankSound *s = (const SoundBankSound*)
+            (m_data + h->soundOffset + i * sizeof(SoundBankSound));
+
+        if (s->name >= h->stringsSize ||
+            (quint64)s->dataOffset + s->dataLength > h->fileSize ||
+            s->dataOffset % GE_SOUND_BANK_ALIGNMENT ||
+            s->nofChannels < 1 || s->nofChannels > 2) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+  Returns the header of the bank.
+*/
+const SoundBankHeader *SoundBank::header() const
+{
+    return (const SoundBankHeader*)m_data;
+}
+
+
+/*!
+  Returns the table entry of the sound at \a index, or NULL if the index is
+  invalid.
+*/
+const SoundBankSound *SoundBank::sound(int index) const
+{
+    if (index < 0 || index >= count())
+        return NULL;
+
+    return (const SoundBankSound*)
+        (m_data + header()->soundOffset) + index;
+}
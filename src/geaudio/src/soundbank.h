@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GESOUNDBANK_H
+#define GESOUNDBANK_H
+
+#include <QObject>
+#include <QFile>
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+#include "geglobal.h"
+
+namespace GE {
+
+// Forward declarations
+class AudioBuffer;
+struct SoundBankHeader;
+struct SoundBankSound;
+
+
+class Q_GE_EXPORT SoundBank : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SoundBank(QObject *parent = 0);
+    virtual ~SoundBank();
+    static SoundBank *load(const QString &fileName, QObject *parent = 0);
+    static QByteArray write(const QStringList &names,
+                            const QList<AudioBuffer*> &buffers);
+
+public:
+    int count() const;
+    QString name(int index) const;
+    int indexOf(const QString &name) const;
+    AudioBuffer *buffer(int index);
+    AudioBuffer *buffer(const QString &name);
+
+protected:
+    bool open(const QString &fileName);
+    bool validate() const;
+    const SoundBankHeader *header() const;
+    const SoundBankSound *sound(int index) const;
+
+protected: // Data
+    QFile m_file; // Mapped, if the bank is a local file
+    QByteArray m_copy; // If the bank could not be used in place
+    const uchar *m_data; // Not owned
+    qint64 m_size;
+    QVector<AudioBuffer*> m_buffers; // Owned, constructed on demand
+};
+
+} // namespace GE
+
+#endif // GESOUNDBANK_H
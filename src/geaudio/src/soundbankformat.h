@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GESOUNDBANKFORMAT_H
+#define GESOUNDBANKFORMAT_H
+
+#include <QtCore/qglobal.h>
+
+/*
+  Layout of a sound bank (.gesb) file. All values are in the byte order of
+  the machine that wrote the file, which is checked with the byteOrder
+  field of the header. The file starts with a SoundBankHeader followed by
+  the sound table, the string table and the sample data of each sound,
+  aligned to GE_SOUND_BANK_ALIGNMENT bytes.
+
+  The samples are in the native format of the mixer, as produced by
+  AudioBuffer::convertToNativeFormat(): signed 16-bit, interleaved, at
+  AUDIO_FREQUENCY and followed by the guard frames, so a memory mapped file
+  can be played in place. The names are UTF-8 and zero terminated, and are
+  referred to by their offset in the string table.
+*/
+
+#define GE_SOUND_BANK_MAGIC "GESB"
+#define GE_SOUND_BANK_VERSION 1
+#define GE_SOUND_BANK_BYTE_ORDER 0x01020304
+#define GE_SOUND_BANK_ALIGNMENT 16
+
+namespace GE {
+
+struct SoundBankHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 fileSize;
+    quint32 sampleRate; // AUDIO_FREQUENCY of the writer
+    quint32 soundCount;
+    quint32 soundOffset;
+    quint32 stringsSize;
+    quint32 stringsOffset;
+};
+
+struct SoundBankSound
+{
+    quint32 name;
+    quint32 nofChannels;
+    quint32 dataOffset;
+    quint32 dataLength; // In bytes, including the guard frames
+};
+
+} // namespace GE
+
+#endif // GESOUNDBANKFORMAT_H
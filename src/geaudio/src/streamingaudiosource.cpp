@@ -0,0 +1,518 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "streamingaudiosource.h"
+#include <QThread>
+#include <memory.h>
+#include "audiobuffer.h"
+#include "audiocommandqueue.h"
+#include "audiomixer.h"
+#include "audiomixkernels.h"
+#include "audioringbuffer.h"
+#include "trace.h"
+
+using namespace GE;
+
+// Constants
+const int GEStreamChunkFrames(2048); // Read from the file at a time
+const int GEStreamBufferMs(500); // Decoded ahead of the playback
+const int GEStreamReaderIntervalMs(20);
+const int GEStreamWindowFrames(256); // Taken from the ring at a time
+const float GEDefaultAudioVolume(1.0f); // 1.0 => 100 %
+const float GEDefaultAudioSpeed(1.0f); // 1.0 => 100 %
+
+
+namespace GE {
+
+/*!
+  \class StreamingAudioReader
+  \brief The thread that keeps the ring buffer of a StreamingAudioSource
+         filled.
+*/
+class StreamingAudioReader : public QThread
+{
+public:
+    StreamingAudioReader(StreamingAudioSource *source)
+        : m_source(source)
+    {
+    }
+
+protected:
+    void run() { m_source->runReader(); }
+
+private:
+    StreamingAudioSource *m_source; // Not owned
+};
+
+} // namespace GE
+
+
+/*!
+  \class StreamingAudioSource
+  \brief An AudioSource playing a .wav file from the disk without loading
+         it into memory.
+
+  A reader thread reads and converts the file chunk by chunk into a
+  lock-free ring buffer, which holds half a second of audio, and
+  pullAudio() resamples the ring buffer to the output on the audio thread.
+  The looping is done by the reader, so the end of the file is followed
+  seamlessly by its beginning. When the reader falls behind, the audio
+  thread plays silence and counts an underrun, which the reader reports
+  with the underrun() signal.
+
+  Call open() before adding the source to a mixer. The other methods are
+  called from the game thread like the ones of AudioBufferPlayInstance.
+*/
+
+
+/*!
+  Constructor.
+*/
+StreamingAudioSource::StreamingAudioSource(QObject *parent /* = 0 */)
+    : AudioSource(parent),
+      m_leftVolume(GEDefaultAudioVolume),
+      m_rightVolume(GEDefaultAudioVolume),
+      m_loopCount(0),
+      m_reader(0),
+      m_readBuffer(0),
+      m_convertBuffer(0),
+      m_dataStart(0),
+      m_dataLength(0),
+      m_dataLeft(0),
+      m_nofChannels(0),
+      m_bitsPerSample(0),
+      m_samplesPerSec(0),
+      m_reportedUnderruns(0),
+      m_ring(0),
+      m_endOfStream(0),
+      m_underruns(0),
+      m_quit(0),
+      m_window(new AUDIO_SAMPLE_TYPE[GEStreamWindowFrames * 2]),
+      m_windowPos(0),
+      m_windowLength(0),
+      m_fixedPos(2 << 12), // Takes in the first two frames
+      m_fixedInc(0),
+      m_fixedLeftVolume((int)GEMaxAudioVolumeValue),
+      m_fixedRightVolume((int)GEMaxAudioVolumeValue),
+      m_speed(GEDefaultAudioSpeed),
+      m_finished(false),
+      m_destroyWhenFinished(true)
+{
+    memset(m_frames, 0, sizeof(m_frames));
+}
+
+
+/*!
+  Destructor. Stops the reader thread, which takes at most the time of
+  reading one chunk from the file. A source destroyed by the mixer when it
+  has finished is deleted later on its own thread, so the audio thread does
+  not wait for the reader.
+*/
+StreamingAudioSource::~StreamingAudioSource()
+{
+    if (m_reader) {
+        m_wakeMutex.lock();
+        m_quit.fetchAndStoreRelease(1);
+        m_wake.wakeOne();
+        m_wakeMutex.unlock();
+
+        m_reader->wait();
+        delete m_reader;
+    }
+
+    delete m_ring;
+    delete [] m_readBuffer;
+    delete [] m_convertBuffer;
+    delete [] m_window;
+}
+
+
+/*!
+  Opens the .wav file with \a fileName, fills the ring buffer and starts the
+  reader thread. Must be called once, before the source is added to a mixer.
+  Returns true if successful, false otherwise.
+*/
+bool StreamingAudioSource::open(const QString &fileName)
+{
+    if (m_reader || m_mixer) {
+        DEBUG_INFO("Must be opened once, before adding to a mixer!");
+        return false;
+    }
+
+    m_file.setFileName(fileName);
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        DEBUG_INFO("Failed to open " << fileName << ": "
+                   << m_file.errorString());
+        return false;
+    }
+
+    if (!AudioBuffer::readWavHeader(m_file, &m_nofChannels,
+                                    &m_bitsPerSample, &m_samplesPerSec,
+                                    &m_dataLength) ||
+        m_nofChannels < 1 || m_samplesPerSec < 1 ||
+        (m_bitsPerSample != 8 && m_bitsPerSample != 16 &&
+         m_bitsPerSample != 32)) {
+        DEBUG_INFO("Unsupported file " << fileName);
+        m_file.close();
+        return false;
+    }
+
+    const int frameBytes = m_nofChannels * (m_bitsPerSample >> 3);
+
+    m_dataStart = m_file.pos();
+    m_dataLength -= m_dataLength % frameBytes;
+    m_dataLeft = m_dataLength;
+
+    m_readBuffer = new char[GEStreamChunkFrames * frameBytes];
+    m_convertBuffer = new AUDIO_SAMPLE_TYPE[GEStreamChunkFrames * 2];
+    m_ring = new AudioRingBuffer(m_samplesPerSec * 2 * GEStreamBufferMs / 1000);
+    updateFixedInc();
+
+    // Fill the ring before the playback starts.
+    while (readChunk()) {
+    }
+
+    m_reader = new StreamingAudioReader(this);
+    m_reader->start();
+    return true;
+}
+
+
+/*!
+  Returns the number of times the playback has run out of data.
+*/
+int StreamingAudioSource::underrunCount() const
+{
+    return const_cast<QAtomicInt&>(m_underruns).fetchAndAddAcquire(0);
+}
+
+
+/*!
+  From AudioSource.
+
+  Returns true if the file has been played and the source can be destroyed.
+*/
+bool StreamingAudioSource::canBeDestroyed()
+{
+    return m_finished && m_destroyWhenFinished;
+}
+
+
+/*!
+  From AudioSource.
+
+  Resamples the decoded frames from the ring buffer to \a target with linear
+  interpolation. Returns the amount of samples written, which is less than
+  \a bufferLength if the ring buffer runs empty.
+*/
+int StreamingAudioSource::pullAudio(AUDIO_SAMPLE_TYPE *target,
+                                    int bufferLength)
+{
+    if (m_finished || !m_ring)
+        return 0;
+
+    const int frames = bufferLength / 2;
+    int mixed = 0;
+
+    while (mixed < frames) {
+        // Take in the frames to interpolate between.
+        while (m_fixedPos >= 4096) {
+            int frame[2];
+
+            if (!nextFrame(frame))
+                break;
+
+            m_frames[0][0] = m_frames[1][0];
+            m_frames[0][1] = m_frames[1][1];
+            m_frames[1][0] = frame[0];
+            m_frames[1][1] = frame[1];
+            m_fixedPos -= 4096;
+        }
+
+        if (m_fixedPos >= 4096)
+            break;
+
+        const int frac = m_fixedPos;
+
+        for (int c = 0; c < 2; c++) {
+            const int sample = (m_frames[0][c] * (4096 - frac) +
+                                m_frames[1][c] * frac) >> 12;
+            const int volume = c ? m_fixedRightVolume : m_fixedLeftVolume;
+
+            MixKernels::Store::put(target + mixed * 2 + c,
+                                   (sample * volume) >> 12);
+        }
+
+        m_fixedPos += m_fixedInc;
+        mixed++;
+    }
+
+    if (mixed < frames) {
+        if (m_endOfStream.fetchAndAddAcquire(0) && !m_ring->readAvailable())
+            finish();
+        else
+            m_underruns.ref();
+    }
+
+    return mixed * 2;
+}
+
+
+/*!
+  Stops the playback.
+*/
+void StreamingAudioSource::stop()
+{
+    post(AudioCommand(AudioCommand::Stop, this));
+}
+
+
+/*!
+  Sets the loop count to \a count. If the argument value is -1, the file is
+  looped forever.
+*/
+void StreamingAudioSource::setLoopCount(int count)
+{
+    m_loopCount.fetchAndStoreOrdered(count);
+
+    // The reader may be waiting at the end of the file.
+    m_wakeMutex.lock();
+    m_wake.wakeOne();
+    m_wakeMutex.unlock();
+}
+
+
+/*!
+  Sets \a speed as the speed of which the file is played in, 1.0 indicates
+  100 %.
+*/
+void StreamingAudioSource::setSpeed(float speed)
+{
+    AudioCommand command(AudioCommand::SetSpeed, this);
+    command.value[0] = speed;
+    post(command);
+}
+
+
+/*!
+  Sets \a volume for the left channel, 1.0 indicates 100 %.
+*/
+void StreamingAudioSource::setLeftVolume(float volume)
+{
+    m_leftVolume = volume;
+
+    AudioCommand command(AudioCommand::SetVolume, this);
+    command.value[0] = m_leftVolume;
+    command.value[1] = m_rightVolume;
+    post(command);
+}
+
+
+/*!
+  Sets \a volume for the right channel, 1.0 indicates 100 %.
+*/
+void StreamingAudioSource::setRightVolume(float volume)
+{
+    m_rightVolume = volume;
+
+    AudioCommand command(AudioCommand::SetVolume, this);
+    command.value[0] = m_leftVolume;
+    command.value[1] = m_rightVolume;
+    post(command);
+}
+
+
+/*!
+  From AudioSource.
+
+  Applies \a command to the playback state.
+*/
+void StreamingAudioSource::applyCommand(const AudioCommand &command)
+{
+    switch (command.type) {
+    case AudioCommand::Stop:
+        finish();
+        break;
+    case AudioCommand::SetSpeed:
+        m_speed = command.value[0];
+        updateFixedInc();
+        break;
+    case AudioCommand::SetVolume:
+        m_fixedLeftVolume = (int)(GEMaxAudioVolumeValue * command.value[0]);
+        m_fixedRightVolume = (int)(GEMaxAudioVolumeValue * command.value[1]);
+        break;
+    default:
+        break;
+    }
+}
+
+
+/*!
+  Posts \a command to the mixer playing the source. Before the source has
+  been added to a mixer, the command is applied immediately.
+*/
+void StreamingAudioSource::post(const AudioCommand &command)
+{
+    if (m_mixer)
+        m_mixer->post(command);
+    else
+        applyCommand(command);
+}
+
+
+/*!
+  Ends the playback and signals that it has finished.
+*/
+void StreamingAudioSource::finish()
+{
+    m_finished = true;
+    emit finished();
+}
+
+
+/*!
+  Converts the playback speed to the fixed point increment of the play
+  position, which depends on the sample rate of the file.
+*/
+void StreamingAudioSource::updateFixedInc()
+{
+    if (m_speed <= 0.0f)
+        m_speed = GEDefaultAudioSpeed;
+
+    m_fixedInc = (int)(((float)m_samplesPerSec * GEMaxAudioVolumeValue *
+                        m_speed) / (float)AUDIO_FREQUENCY);
+}
+
+
+/*!
+  Takes the next stereo frame from the ring buffer into \a frame. Returns
+  false if the ring buffer is empty.
+*/
+bool StreamingAudioSource::nextFrame(int *frame)
+{
+    if (m_windowPos == m_windowLength) {
+        m_windowPos = 0;
+        m_windowLength =
+            m_ring->read(m_window, GEStreamWindowFrames * 2) / 2;
+
+        if (!m_windowLength)
+            return false;
+    }
+
+    frame[0] = m_window[m_windowPos * 2];
+    frame[1] = m_window[m_windowPos * 2 + 1];
+    m_windowPos++;
+    return true;
+}
+
+
+/*!
+  The loop of the reader thread, which fills the ring buffer and reports
+  the underruns until the source is destroyed.
+*/
+void StreamingAudioSource::runReader()
+{
+    while (!m_quit.fetchAndAddAcquire(0)) {
+        const bool more = readChunk();
+        const int underruns = m_underruns.fetchAndAddAcquire(0);
+
+        if (underruns != m_reportedUnderruns) {
+            m_reportedUnderruns = underruns;
+            DEBUG_INFO("Underrun" << underruns);
+            emit underrun(underruns);
+        }
+
+        if (!more) {
+            m_wakeMutex.lock();
+
+            if (!m_quit.fetchAndAddAcquire(0))
+                m_wake.wait(&m_wakeMutex, GEStreamReaderIntervalMs);
+
+            m_wakeMutex.unlock();
+        }
+    }
+}
+
+
+/*!
+  Reads a chunk of the file, converts it to stereo 16-bit frames and writes
+  them to the ring buffer. At the end of the file, starts from the beginning
+  if there are loops left. Returns false if there was nothing to do.
+*/
+bool StreamingAudioSource::readChunk()
+{
+    using namespace MixKernels;
+
+    const int frames = qMin(m_ring->writeAvailable() / 2, GEStreamChunkFrames);
+
+    if (frames < GEStreamChunkFrames / 2) {
+        // Wait until there is room for a decent chunk.
+        return false;
+    }
+
+    if (m_dataLeft <= 0) {
+        int loops = m_loopCount.fetchAndAddAcquire(0);
+
+        if (loops > 0 && m_loopCount.testAndSetOrdered(loops, loops - 1))
+            loops--;
+
+        if (loops == 0 || !m_file.seek(m_dataStart)) {
+            m_endOfStream.fetchAndStoreRelease(1);
+            return false;
+        }
+
+        m_endOfStream.fetchAndStoreRelease(0);
+        m_dataLeft = m_dataLength;
+    }
+
+    const int frameBytes = m_nofChannels * (m_bitsPerSample >> 3);
+    const qint64 length = qMin((qint64)frames * frameBytes, m_dataLeft);
+    const qint64 read = m_file.read(m_readBuffer, length);
+    const int readFrames = read > 0 ? read / frameBytes : 0;
+
+    if (!readFrames) {
+        // The file is truncated or failed.
+        m_dataLeft = 0;
+        m_dataLength = 0;
+        m_endOfStream.fetchAndStoreRelease(1);
+        return false;
+    }
+
+    m_dataLeft -= readFrames * frameBytes;
+
+    if (read % frameBytes)
+        m_file.seek(m_file.pos() - read % frameBytes);
+
+    // Mono is played on both channels, and channels beyond the first two
+    // are dropped.
+    const int right = m_nofChannels > 1 ? 1 : 0;
+
+    for (int i = 0; i < readFrames; i++) {
+        const char *frame = m_readBuffer + i * frameBytes;
+
+        for (int c = 0; c < 2; c++) {
+            const int offset = (c ? right : 0) * (m_bitsPerSample >> 3);
+            int sample;
+
+            if (m_bitsPerSample == 8)
+                sample = Pcm8::read((const quint8*)(frame + offset));
+            else if (m_bitsPerSample == 16)
+                sample = Pcm16::read((const qint16*)(frame + offset));
+            else
+                sample = Float32::read((const float*)(frame + offset));
+
+            m_convertBuffer[i * 2 + c] = (AUDIO_SAMPLE_TYPE)sample;
+        }
+    }
+
+    m_ring->write(m_convertBuffer, readFrames * 2);
+    return true;
+}
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile.
+ * All rights reserved.
+ *
+ * Part of the Qt GameEnabler.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef GESTREAMINGAUDIOSOURCE_H
+#define GESTREAMINGAUDIOSOURCE_H
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include "geglobal.h"
+#include "audiosourceif.h"
+
+namespace GE {
+
+// Forward declarations
+class AudioRingBuffer;
+class StreamingAudioReader;
+
+
+class Q_GE_EXPORT StreamingAudioSource : public AudioSource
+{
+    Q_OBJECT
+
+public:
+    explicit StreamingAudioSource(QObject *parent = 0);
+    virtual ~StreamingAudioSource();
+
+public:
+    bool open(const QString &fileName);
+    inline bool isFinished() const { return m_finished; }
+    int underrunCount() const;
+    inline void setDestroyWhenFinished(bool set) { m_destroyWhenFinished = set; }
+    inline bool destroyWhenFinished() const { return m_destroyWhenFinished; }
+
+public: // From AudioSource
+    bool canBeDestroyed();
+    int pullAudio(AUDIO_SAMPLE_TYPE *target, int bufferLength);
+
+public slots:
+    void stop();
+    void setLoopCount(int count);
+    void setSpeed(float speed);
+    void setLeftVolume(float volume);
+    void setRightVolume(float volume);
+
+signals:
+    void finished();
+    void underrun(int count);
+
+protected: // From AudioSource
+    void applyCommand(const AudioCommand &command);
+
+protected:
+    void post(const AudioCommand &command);
+    void finish();
+    void updateFixedInc();
+    bool nextFrame(int *frame);
+
+    // Run by the reader thread
+    void runReader();
+    bool readChunk();
+
+protected: // Data
+    // Set by the game thread
+    float m_leftVolume;
+    float m_rightVolume;
+    QAtomicInt m_loopCount; // Also counted down by the reader thread
+
+    // Used by the reader thread once it has been started
+    StreamingAudioReader *m_reader; // Owned
+    QFile m_file;
+    char *m_readBuffer; // Owned
+    AUDIO_SAMPLE_TYPE *m_convertBuffer; // Owned
+    qint64 m_dataStart;
+    qint64 m_dataLength;
+    qint64 m_dataLeft;
+    short m_nofChannels;
+    short m_bitsPerSample;
+    int m_samplesPerSec;
+    int m_reportedUnderruns;
+
+    // Shared by the reader and the audio thread
+    AudioRingBuffer *m_ring; // Owned
+    QAtomicInt m_endOfStream;
+    QAtomicInt m_underruns;
+    QAtomicInt m_quit;
+    QMutex m_wakeMutex;
+    QWaitCondition m_wake;
+
+    // Used by the audio thread once the source has been added to a mixer
+    AUDIO_SAMPLE_TYPE *m_window; // Owned, read from the ring
+    int m_windowPos;
+    int m_windowLength;
+    int m_frames[2][2]; // The frames interpolated between
+    int m_fixedPos;
+    int m_fixedInc;
+    int m_fixedLeftVolume;
+    int m_fixedRightVolume;
+    float m_speed;
+    bool m_finished;
+    bool m_destroyWhenFinished;
+
+    friend class StreamingAudioReader;
+};
+
+} // namespace GE
+
+#endif // GESTREAMINGAUDIOSOURCE_H
@@ -45,13 +45,82 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "BaseImporter.h"
 #include "BaseProcess.h"
 
+#include <limits.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+
 using namespace Assimp;
 
+namespace {
+
+// ------------------------------------------------------------------------------------------------
+// State shared by the threads working on one RunPerMesh() call
+struct PerMeshBatch
+{
+    PerMeshBatch( PerMeshJob* pJob, unsigned int pNumMeshes)
+        : job( pJob), numMeshes( pNumMeshes), next( 0), failedIndex( UINT_MAX) {}
+
+    PerMeshJob* job;
+    unsigned int numMeshes;
+    QAtomicInt next;
+
+    QMutex mutex;
+    unsigned int failedIndex;
+    std::string error;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Takes meshes from the batch and runs the job on them until all have been taken
+void RunBatch( PerMeshBatch& batch)
+{
+    for (;;) {
+        const unsigned int a = (unsigned int)batch.next.fetchAndAddOrdered( 1);
+        if (a >= batch.numMeshes) {
+            break;
+        }
+
+        try {
+            batch.job->Run( a);
+        } catch( const std::exception& err) {
+            QMutexLocker lock( &batch.mutex);
+            if (a < batch.failedIndex) {
+                batch.failedIndex = a;
+                batch.error = err.what();
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Helper thread of a batch, signals the semaphore when it runs out of meshes
+class PerMeshRunnable : public QRunnable
+{
+public:
+    PerMeshRunnable( PerMeshBatch* pBatch, QSemaphore* pDone)
+        : batch( pBatch), done( pDone) {}
+
+    void run() {
+        RunBatch( *batch);
+        done->release();
+    }
+
+private:
+    PerMeshBatch* batch;
+    QSemaphore* done;
+};
+
+} // end of anonymous namespace
+
 // ------------------------------------------------------------------------------------------------
 // Constructor to be privately used by Importer
 BaseProcess::BaseProcess()
 : shared()
 , progress()
+, threads( -1)
 {
 }
 
@@ -70,6 +139,7 @@ void BaseProcess::ExecuteOnScene( Importer* pImp)
     progress = pImp->GetProgressHandler();
     ai_assert(progress);
 
+    threads = pImp->GetPropertyInteger( AI_CONFIG_GLOB_MULTITHREADING, -1);
     SetupProperties( pImp );
 
     // catch exceptions thrown inside the PostProcess-Step
@@ -94,3 +164,41 @@ void BaseProcess::SetupProperties(const Importer* /* pImp */)
 {
     // the default implementation does nothing
 }
+
+// ------------------------------------------------------------------------------------------------
+void BaseProcess::RunPerMesh( unsigned int pNumMeshes, PerMeshJob& pJob) const
+{
+    int numThreads = threads < 0 ? QThread::idealThreadCount() : threads;
+    if (pNumMeshes < (unsigned int)numThreads) {
+        numThreads = (int)pNumMeshes;
+    }
+
+    if (numThreads <= 1) {
+        for (unsigned int a = 0; a < pNumMeshes; ++a) {
+            pJob.Run( a);
+        }
+        return;
+    }
+
+    // The calling thread works on the batch as well. Helpers are only
+    // started on idle pool threads, so a busy pool (or an import running
+    // on a pool thread itself) can't block us, we just get less help.
+    PerMeshBatch batch( &pJob, pNumMeshes);
+    QSemaphore done;
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int helpers = 0;
+    for (; helpers < numThreads - 1; ++helpers) {
+        PerMeshRunnable* runnable = new PerMeshRunnable( &batch, &done);
+        if (!pool->tryStart( runnable)) {
+            delete runnable;
+            break;
+        }
+    }
+
+    RunBatch( batch);
+    done.acquire( helpers);
+
+    if (batch.failedIndex != UINT_MAX) {
+        throw DeadlyImportError( batch.error);
+    }
+}
@@ -48,6 +48,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "GenericProperty.h"
 
 struct aiScene;
+struct aiMesh;
 
 namespace Assimp {
 
@@ -201,6 +202,81 @@ private:
 
 #define AI_SPP_SPATIAL_SORT "$Spat"
 
+// ---------------------------------------------------------------------------
+/** Unit of work that a post processing step executes once for every mesh of
+ *  a scene, see BaseProcess::RunPerMesh(). Run() may be called from any
+ *  thread and must only touch the mesh with the given index.
+ */
+class PerMeshJob
+{
+public:
+    virtual ~PerMeshJob() {}
+    virtual void Run( unsigned int pIndex) = 0;
+};
+
+// ---------------------------------------------------------------------------
+/** Adapters from the per mesh methods of the post processing steps to
+ *  PerMeshJob. The return value for each mesh is stored in pResults[index].
+ */
+template <class TProcess, typename TResult>
+class IndexedMeshJob : public PerMeshJob
+{
+public:
+    typedef TResult (TProcess::*Method)( aiMesh*, unsigned int);
+
+    IndexedMeshJob( TProcess* pProcess, Method pMethod, aiMesh** pMeshes, TResult* pResults)
+        : process( pProcess), method( pMethod), meshes( pMeshes), results( pResults) {}
+
+    void Run( unsigned int pIndex) {
+        results[pIndex] = (process->*method)( meshes[pIndex], pIndex);
+    }
+
+private:
+    TProcess* process;
+    Method method;
+    aiMesh** meshes;
+    TResult* results;
+};
+
+template <class TProcess, typename TResult>
+class MeshJob : public PerMeshJob
+{
+public:
+    typedef TResult (TProcess::*Method)( aiMesh*);
+
+    MeshJob( TProcess* pProcess, Method pMethod, aiMesh** pMeshes, TResult* pResults)
+        : process( pProcess), method( pMethod), meshes( pMeshes), results( pResults) {}
+
+    void Run( unsigned int pIndex) {
+        results[pIndex] = (process->*method)( meshes[pIndex]);
+    }
+
+private:
+    TProcess* process;
+    Method method;
+    aiMesh** meshes;
+    TResult* results;
+};
+
+template <class TProcess>
+class VoidMeshJob : public PerMeshJob
+{
+public:
+    typedef void (TProcess::*Method)( aiMesh*);
+
+    VoidMeshJob( TProcess* pProcess, Method pMethod, aiMesh** pMeshes)
+        : process( pProcess), method( pMethod), meshes( pMeshes) {}
+
+    void Run( unsigned int pIndex) {
+        (process->*method)( meshes[pIndex]);
+    }
+
+private:
+    TProcess* process;
+    Method method;
+    aiMesh** meshes;
+};
+
 // ---------------------------------------------------------------------------
 /** The BaseProcess defines a common interface for all post processing steps.
  * A post processing step is run after a successful import if the caller
@@ -274,11 +350,55 @@ public:
         return shared;
     }
 
+protected:
+
+    // -------------------------------------------------------------------
+    /** Runs the job once for every mesh index below pNumMeshes.
+    * The meshes are processed concurrently on the Qt thread pool unless
+    * #AI_CONFIG_GLOB_MULTITHREADING asks for serial execution. The call
+    * returns after all meshes are done, an exception thrown by the job
+    * is rethrown here, the one of the lowest mesh index if there are
+    * several.
+    */
+    void RunPerMesh( unsigned int pNumMeshes, PerMeshJob& pJob) const;
+
+    // -------------------------------------------------------------------
+    /** Calls a per mesh method of the step for every mesh in pMeshes,
+    * see RunPerMesh(). The return values are stored in pResults in mesh
+    * order, so the step can reduce them the same way as in a serial loop.
+    */
+    template <class TProcess, typename TResult>
+    void ExecutePerMesh( aiMesh** pMeshes, unsigned int pNumMeshes, TProcess* pProcess,
+        TResult (TProcess::*pMethod)( aiMesh*, unsigned int), TResult* pResults) const
+    {
+        IndexedMeshJob<TProcess, TResult> job( pProcess, pMethod, pMeshes, pResults);
+        RunPerMesh( pNumMeshes, job);
+    }
+
+    template <class TProcess, typename TResult>
+    void ExecutePerMesh( aiMesh** pMeshes, unsigned int pNumMeshes, TProcess* pProcess,
+        TResult (TProcess::*pMethod)( aiMesh*), TResult* pResults) const
+    {
+        MeshJob<TProcess, TResult> job( pProcess, pMethod, pMeshes, pResults);
+        RunPerMesh( pNumMeshes, job);
+    }
+
+    template <class TProcess>
+    void ExecutePerMesh( aiMesh** pMeshes, unsigned int pNumMeshes, TProcess* pProcess,
+        void (TProcess::*pMethod)( aiMesh*)) const
+    {
+        VoidMeshJob<TProcess> job( pProcess, pMethod, pMeshes);
+        RunPerMesh( pNumMeshes, job);
+    }
+
 protected:
 
     /** See the doc of #SharedPostProcessInfo for more details */
     SharedPostProcessInfo* shared;
 
+    /** Number of threads for per mesh work, see #AI_CONFIG_GLOB_MULTITHREADING */
+    int threads;
+
     /** Currently active progress handler */
     ProgressHandler* progress;
 };
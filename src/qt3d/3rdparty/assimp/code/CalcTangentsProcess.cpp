@@ -88,9 +88,12 @@ void CalcTangentsProcess::Execute( aiScene* pScene)
 {
     DefaultLogger::get()->debug("CalcTangentsProcess begin");
 
+    boost::scoped_array<bool> results( new bool[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &CalcTangentsProcess::ProcessMesh, results.get());
+
     bool bHas = false;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++)
-        if (ProcessMesh( pScene->mMeshes[a],a))bHas = true;
+        if (results[a])bHas = true;
 
     if (bHas)DefaultLogger::get()->debug("CalcTangentsProcess finished. Tangents have been calculated");
     else DefaultLogger::get()->debug("CalcTangentsProcess finished");
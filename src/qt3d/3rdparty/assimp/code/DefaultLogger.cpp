@@ -58,6 +58,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 boost::mutex loggerMutex;
 #endif
 
+// Post processing steps log from the threads they run per mesh work on
+#include <QtCore/qmutex.h>
+
+static QMutex streamMutex;
+
 namespace Assimp {
 
 // ----------------------------------------------------------------------------------
@@ -371,6 +376,7 @@ void DefaultLogger::WriteToStreams(const char *message,
     ErrorSeverity ErrorSev )
 {
     ai_assert(NULL != message);
+    QMutexLocker lock(&streamMutex);
 
     // Check whether this is a repeated message
     if (! ::strncmp( message,lastMsg, lastLen-1))
@@ -84,9 +84,7 @@ void FindDegeneratesProcess::SetupProperties(const Importer* pImp)
 void FindDegeneratesProcess::Execute( aiScene* pScene)
 {
     DefaultLogger::get()->debug("FindDegeneratesProcess begin");
-    for (unsigned int i = 0; i < pScene->mNumMeshes;++i){
-        ExecuteOnMesh( pScene->mMeshes[i]);
-    }
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &FindDegeneratesProcess::ExecuteOnMesh);
     DefaultLogger::get()->debug("FindDegeneratesProcess finished");
 }
 
@@ -80,9 +80,12 @@ void GenFaceNormalsProcess::Execute( aiScene* pScene)
         throw DeadlyImportError("Post-processing order mismatch: expecting pseudo-indexed (\"verbose\") vertices here");
     }
 
+    boost::scoped_array<bool> results( new bool[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &GenFaceNormalsProcess::GenMeshFaceNormals, results.get());
+
     bool bHas = false;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++) {
-        if (this->GenMeshFaceNormals( pScene->mMeshes[a])) {
+        if (results[a]) {
             bHas = true;
         }
     }
@@ -90,10 +90,13 @@ void GenVertexNormalsProcess::Execute( aiScene* pScene)
     if (pScene->mFlags & AI_SCENE_FLAGS_NON_VERBOSE_FORMAT)
         throw DeadlyImportError("Post-processing order mismatch: expecting pseudo-indexed (\"verbose\") vertices here");
 
+    boost::scoped_array<bool> results( new bool[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &GenVertexNormalsProcess::GenMeshVertexNormals, results.get());
+
     bool bHas = false;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++)
     {
-        if (GenMeshVertexNormals( pScene->mMeshes[a],a))
+        if (results[a])
             bHas = true;
     }
 
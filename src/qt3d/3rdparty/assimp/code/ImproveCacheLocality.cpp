@@ -93,10 +93,13 @@ void ImproveCacheLocalityProcess::Execute( aiScene* pScene)
 
     DefaultLogger::get()->debug("ImproveCacheLocalityProcess begin");
 
+    boost::scoped_array<float> results( new float[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &ImproveCacheLocalityProcess::ProcessMesh, results.get());
+
     float out = 0.f;
     unsigned int numf = 0, numm = 0;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++){
-        const float res = ProcessMesh( pScene->mMeshes[a],a);
+        const float res = results[a];
         if (res) {
             numf += pScene->mMeshes[a]->mNumFaces;
             out  += res;
@@ -87,9 +87,12 @@ void JoinVerticesProcess::Execute( aiScene* pScene)
         }
     }
     // execute the step
+    boost::scoped_array<int> results( new int[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &JoinVerticesProcess::ProcessMesh, results.get());
+
     int iNumVertices = 0;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++)
-        iNumVertices += ProcessMesh( pScene->mMeshes[a],a);
+        iNumVertices += results[a];
 
     // if logging is active, print detailed statistics
     if (!DefaultLogger::isNullLogger())
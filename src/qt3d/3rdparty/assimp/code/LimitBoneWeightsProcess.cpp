@@ -73,8 +73,7 @@ bool LimitBoneWeightsProcess::IsActive( unsigned int pFlags) const
 void LimitBoneWeightsProcess::Execute( aiScene* pScene)
 {
     DefaultLogger::get()->debug("LimitBoneWeightsProcess begin");
-    for ( unsigned int a = 0; a < pScene->mNumMeshes; a++)
-        ProcessMesh( pScene->mMeshes[a]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &LimitBoneWeightsProcess::ProcessMesh);
 
     DefaultLogger::get()->debug("LimitBoneWeightsProcess end");
 }
@@ -59,47 +59,39 @@ struct Material;
 // ------------------------------------------------------------------------------------------------
 //! \struct Face
 //! \brief Datastructure for a simple obj-face, descripes discredisation and materials
+//!
+//! The indices of all faces are stored in the index arrays of the model, a
+//! face refers to its range in them. Each corner has an entry in all three
+//! arrays, the normal and texture coordinate entries are zero when the face
+//! does not use them.
 struct Face
 {
-    typedef std::vector<unsigned int> IndexArray;
-
     //! Primitive type
     int m_PrimitiveType;
-    //! Vertex indices
-    IndexArray *m_pVertices;
-    //! Normal indices
-    IndexArray *m_pNormals;
-    //! Texture coordinates indices
-    IndexArray *m_pTexturCoords;
+    //! Index of the first corner in the index arrays of the model
+    unsigned int m_uiFirstIndex;
+    //! Number of corners
+    unsigned int m_uiNumIndices;
+    //! Number of corners with a texture coordinate index
+    unsigned int m_uiNumTexturCoords;
+    //! True, if the corners have normal indices
+    bool m_hasNormals;
     //! Pointer to assigned material
     Material *m_pMaterial;
 
     //! \brief Default constructor
-    //! \param pVertices Pointer to assigned vertex indexbuffer
-    //! \param pNormals Pointer to assigned normals indexbuffer
-    //! \param pTexCoords Pointer to assigned texture indexbuffer
-    Face( std::vector<unsigned int> *pVertices,
-            std::vector<unsigned int> *pNormals,
-            std::vector<unsigned int> *pTexCoords) :
+    //! \param uiFirstIndex Index of the first corner in the model index arrays
+    //! \param uiNumIndices Number of corners
+    Face( unsigned int uiFirstIndex = 0, unsigned int uiNumIndices = 0 ) :
         m_PrimitiveType( 2 ),
-        m_pVertices( pVertices ),
-        m_pNormals( pNormals ),
-        m_pTexturCoords( pTexCoords ),
+        m_uiFirstIndex( uiFirstIndex ),
+        m_uiNumIndices( uiNumIndices ),
+        m_uiNumTexturCoords( 0 ),
+        m_hasNormals( false ),
         m_pMaterial( 0L )
     {
         // empty
     }
-
-    //! \brief Destructor
-    ~Face()
-    {
-        delete m_pVertices;
-        m_pVertices = NULL;
-        delete m_pNormals;
-        m_pNormals = NULL;
-        delete m_pTexturCoords;
-        m_pTexturCoords = NULL;
-    }
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -197,8 +189,8 @@ struct Mesh
 {
     static const unsigned int NoMaterial = 999999999;
 
-    /// Array with pointer to all stored faces
-    std::vector<Face*> m_Faces;
+    /// Array with all stored faces
+    std::vector<Face> m_Faces;
     /// Assigned material
     Material *m_pMaterial;
     /// Number of stored indices.
@@ -222,12 +214,7 @@ struct Mesh
     /// Destructor
     ~Mesh()
     {
-        for (std::vector<Face*>::iterator it = m_Faces.begin();
-            it != m_Faces.end(); ++it)
-        {
-            delete *it;
-        }
-
+        // empty
     }
 };
 
@@ -266,6 +253,12 @@ struct Model
     std::string m_strActiveGroup;
     //! Vector with generated texture coordinates
     std::vector<aiVector2D> m_TextureCoord;
+    //! Vertex indices of all face corners
+    std::vector<unsigned int> m_FaceVertices;
+    //! Normal indices of all face corners
+    std::vector<unsigned int> m_FaceNormals;
+    //! Texture coordinate indices of all face corners
+    std::vector<unsigned int> m_FaceTexturCoords;
     //! Current mesh instance
     Mesh *m_pCurrentMesh;
     //! Vector with stored meshes
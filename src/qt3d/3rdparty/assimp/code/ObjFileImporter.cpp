@@ -263,16 +263,16 @@ void ObjFileImporter::createTopology(const ObjFile::Model* pModel,
         for (size_t index = 0; index < pObjMesh->m_Faces.size(); index++)
         {
             aiFace *pFace = &pMesh->mFaces[ index ];
-            const unsigned int uiNumIndices = (unsigned int) pObjMesh->m_Faces[ index ]->m_pVertices->size();
+            const ObjFile::Face &rSourceFace = pObjMesh->m_Faces[ index ];
+            const unsigned int uiNumIndices = rSourceFace.m_uiNumIndices;
             pFace->mNumIndices = (unsigned int) uiNumIndices;
             if (pFace->mNumIndices > 0)
             {
                 pFace->mIndices = new unsigned int[ uiNumIndices ];
-                ObjFile::Face::IndexArray *pIndexArray = pObjMesh->m_Faces[ index ]->m_pVertices;
-                ai_assert ( NULL != pIndexArray );
+                const unsigned int *pIndexArray = &pModel->m_FaceVertices[ rSourceFace.m_uiFirstIndex ];
                 for ( size_t a=0; a<pFace->mNumIndices; a++ )
                 {
-                    pFace->mIndices[ a ] = pIndexArray->at( a );
+                    pFace->mIndices[ a ] = pIndexArray[ a ];
                 }
             }
             else
@@ -328,19 +328,20 @@ void ObjFileImporter::createVertexArray(const ObjFile::Model* pModel,
         aiFace *pDestFace = &pMesh->mFaces[ index ];
 
         // Get source face
-        ObjFile::Face *pSourceFace = pObjMesh->m_Faces[ index ];
+        const ObjFile::Face &rSourceFace = pObjMesh->m_Faces[ index ];
+        const unsigned int uiFirstIndex = rSourceFace.m_uiFirstIndex;
 
         // Copy all index arrays
-        for ( size_t vertexIndex = 0; vertexIndex < pSourceFace->m_pVertices->size(); vertexIndex++ )
+        for ( size_t vertexIndex = 0; vertexIndex < rSourceFace.m_uiNumIndices; vertexIndex++ )
         {
-            const unsigned int vertex = pSourceFace->m_pVertices->at( vertexIndex );
+            const unsigned int vertex = pModel->m_FaceVertices[ uiFirstIndex + vertexIndex ];
             ai_assert( vertex < pModel->m_Vertices.size() );
             pMesh->mVertices[ newIndex ] = pModel->m_Vertices[ vertex ];
 
             // Copy all normals
-            if ( !pSourceFace->m_pNormals->empty() )
+            if ( rSourceFace.m_hasNormals )
             {
-                const unsigned int normal = pSourceFace->m_pNormals->at( vertexIndex );
+                const unsigned int normal = pModel->m_FaceNormals[ uiFirstIndex + vertexIndex ];
                 ai_assert( normal < pModel->m_Normals.size() );
                 pMesh->mNormals[ newIndex ] = pModel->m_Normals[ normal ];
             }
@@ -348,9 +349,9 @@ void ObjFileImporter::createVertexArray(const ObjFile::Model* pModel,
             // Copy all texture coordinates
             if ( !pModel->m_TextureCoord.empty() )
             {
-                if ( !pSourceFace->m_pTexturCoords->empty() )
+                if ( rSourceFace.m_uiNumTexturCoords > 0 )
                 {
-                    const unsigned int tex = pSourceFace->m_pTexturCoords->at( vertexIndex );
+                    const unsigned int tex = pModel->m_FaceTexturCoords[ uiFirstIndex + vertexIndex ];
                     ai_assert( tex < pModel->m_TextureCoord.size() );
                     for ( size_t i=0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; i++ )
                     {
@@ -76,6 +76,7 @@ ObjFileParser::ObjFileParser(std::vector<char> &Data,const std::string &strModel
     m_pModel->m_MaterialMap[ DEFAULT_MATERIAL ] = m_pModel->m_pDefaultMaterial;
 
     // Start parsing the file
+    reserveStorage(Data);
     parseFile();
 }
 
@@ -183,55 +184,94 @@ void ObjFileParser::parseFile()
 }
 
 // -------------------------------------------------------------------
-// Copy the next word in a temporary buffer
-void ObjFileParser::copyNextWord(char *pBuffer, size_t length)
+// Pre-sizes the model arrays, so that the parse pass does not need to
+// reallocate them. Counts the vertex, normal and texture coordinate
+// definitions and the face corners.
+void ObjFileParser::reserveStorage(const std::vector<char> &Data)
 {
-    size_t index = 0;
-    m_DataIt = getNextWord<DataArrayIt>(m_DataIt, m_DataItEnd);
-    while ( !isSeparator(*m_DataIt) && m_DataIt != m_DataItEnd )
+    if (Data.empty())
+        return;
+
+    size_t numVertices = 0, numNormals = 0, numTexCoords = 0, numCorners = 0;
+    const char *pPtr = &Data[0];
+    const char *pEnd = pPtr + Data.size();
+    while (pPtr < pEnd)
     {
-        pBuffer[index] = *m_DataIt;
-        index++;
-        if (index == length-1)
+        while (pPtr < pEnd && (*pPtr == ' ' || *pPtr == '\t'))
+            ++pPtr;
+        if (pEnd - pPtr >= 2)
+        {
+            if (pPtr[0] == 'v')
+            {
+                if (pPtr[1] == ' ' || pPtr[1] == '\t')
+                    ++numVertices;
+                else if (pPtr[1] == 'n')
+                    ++numNormals;
+                else if (pPtr[1] == 't')
+                    ++numTexCoords;
+            }
+            else if (pPtr[0] == 'f' && (pPtr[1] == ' ' || pPtr[1] == '\t'))
+            {
+                // Count the corners, one per whitespace separated token
+                ++pPtr;
+                while (pPtr < pEnd && !isNewLine(*pPtr) && *pPtr != '\0')
+                {
+                    while (pPtr < pEnd && (*pPtr == ' ' || *pPtr == '\t'))
+                        ++pPtr;
+                    if (pPtr == pEnd || isNewLine(*pPtr) || *pPtr == '\0')
+                        break;
+                    ++numCorners;
+                    while (pPtr < pEnd && !isSeparator(*pPtr) && *pPtr != '\0')
+                        ++pPtr;
+                }
+            }
+        }
+
+        pPtr = static_cast<const char*>(::memchr(pPtr, '\n', pEnd - pPtr));
+        if (NULL == pPtr)
             break;
-        ++m_DataIt;
+        ++pPtr;
     }
-    pBuffer[index] = '\0';
+
+    m_pModel->m_Vertices.reserve(numVertices);
+    m_pModel->m_Normals.reserve(numNormals);
+    m_pModel->m_TextureCoord.reserve(numTexCoords);
+    m_pModel->m_FaceVertices.reserve(numCorners);
+    m_pModel->m_FaceNormals.reserve(numCorners);
+    m_pModel->m_FaceTexturCoords.reserve(numCorners);
 }
 
 // -------------------------------------------------------------------
-// Copy the next line into a temporary buffer
-void ObjFileParser::copyNextLine(char *pBuffer, size_t length)
+// Parses the next float of the current line in place. Returns zero if
+// the line has no more values.
+static inline float parseNextFloat(const char *&pPtr)
 {
-    size_t index = 0;
-    while (m_DataIt != m_DataItEnd)
-    {
-        if (*m_DataIt == '\n' || *m_DataIt == '\r' || index == length-1)
-            break;
+    while (*pPtr == ' ' || *pPtr == '\t')
+        ++pPtr;
 
-        pBuffer[ index ] = *m_DataIt;
-        ++index;
-        ++m_DataIt;
+    float value = 0.0f;
+    if (*pPtr != '\0' && !isNewLine(*pPtr))
+    {
+        pPtr = fast_atof_move(pPtr, value);
+        // Skip the rest of a malformed token
+        while (*pPtr != '\0' && !isSeparator(*pPtr))
+            ++pPtr;
     }
-    pBuffer[ index ] = '\0';
+    return value;
 }
 
 // -------------------------------------------------------------------
 // Get values for a new 3D vector instance
 void ObjFileParser::getVector3(std::vector<aiVector3D> &point3d_array)
 {
-    float x, y, z;
-    copyNextWord(m_buffer, BUFFERSIZE);
-    x = (float) fast_atof(m_buffer);
-
-    copyNextWord(m_buffer, BUFFERSIZE);
-    y = (float) fast_atof(m_buffer);
-
-    copyNextWord(m_buffer, BUFFERSIZE);
-    z = (float) fast_atof(m_buffer);
-
+    const char *pStart = &(*m_DataIt);
+    const char *pPtr = pStart;
+    const float x = parseNextFloat(pPtr);
+    const float y = parseNextFloat(pPtr);
+    const float z = parseNextFloat(pPtr);
     point3d_array.push_back( aiVector3D( x, y, z ) );
-    //skipLine();
+
+    m_DataIt += pPtr - pStart;
     m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
 }
 
@@ -239,106 +279,93 @@ void ObjFileParser::getVector3(std::vector<aiVector3D> &point3d_array)
 // Get values for a new 2D vector instance
 void ObjFileParser::getVector2( std::vector<aiVector2D> &point2d_array )
 {
-    float x, y;
-    copyNextWord(m_buffer, BUFFERSIZE);
-    x = (float) fast_atof(m_buffer);
-
-    copyNextWord(m_buffer, BUFFERSIZE);
-    y = (float) fast_atof(m_buffer);
-
+    const char *pStart = &(*m_DataIt);
+    const char *pPtr = pStart;
+    const float x = parseNextFloat(pPtr);
+    const float y = parseNextFloat(pPtr);
     point2d_array.push_back(aiVector2D(x, y));
 
+    m_DataIt += pPtr - pStart;
     m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
 }
 
 // -------------------------------------------------------------------
-// Get values for a new face instance
+// Get values for a new face instance. The corners are parsed in place
+// and appended to the index arrays of the model.
 void ObjFileParser::getFace()
 {
-    copyNextLine(m_buffer, BUFFERSIZE);
-    if (m_DataIt == m_DataItEnd)
-        return;
+    // Skip the 'f'
+    const char *pStart = &(*m_DataIt);
+    const char *pPtr = pStart + 1;
 
-    char *pPtr = m_buffer;
-    char *pEnd = &pPtr[BUFFERSIZE];
-    pPtr = getNextToken<char*>(pPtr, pEnd);
-    if (pPtr == '\0')
-        return;
+    std::vector<unsigned int> &rVertices = m_pModel->m_FaceVertices;
+    std::vector<unsigned int> &rNormals = m_pModel->m_FaceNormals;
+    std::vector<unsigned int> &rTexCoords = m_pModel->m_FaceTexturCoords;
+    ObjFile::Face face( (unsigned int) rVertices.size() );
 
-    std::vector<unsigned int> *pIndices = new std::vector<unsigned int>;
-    std::vector<unsigned int> *pTexID = new std::vector<unsigned int>;
-    std::vector<unsigned int> *pNormalID = new std::vector<unsigned int>;
-    bool hasNormal = false;
-
-    bool vt = (!m_pModel->m_TextureCoord.empty());
-    bool vn = (!m_pModel->m_Normals.empty());
-    int iStep = 0, iPos = 0;
-    while (pPtr != pEnd)
+    while (true)
     {
-        iStep = 1;
-        if (*pPtr == '\0')
-            break;
-
-        if (*pPtr=='\r')
+        while (*pPtr == ' ' || *pPtr == '\t')
+            ++pPtr;
+        if (*pPtr == '\0' || isNewLine(*pPtr))
             break;
 
-        if (*pPtr=='/' )
+        // One corner: v, v/vt, v//vn or v/vt/vn. OBJ uses 1 based indices.
+        unsigned int indices[3] = { 0, 0, 0 };
+        bool present[3] = { false, false, false };
+        int iPos = 0;
+        while (*pPtr != '\0' && !isSeparator(*pPtr))
         {
-            if (iPos == 0)
+            if (*pPtr == '/')
             {
-                //if there are no texturecoordinates in the obj file but normals
-                if (!vt && vn) {
-                    iPos = 1;
-                    iStep++;
-                }
+                ++iPos;
+                ++pPtr;
             }
-            iPos++;
-        }
-        else if ( isSeparator(*pPtr) )
-        {
-            iPos = 0;
-        }
-        else
-        {
-            //OBJ USES 1 Base ARRAYS!!!!
-            const int iVal = atoi( pPtr );
-            int tmp = iVal;
-            while ( ( tmp = tmp / 10 )!=0 )
-                ++iStep;
-
-            if ( iVal > 0 )
+            else if (*pPtr >= '0' && *pPtr <= '9')
             {
-                // Store parsed index
-                if ( 0 == iPos )
-                {
-                    pIndices->push_back( iVal-1 );
-                }
-                else if ( 1 == iPos )
+                const unsigned int iVal = strtol10(pPtr, &pPtr);
+                if (iPos > 2)
                 {
-                    pTexID->push_back( iVal-1 );
+                    DefaultLogger::get()->error("OBJ: Not supported token in face description detected");
                 }
-                else if ( 2 == iPos )
+                else if (iVal > 0)
                 {
-                    pNormalID->push_back( iVal-1 );
-                    hasNormal = true;
-                }
-                else
-                {
-                    reportErrorTokenInFace();
+                    indices[iPos] = iVal - 1;
+                    present[iPos] = true;
                 }
             }
+            else
+            {
+                // Relative indices are not supported
+                ++pPtr;
+            }
         }
-        for ( int i=0; i<iStep; i++ )
-            ++pPtr;
+
+        if (!present[0])
+            continue;
+
+        rVertices.push_back(indices[0]);
+        rTexCoords.push_back(indices[1]);
+        rNormals.push_back(indices[2]);
+        if (present[1])
+            ++face.m_uiNumTexturCoords;
+        if (present[2])
+            face.m_hasNormals = true;
+        ++face.m_uiNumIndices;
     }
 
-    ObjFile::Face *face = new ObjFile::Face( pIndices, pNormalID, pTexID );
+    m_DataIt += pPtr - pStart;
+    if (0 == face.m_uiNumIndices)
+    {
+        m_DataIt = skipLine<DataArrayIt>( m_DataIt, m_DataItEnd, m_uiLine );
+        return;
+    }
 
     // Set active material, if one set
     if (NULL != m_pModel->m_pCurrentMaterial)
-        face->m_pMaterial = m_pModel->m_pCurrentMaterial;
+        face.m_pMaterial = m_pModel->m_pCurrentMaterial;
     else
-        face->m_pMaterial = m_pModel->m_pDefaultMaterial;
+        face.m_pMaterial = m_pModel->m_pDefaultMaterial;
 
     // Create a default object, if nothing there
     if ( NULL == m_pModel->m_pCurrent )
@@ -352,9 +379,9 @@ void ObjFileParser::getFace()
 
     // Store the face
     m_pModel->m_pCurrentMesh->m_Faces.push_back( face );
-    m_pModel->m_pCurrentMesh->m_uiNumIndices += (unsigned int)face->m_pVertices->size();
-    m_pModel->m_pCurrentMesh->m_uiUVCoordinates[ 0 ] += (unsigned int)face->m_pTexturCoords[0].size();
-    if ( !m_pModel->m_pCurrentMesh->m_hasNormals && hasNormal )
+    m_pModel->m_pCurrentMesh->m_uiNumIndices += face.m_uiNumIndices;
+    m_pModel->m_pCurrentMesh->m_uiUVCoordinates[ 0 ] += face.m_uiNumTexturCoords;
+    if ( !m_pModel->m_pCurrentMesh->m_hasNormals && face.m_hasNormals )
     {
         m_pModel->m_pCurrentMesh->m_hasNormals = true;
     }
@@ -65,7 +65,6 @@ class IOSystem;
 class ObjFileParser
 {
 public:
-    static const size_t BUFFERSIZE = 4096;
     typedef std::vector<char> DataArray;
     typedef std::vector<char>::iterator DataArrayIt;
     typedef std::vector<char>::const_iterator ConstDataArrayIt;
@@ -79,12 +78,10 @@ public:
     ObjFile::Model *GetModel() const;
 
 private:
+    /// Pre-sizes the model arrays for the data in the file
+    void reserveStorage(const std::vector<char> &Data);
     /// Parse the loadedfile
     void parseFile();
-    /// Method to copy the new delimited word in the current line.
-    void copyNextWord(char *pBuffer, size_t length);
-    /// Method to copy the new line.
-    void copyNextLine(char *pBuffer, size_t length);
     /// Stores the following 3d vector.
     void getVector3( std::vector<aiVector3D> &point3d_array );
     /// Stores the following 3d vector.
@@ -126,8 +123,6 @@ private:
     ObjFile::Model *m_pModel;
     //! Current line (for debugging)
     unsigned int m_uiLine;
-    //! Helper buffer
-    char m_buffer[BUFFERSIZE];
     /// Pointer to IO system instance.
     IOSystem *m_pIO;
 };
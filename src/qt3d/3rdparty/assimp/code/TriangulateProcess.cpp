@@ -89,10 +89,13 @@ void TriangulateProcess::Execute( aiScene* pScene)
 {
     DefaultLogger::get()->debug("TriangulateProcess begin");
 
+    boost::scoped_array<bool> results( new bool[pScene->mNumMeshes]);
+    ExecutePerMesh( pScene->mMeshes, pScene->mNumMeshes, this, &TriangulateProcess::TriangulateMesh, results.get());
+
     bool bHas = false;
     for ( unsigned int a = 0; a < pScene->mNumMeshes; a++)
     {
-        if ( TriangulateMesh( pScene->mMeshes[a]))
+        if ( results[a])
             bHas = true;
     }
     if (bHas)DefaultLogger::get()->info ("TriangulateProcess finished. All polygons have been triangulated.");
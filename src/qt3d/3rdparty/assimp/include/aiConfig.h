@@ -77,12 +77,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define AI_CONFIG_GLOB_MEASURE_TIME  \
     "GLOB_MEASURE_TIME"
 
-# if 0 // not implemented yet
 // ---------------------------------------------------------------------------
 /** @brief Set Assimp's multithreading policy.
  *
- * This setting is ignored if Assimp was built without boost.thread
- * support (ASSIMP_BUILD_NO_THREADING, which is implied by ASSIMP_BUILD_BOOST_WORKAROUND).
+ * The post processing steps that work on each mesh on its own (normal and
+ * tangent generation, vertex joining, cache locality optimization,
+ * triangulation, degenerate removal and bone weight limiting) process the
+ * meshes of a scene concurrently on the Qt thread pool. The output does
+ * not depend on this setting.
  * Possible values are: -1 to let Assimp decide what to do, 0 to disable
  * multithreading entirely and any number larger than 0 to force a specific
  * number of threads. Assimp is always free to ignore this settings, which is
@@ -90,12 +92,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * Assimp is used concurrently from multiple user threads, it might be useful
  * to limit each Importer instance to a specific number of cores.
  *
- * For more information, see the @link threading Threading page@endlink.
  * Property type: int, default value: -1.
  */
 #define AI_CONFIG_GLOB_MULTITHREADING  \
     "GLOB_MULTITHREADING"
-#endif
 
 // ###########################################################################
 // POST PROCESSING SETTINGS
@@ -5,6 +5,13 @@
 #INCLUDEPATH += src/plugins/sceneformats/assimp
 #INCLUDEPATH += 3rdparty/assimp/include
 
+# The scene loading downloads remote scenes through QtNetwork.
+QT += opengl network
+
+# The built-in scene handlers are included as qt3d/src/plugins/..., also
+# from the projects outside of this directory.
+INCLUDEPATH += $$PWD/..
+
 include(3rdparty/assimp/assimp.pri)
 
 include(src/threed/global/global.pri)
@@ -30,7 +37,10 @@ HEADERS += \
     $$PWD/src/plugins/sceneformats/assimp/qaiscenehandler.h \
     $$PWD/src/plugins/sceneformats/assimp/qaimesh.h \
     $$PWD/src/plugins/sceneformats/assimp/ailoaderiostream.h \
-    $$PWD/src/plugins/sceneformats/assimp/ailoaderiosystem.h
+    $$PWD/src/plugins/sceneformats/assimp/ailoaderiosystem.h \
+    $$PWD/src/plugins/sceneformats/mesh/qglmeshformat_p.h \
+    $$PWD/src/plugins/sceneformats/mesh/qglmeshscene.h \
+    $$PWD/src/plugins/sceneformats/mesh/qglmeshscenehandler.h
 
 SOURCES += \
     $$PWD/src/plugins/sceneformats/assimp/qailoader.cpp \
@@ -39,6 +49,8 @@ SOURCES += \
     $$PWD/src/plugins/sceneformats/assimp/qaimesh.cpp \
     $$PWD/src/plugins/sceneformats/assimp/ailoaderiostream.cpp \
     $$PWD/src/plugins/sceneformats/assimp/ailoaderiosystem.cpp \
-    $$PWD/src/plugins/sceneformats/assimp/pluginmain.cpp
+    $$PWD/src/plugins/sceneformats/assimp/pluginmain.cpp \
+    $$PWD/src/plugins/sceneformats/mesh/qglmeshscene.cpp \
+    $$PWD/src/plugins/sceneformats/mesh/qglmeshscenehandler.cpp
 
 HEADERS += $$PRIVATE_HEADERS
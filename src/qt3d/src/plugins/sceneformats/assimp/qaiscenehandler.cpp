@@ -122,6 +122,7 @@ void QAiSceneHandler::decodeOptions(const QString &options)
         "UseVertexColors",
         "VertexSplitLimitx2",
         "TriangleSplitLimitx2",
+        "SerialPostProcess",
         0
     };
 
@@ -202,6 +203,9 @@ void QAiSceneHandler::decodeOptions(const QString &options)
                 // ....and we're OK with that, just don't overdo it
                 m_meshSplitTriangleLimit <<= 1;
                 break;
+            case SerialPostProcess:
+                m_importer.SetPropertyInteger(AI_CONFIG_GLOB_MULTITHREADING, 0);
+                break;
             }
         }
         else
@@ -75,7 +75,8 @@ public:
         FlipWinding,         // makes faces CW instead of CCW
         UseVertexColors,     // use vertex colors that are in a model
         VertexSplitLimitx2,  // double the vertex count which will split a large mesh
-        TriangleSplitLimitx2 // double the triangle count which will split a large mesh
+        TriangleSplitLimitx2, // double the triangle count which will split a large mesh
+        SerialPostProcess    // post process the meshes one at a time on the loading thread
     };
 
     QAiSceneHandler();
@@ -0,0 +1,143 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGLMESHFORMAT_P_H
+#define QGLMESHFORMAT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the mesh scene format plugin and the mesh exporter.  This header
+// file may change from version to version without notice, or even be
+// removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Layout of a .qmesh file.  All values are in the byte order of the
+    machine that wrote the file, which is checked with the byteOrder
+    field of the header.  The file starts with a QGLMeshFileHeader
+    followed by the node, material and geometry tables, the string
+    table and the data blobs, each aligned to QGL_MESH_FILE_ALIGNMENT
+    bytes so that a memory mapped file can be used in place.
+
+    Each geometry stores its vertex attributes as separate tightly
+    packed streams in the in-memory layout of QVector3D, QVector2D and
+    QColor4ub, which is the layout QGeometryData keeps them in, and
+    its indices as 16 or 32 bit integers.
+
+    Nodes are stored parents first, so that the parent of a node has
+    always been created when the node is read.  Strings are UTF-8 and
+    zero terminated, and are referred to by their offset in the string
+    table.  The empty string is at offset 0.
+*/
+
+#define QGL_MESH_FILE_MAGIC "QMSH"
+#define QGL_MESH_FILE_VERSION 1
+#define QGL_MESH_FILE_BYTE_ORDER 0x01020304
+#define QGL_MESH_FILE_ALIGNMENT 16
+
+// Vertex attribute streams, in the order of QGL::VertexAttribute.
+#define QGL_MESH_FILE_STREAMS 6
+
+struct QGLMeshFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 byteOrder;
+    quint32 fileSize;
+    quint32 nodeCount;
+    quint32 nodeOffset;
+    quint32 materialCount;
+    quint32 materialOffset;
+    quint32 geometryCount;
+    quint32 geometryOffset;
+    quint32 stringsSize;
+    quint32 stringsOffset;
+};
+
+struct QGLMeshFileNode
+{
+    qint32 parent;
+    quint32 name;
+    qint32 geometry;
+    quint32 start;
+    quint32 count;
+    qint32 materialIndex;
+    qint32 backMaterialIndex;
+    quint32 drawingMode;
+    quint32 options;
+    float position[3];
+    float transform[16];
+};
+
+struct QGLMeshFileMaterial
+{
+    quint32 name;
+    quint32 textureUrl;
+    float ambientColor[4];
+    float diffuseColor[4];
+    float specularColor[4];
+    float emittedLight[4];
+    float shininess;
+};
+
+struct QGLMeshFileGeometry
+{
+    quint32 vertexCount;
+    quint32 fields;
+    quint32 streamOffsets[QGL_MESH_FILE_STREAMS];
+    quint32 indexCount;
+    quint32 indexSize;
+    quint32 indexOffset;
+    quint32 bufferStrategy;
+};
+
+QT_END_NAMESPACE
+
+#endif
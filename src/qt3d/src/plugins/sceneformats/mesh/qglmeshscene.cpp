@@ -0,0 +1,400 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qglmeshscene.h"
+#include "qglmeshformat_p.h"
+#include "qglscenenode.h"
+#include "qglmaterial.h"
+#include "qglmaterialcollection.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qdebug.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QGLMeshScene
+    \internal
+    \brief The QGLMeshScene class is a scene loaded from a .qmesh file.
+
+    The file is memory mapped when it is a local file or a resource, and
+    the vertex and index blobs are used in place by the geometry of the
+    scene, so loading does not parse or copy the mesh data.  Only the
+    indices are read, to check that they refer to stored vertices.  The
+    blobs are copied when they are modified, or when the layout of the
+    file does not match the in-memory layout of this platform.
+
+    The nodes of the scene, and any clones of them, refer to the file
+    data, so they must not outlive the scene unless their geometry has
+    been detached.
+*/
+
+QGLMeshScene::QGLMeshScene(QObject *parent)
+    : QGLAbstractScene(parent)
+    , mainObject(0)
+    , mappedFile(0)
+{
+}
+
+QGLMeshScene::~QGLMeshScene()
+{
+    // The nodes refer to the mapped data, destroy them before unmapping.
+    delete mainObject;
+}
+
+QList<QObject *> QGLMeshScene::objects() const
+{
+    QList<QObject *> objs;
+    if (!mainObject)
+        return objs;
+    objs.append(mainObject);
+    QList<QGLSceneNode *> children = mainObject->allChildren();
+    for (int index = 0; index < children.size(); ++index)
+        objs.append(children.at(index));
+    return objs;
+}
+
+QGLSceneNode *QGLMeshScene::mainNode() const
+{
+    return mainObject;
+}
+
+/*!
+    \internal
+    Returns the contents of \a device and stores their size in \a size.
+    Files, including resources, are memory mapped and other devices
+    are read into memory.
+*/
+const uchar *QGLMeshScene::mapData(QIODevice *device, qint64 *size)
+{
+    QFile *file = qobject_cast<QFile *>(device);
+    if (file && !file->fileName().isEmpty()) {
+        // The device belongs to the caller, map a file of our own.
+        mappedFile = new QFile(file->fileName(), this);
+        if (mappedFile->open(QIODevice::ReadOnly)) {
+            *size = mappedFile->size();
+            uchar *data = mappedFile->map(0, *size);
+            if (data)
+                return data;
+        }
+        delete mappedFile;
+        mappedFile = 0;
+    }
+
+    fileData = device->readAll();
+    *size = fileData.size();
+    return reinterpret_cast<const uchar *>(fileData.constData());
+}
+
+static inline bool isAligned(const uchar *data, int alignment)
+{
+    return (quintptr(data) % alignment) == 0;
+}
+
+static inline bool inRange(quint64 offset, quint64 length, qint64 size)
+{
+    return offset + length <= quint64(size);
+}
+
+static QVector3DArray vector3DArray(const uchar *data, int count)
+{
+    if (sizeof(QVector3D) == 3 * sizeof(float) && isAligned(data, sizeof(float)))
+        return QVector3DArray::fromRawData(reinterpret_cast<const QVector3D *>(data), count);
+    QVector3DArray array;
+    array.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        float values[3];
+        memcpy(values, data + index * sizeof(values), sizeof(values));
+        array.append(values[0], values[1], values[2]);
+    }
+    return array;
+}
+
+static QVector2DArray vector2DArray(const uchar *data, int count)
+{
+    if (sizeof(QVector2D) == 2 * sizeof(float) && isAligned(data, sizeof(float)))
+        return QVector2DArray::fromRawData(reinterpret_cast<const QVector2D *>(data), count);
+    QVector2DArray array;
+    array.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        float values[2];
+        memcpy(values, data + index * sizeof(values), sizeof(values));
+        array.append(values[0], values[1]);
+    }
+    return array;
+}
+
+static QArray<QColor4ub> colorArray(const uchar *data, int count)
+{
+    if (sizeof(QColor4ub) == 4)
+        return QArray<QColor4ub>::fromRawData(reinterpret_cast<const QColor4ub *>(data), count);
+    QArray<QColor4ub> array;
+    array.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        const uchar *color = data + index * 4;
+        array.append(QColor4ub(color[0], color[1], color[2], color[3]));
+    }
+    return array;
+}
+
+static QGL::IndexArray indexArray(const uchar *data, int count, int size)
+{
+    typedef QGL::IndexArray::value_type IndexType;
+    if (size == int(sizeof(IndexType)) && isAligned(data, size))
+        return QGL::IndexArray::fromRawData(reinterpret_cast<const IndexType *>(data), count);
+    QGL::IndexArray array;
+    array.reserve(count);
+    for (int index = 0; index < count; ++index) {
+        if (size == 2) {
+            quint16 value;
+            memcpy(&value, data + index * 2, 2);
+            array.append(value);
+        } else {
+            quint32 value;
+            memcpy(&value, data + index * 4, 4);
+            array.append(IndexType(value));
+        }
+    }
+    return array;
+}
+
+// Returns true if all of the \a count indices of \a size bytes at
+// \a data refer to one of the \a vertexCount vertices.
+static bool indicesInRange(const uchar *data, int count, int size,
+                           quint32 vertexCount)
+{
+    for (int index = 0; index < count; ++index) {
+        quint32 value;
+        if (size == 2) {
+            quint16 shortValue;
+            memcpy(&shortValue, data + index * 2, 2);
+            value = shortValue;
+        } else {
+            memcpy(&value, data + index * 4, 4);
+        }
+        if (value >= vertexCount)
+            return false;
+    }
+    return true;
+}
+
+static QColor loadColor(const float *values)
+{
+    QColor color;
+    color.setRgbF(qBound(0.0f, values[0], 1.0f), qBound(0.0f, values[1], 1.0f),
+                  qBound(0.0f, values[2], 1.0f), qBound(0.0f, values[3], 1.0f));
+    return color;
+}
+
+/*!
+    \internal
+    Loads the scene from \a device.  Relative texture URLs are resolved
+    against \a url.  Returns false if the data is not a valid .qmesh file
+    for this platform.
+*/
+bool QGLMeshScene::load(QIODevice *device, const QUrl &url)
+{
+    qint64 size = 0;
+    const uchar *data = mapData(device, &size);
+    if (!data || size < qint64(sizeof(QGLMeshFileHeader)))
+        return false;
+
+    QGLMeshFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, QGL_MESH_FILE_MAGIC, 4) != 0 ||
+            header.version != QGL_MESH_FILE_VERSION) {
+        return false;
+    }
+    if (header.byteOrder != QGL_MESH_FILE_BYTE_ORDER) {
+        qWarning("QGLMeshScene: the mesh was written for another byte order");
+        return false;
+    }
+    if (header.fileSize > quint64(size) || header.nodeCount == 0 ||
+            !inRange(header.nodeOffset,
+                     quint64(header.nodeCount) * sizeof(QGLMeshFileNode), size) ||
+            !inRange(header.materialOffset,
+                     quint64(header.materialCount) * sizeof(QGLMeshFileMaterial), size) ||
+            !inRange(header.geometryOffset,
+                     quint64(header.geometryCount) * sizeof(QGLMeshFileGeometry), size) ||
+            !inRange(header.stringsOffset, header.stringsSize, size) ||
+            header.stringsSize == 0 ||
+            data[header.stringsOffset + header.stringsSize - 1] != '\0') {
+        return false;
+    }
+
+    const char *strings =
+            reinterpret_cast<const char *>(data + header.stringsOffset);
+
+    // Geometry
+    QVector<QGeometryData> geometries;
+    geometries.reserve(header.geometryCount);
+    for (quint32 index = 0; index < header.geometryCount; ++index) {
+        QGLMeshFileGeometry entry;
+        memcpy(&entry, data + header.geometryOffset +
+               index * sizeof(QGLMeshFileGeometry), sizeof(entry));
+
+        QGeometryData geometry;
+        for (int field = 0; field < QGL_MESH_FILE_STREAMS; ++field) {
+            QGL::VertexAttribute attribute = QGL::VertexAttribute(field);
+            if (!(entry.fields & QGL::fieldMask(attribute)))
+                continue;
+            int elementSize = 2 * sizeof(float);
+            if (attribute == QGL::Position || attribute == QGL::Normal)
+                elementSize = 3 * sizeof(float);
+            else if (attribute == QGL::Color)
+                elementSize = 4;
+            if (!inRange(entry.streamOffsets[field],
+                         quint64(entry.vertexCount) * elementSize, size)) {
+                return false;
+            }
+
+            const uchar *stream = data + entry.streamOffsets[field];
+            if (attribute == QGL::Position)
+                geometry.appendVertexArray(vector3DArray(stream, entry.vertexCount));
+            else if (attribute == QGL::Normal)
+                geometry.appendNormalArray(vector3DArray(stream, entry.vertexCount));
+            else if (attribute == QGL::Color)
+                geometry.appendColorArray(colorArray(stream, entry.vertexCount));
+            else
+                geometry.appendTexCoordArray(vector2DArray(stream, entry.vertexCount), attribute);
+        }
+
+        if ((entry.indexSize != 2 && entry.indexSize != 4) ||
+                !inRange(entry.indexOffset,
+                         quint64(entry.indexCount) * entry.indexSize, size) ||
+                !indicesInRange(data + entry.indexOffset, entry.indexCount,
+                                entry.indexSize, entry.vertexCount)) {
+            return false;
+        }
+        if (entry.indexCount > 0) {
+            geometry.appendIndices(indexArray(data + entry.indexOffset,
+                                              entry.indexCount,
+                                              entry.indexSize));
+        }
+        geometry.setBufferStrategy(QGeometryData::BufferStrategy(entry.bufferStrategy));
+        geometries.append(geometry);
+    }
+
+    // Materials
+    QGLMaterialCollection *palette = new QGLMaterialCollection;
+    for (quint32 index = 0; index < header.materialCount; ++index) {
+        QGLMeshFileMaterial entry;
+        memcpy(&entry, data + header.materialOffset +
+               index * sizeof(QGLMeshFileMaterial), sizeof(entry));
+        if (entry.name >= header.stringsSize ||
+                entry.textureUrl >= header.stringsSize) {
+            delete palette;
+            return false;
+        }
+
+        QGLMaterial *material = new QGLMaterial;
+        material->setObjectName(QString::fromUtf8(strings + entry.name));
+        material->setAmbientColor(loadColor(entry.ambientColor));
+        material->setDiffuseColor(loadColor(entry.diffuseColor));
+        material->setSpecularColor(loadColor(entry.specularColor));
+        material->setEmittedLight(loadColor(entry.emittedLight));
+        material->setShininess(entry.shininess);
+        if (entry.textureUrl != 0) {
+            QUrl texture(QString::fromUtf8(strings + entry.textureUrl));
+            material->setTextureUrl(url.resolved(texture));
+        }
+        palette->addMaterial(material);
+    }
+
+    // Nodes, the parents are always stored before their children.
+    QVector<QGLSceneNode *> nodes(header.nodeCount);
+    for (quint32 index = 0; index < header.nodeCount; ++index) {
+        QGLMeshFileNode entry;
+        memcpy(&entry, data + header.nodeOffset +
+               index * sizeof(QGLMeshFileNode), sizeof(entry));
+        bool valid = entry.name < header.stringsSize &&
+                entry.geometry < qint32(header.geometryCount) &&
+                entry.materialIndex < qint32(header.materialCount) &&
+                entry.backMaterialIndex < qint32(header.materialCount);
+        if (index == 0)
+            valid = valid && entry.parent == -1;
+        else
+            valid = valid && entry.parent >= 0 && entry.parent < qint32(index);
+        // The draw range must lie within the indices of the geometry.
+        if (entry.geometry >= 0) {
+            valid = valid && quint64(entry.start) + entry.count <=
+                    quint64(geometries.at(entry.geometry).indexCount());
+        }
+        if (!valid) {
+            delete nodes[0];
+            delete palette;
+            return false;
+        }
+
+        QGLSceneNode *node = new QGLSceneNode(index ? nodes[entry.parent] : 0);
+        node->setObjectName(QString::fromUtf8(strings + entry.name));
+        node->setPalette(palette);
+        if (entry.geometry >= 0)
+            node->setGeometry(geometries.at(entry.geometry));
+        node->setStart(entry.start);
+        node->setCount(entry.count);
+        node->setMaterialIndex(entry.materialIndex);
+        node->setBackMaterialIndex(entry.backMaterialIndex);
+        node->setDrawingMode(QGL::DrawingMode(entry.drawingMode));
+        node->setOptions(QGLSceneNode::Options(entry.options));
+        node->setPosition(QVector3D(entry.position[0], entry.position[1],
+                                    entry.position[2]));
+
+        QMatrix4x4 transform;
+        qreal *values = transform.data();
+        for (int i = 0; i < 16; ++i)
+            values[i] = entry.transform[i];
+        transform.optimize();
+        node->setLocalTransform(transform);
+
+        nodes[index] = node;
+    }
+
+    mainObject = nodes[0];
+    mainObject->setParent(this);
+    palette->setParent(mainObject);
+    return true;
+}
+
+QT_END_NAMESPACE
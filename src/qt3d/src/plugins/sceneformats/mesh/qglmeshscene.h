@@ -0,0 +1,77 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGLMESHSCENE_H
+#define QGLMESHSCENE_H
+
+#include "qglabstractscene.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qurl.h>
+
+QT_BEGIN_NAMESPACE
+
+class QFile;
+class QIODevice;
+
+class QGLMeshScene : public QGLAbstractScene
+{
+    Q_OBJECT
+public:
+    explicit QGLMeshScene(QObject *parent = 0);
+    virtual ~QGLMeshScene();
+
+    bool load(QIODevice *device, const QUrl &url);
+
+    QList<QObject *> objects() const;
+    QGLSceneNode *mainNode() const;
+
+private:
+    const uchar *mapData(QIODevice *device, qint64 *size);
+
+    QGLSceneNode *mainObject;
+    QFile *mappedFile;
+    QByteArray fileData;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,338 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qglmeshwriter.h"
+#include "qglmeshformat_p.h"
+#include "qglscenenode.h"
+#include "qglmaterial.h"
+#include "qglmaterialcollection.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qdebug.h>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QGLMeshWriter
+    \internal
+    \brief The QGLMeshWriter class writes scene graphs in the .qmesh format.
+
+    The writer is used by the mesh exporter to convert the scenes that
+    can be loaded with QGLAbstractScene::loadScene() into files that the
+    mesh scene format plugin loads without a parse step.  Node names,
+    transforms, draw ranges, materials and the position, normal, color
+    and texture coordinate fields of the geometry are stored.  Custom
+    vertex attributes and graphics transforms are not supported.
+*/
+
+namespace {
+
+class MeshStrings
+{
+public:
+    MeshStrings() : m_data(1, '\0') {}
+
+    quint32 add(const QString &string)
+    {
+        if (string.isEmpty())
+            return 0;
+        QByteArray utf8 = string.toUtf8();
+        QHash<QByteArray, quint32>::const_iterator it = m_offsets.constFind(utf8);
+        if (it != m_offsets.constEnd())
+            return it.value();
+        quint32 offset = m_data.size();
+        m_data.append(utf8);
+        m_data.append('\0');
+        m_offsets.insert(utf8, offset);
+        return offset;
+    }
+
+    QByteArray data() const { return m_data; }
+
+private:
+    QByteArray m_data;
+    QHash<QByteArray, quint32> m_offsets;
+};
+
+}
+
+static int alignedSize(int size)
+{
+    return (size + QGL_MESH_FILE_ALIGNMENT - 1) &
+            ~(QGL_MESH_FILE_ALIGNMENT - 1);
+}
+
+static void alignData(QByteArray *data)
+{
+    data->append(QByteArray(alignedSize(data->size()) - data->size(), '\0'));
+}
+
+static void appendFloat(QByteArray *data, float value)
+{
+    data->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void storeColor(float *out, const QColor &color)
+{
+    qreal r, g, b, a;
+    color.getRgbF(&r, &g, &b, &a);
+    out[0] = r;
+    out[1] = g;
+    out[2] = b;
+    out[3] = a;
+}
+
+/*!
+    Returns \a root and its children serialized in the .qmesh format.
+    Local texture files below the directory of \a baseUrl are stored
+    relative to it, so that the mesh can be shipped next to them.
+*/
+QByteArray QGLMeshWriter::write(QGLSceneNode *root, const QUrl &baseUrl)
+{
+    MeshStrings strings;
+
+    // Flatten the tree parents first.
+    QList<QGLSceneNode *> nodes;
+    QList<int> parents;
+    nodes.append(root);
+    parents.append(-1);
+    for (int index = 0; index < nodes.size(); ++index) {
+        QList<QGLSceneNode *> children = nodes.at(index)->children();
+        for (int child = 0; child < children.size(); ++child) {
+            nodes.append(children.at(child));
+            parents.append(index);
+        }
+    }
+
+    QDir baseDir;
+    bool relativeTextures = baseUrl.scheme() == QLatin1String("file");
+    if (relativeTextures)
+        baseDir = QFileInfo(baseUrl.toLocalFile()).absoluteDir();
+
+    QVector<QGLMeshFileNode> nodeTable;
+    QVector<QGLMeshFileMaterial> materialTable;
+    QVector<QGeometryData> geometries;
+    QHash<quint64, int> geometryIndices;
+    QHash<QGLMaterial *, int> materialIndices;
+
+    for (int index = 0; index < nodes.size(); ++index) {
+        QGLSceneNode *node = nodes.at(index);
+        QGLMeshFileNode entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.parent = parents.at(index);
+        entry.name = strings.add(node->objectName());
+        entry.start = node->start();
+        entry.count = node->count();
+        entry.drawingMode = node->drawingMode();
+        entry.options = node->options();
+        if (!node->transforms().isEmpty())
+            qWarning() << "QGLMeshWriter: the transforms of" << node
+                       << "are not stored";
+
+        QVector3D position = node->position();
+        entry.position[0] = position.x();
+        entry.position[1] = position.y();
+        entry.position[2] = position.z();
+        const qreal *transform = node->localTransform().constData();
+        for (int i = 0; i < 16; ++i)
+            entry.transform[i] = transform[i];
+
+        entry.geometry = -1;
+        QGeometryData geometry = node->geometry();
+        if (geometry.count() > 0) {
+            if (!geometryIndices.contains(geometry.id())) {
+                geometryIndices.insert(geometry.id(), geometries.size());
+                geometries.append(geometry);
+            }
+            entry.geometry = geometryIndices.value(geometry.id());
+        }
+
+        QGLMaterial *materials[2] = { 0, 0 };
+        if (node->palette()) {
+            materials[0] = node->palette()->material(node->materialIndex());
+            materials[1] = node->palette()->material(node->backMaterialIndex());
+        }
+        qint32 *materialEntries[2] = {
+            &entry.materialIndex, &entry.backMaterialIndex
+        };
+        for (int side = 0; side < 2; ++side) {
+            QGLMaterial *material = materials[side];
+            *materialEntries[side] = -1;
+            if (!material)
+                continue;
+            if (!materialIndices.contains(material)) {
+                QGLMeshFileMaterial materialEntry;
+                memset(&materialEntry, 0, sizeof(materialEntry));
+                materialEntry.name = strings.add(material->objectName());
+                QUrl url = material->textureUrl();
+                QString texture = url.toString();
+                if (relativeTextures && url.scheme() == QLatin1String("file")) {
+                    QString path = baseDir.relativeFilePath(url.toLocalFile());
+                    if (!path.startsWith(QLatin1String("..")))
+                        texture = path;
+                }
+                materialEntry.textureUrl = strings.add(texture);
+                storeColor(materialEntry.ambientColor, material->ambientColor());
+                storeColor(materialEntry.diffuseColor, material->diffuseColor());
+                storeColor(materialEntry.specularColor, material->specularColor());
+                storeColor(materialEntry.emittedLight, material->emittedLight());
+                materialEntry.shininess = material->shininess();
+                materialIndices.insert(material, materialTable.size());
+                materialTable.append(materialEntry);
+            }
+            *materialEntries[side] = materialIndices.value(material);
+        }
+
+        nodeTable.append(entry);
+    }
+
+    // Lay out the tables, then the blobs behind them.
+    QGLMeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, QGL_MESH_FILE_MAGIC, 4);
+    header.version = QGL_MESH_FILE_VERSION;
+    header.byteOrder = QGL_MESH_FILE_BYTE_ORDER;
+    header.nodeCount = nodeTable.size();
+    header.nodeOffset = alignedSize(sizeof(QGLMeshFileHeader));
+    header.materialCount = materialTable.size();
+    header.materialOffset = header.nodeOffset +
+            alignedSize(nodeTable.size() * sizeof(QGLMeshFileNode));
+    header.geometryCount = geometries.size();
+    header.geometryOffset = header.materialOffset +
+            alignedSize(materialTable.size() * sizeof(QGLMeshFileMaterial));
+    QByteArray stringData = strings.data();
+    header.stringsSize = stringData.size();
+    header.stringsOffset = header.geometryOffset +
+            alignedSize(geometries.size() * sizeof(QGLMeshFileGeometry));
+    const quint32 blobOffset = header.stringsOffset +
+            alignedSize(stringData.size());
+
+    QByteArray blobs;
+    QVector<QGLMeshFileGeometry> geometryTable;
+    for (int index = 0; index < geometries.size(); ++index) {
+        const QGeometryData &geometry = geometries.at(index);
+        QGLMeshFileGeometry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.vertexCount = geometry.count();
+        entry.bufferStrategy = geometry.bufferStrategy();
+
+        for (int field = 0; field < QGL_MESH_FILE_STREAMS; ++field) {
+            QGL::VertexAttribute attribute = QGL::VertexAttribute(field);
+            if (!geometry.hasField(attribute))
+                continue;
+            entry.fields |= QGL::fieldMask(attribute);
+            entry.streamOffsets[field] = blobOffset + blobs.size();
+            if (attribute == QGL::Position || attribute == QGL::Normal) {
+                QVector3DArray values = attribute == QGL::Position ?
+                            geometry.vertices() : geometry.normals();
+                for (int i = 0; i < values.size(); ++i) {
+                    appendFloat(&blobs, values.at(i).x());
+                    appendFloat(&blobs, values.at(i).y());
+                    appendFloat(&blobs, values.at(i).z());
+                }
+            } else if (attribute == QGL::Color) {
+                QArray<QColor4ub> values = geometry.colors();
+                for (int i = 0; i < values.size(); ++i) {
+                    blobs.append(char(values.at(i).red()));
+                    blobs.append(char(values.at(i).green()));
+                    blobs.append(char(values.at(i).blue()));
+                    blobs.append(char(values.at(i).alpha()));
+                }
+            } else {
+                QVector2DArray values = geometry.texCoords(attribute);
+                for (int i = 0; i < values.size(); ++i) {
+                    appendFloat(&blobs, values.at(i).x());
+                    appendFloat(&blobs, values.at(i).y());
+                }
+            }
+            alignData(&blobs);
+        }
+        if (geometry.fields() & ~((1 << QGL_MESH_FILE_STREAMS) - 1))
+            qWarning("QGLMeshWriter: custom vertex attributes are not stored");
+
+        QGL::IndexArray indices = geometry.indices();
+        uint maxIndex = 0;
+        for (int i = 0; i < indices.size(); ++i)
+            maxIndex = qMax(maxIndex, uint(indices.at(i)));
+        entry.indexCount = indices.size();
+        entry.indexSize = maxIndex > 0xffff ? 4 : 2;
+        entry.indexOffset = blobOffset + blobs.size();
+        for (int i = 0; i < indices.size(); ++i) {
+            if (entry.indexSize == 2) {
+                quint16 value = indices.at(i);
+                blobs.append(reinterpret_cast<const char *>(&value), 2);
+            } else {
+                quint32 value = indices.at(i);
+                blobs.append(reinterpret_cast<const char *>(&value), 4);
+            }
+        }
+        alignData(&blobs);
+
+        geometryTable.append(entry);
+    }
+    header.fileSize = blobOffset + blobs.size();
+
+    QByteArray data;
+    data.reserve(header.fileSize);
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    alignData(&data);
+    data.append(reinterpret_cast<const char *>(nodeTable.constData()),
+                nodeTable.size() * sizeof(QGLMeshFileNode));
+    alignData(&data);
+    data.append(reinterpret_cast<const char *>(materialTable.constData()),
+                materialTable.size() * sizeof(QGLMeshFileMaterial));
+    alignData(&data);
+    data.append(reinterpret_cast<const char *>(geometryTable.constData()),
+                geometryTable.size() * sizeof(QGLMeshFileGeometry));
+    alignData(&data);
+    data.append(stringData);
+    alignData(&data);
+    data.append(blobs);
+    Q_ASSERT(data.size() == int(header.fileSize));
+    return data;
+}
+
+QT_END_NAMESPACE
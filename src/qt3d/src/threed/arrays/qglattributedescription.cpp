@@ -127,7 +127,9 @@ QT_BEGIN_NAMESPACE
 */
 
 /*!
-    Returns the size in bytes of type().
+    Returns the size in bytes of type().  The half-float types
+    GL_HALF_FLOAT and GL_HALF_FLOAT_OES used by compact vertex
+    formats are 2 bytes in size.
 
     \sa type(), tupleSize()
 */
@@ -141,6 +143,8 @@ int QGLAttributeDescription::sizeOfType() const
     case GL_INT:            return int(sizeof(GLint));
     case GL_UNSIGNED_INT:   return int(sizeof(GLuint));
     case GL_FLOAT:          return int(sizeof(GLfloat));
+    case GL_HALF_FLOAT:     return int(sizeof(GLushort));
+    case GL_HALF_FLOAT_OES: return int(sizeof(GLushort));
 #if defined(GL_DOUBLE) && !defined(QT_OPENGL_ES)
     case GL_DOUBLE:         return int(sizeof(GLdouble));
 #endif
@@ -52,6 +52,13 @@ QT_BEGIN_NAMESPACE
 
 QT_MODULE(Qt3D)
 
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+
 class Q_QT3D_EXPORT QGLAttributeDescription
 {
 public:
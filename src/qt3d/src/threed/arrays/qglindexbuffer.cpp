@@ -43,6 +43,7 @@
 #include "qglpainter.h"
 #include "qglpainter_p.h"
 #include "qglext_p.h"
+#include "qglvertexbundle_p.h"
 #include <QtOpenGL/qgl.h>
 #include <QtCore/qatomic.h>
 
@@ -229,6 +230,7 @@ void QGLIndexBuffer::setIndexes(const QArray<ushort>& values)
         d->buffer.bind();
         d->buffer.allocate(values.constData(), values.size() * sizeof(ushort));
         d->buffer.release();
+        QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
         // The element type may have changed from int to ushort.
         d->elementType = GL_UNSIGNED_SHORT;
     } else {
@@ -262,6 +264,7 @@ void QGLIndexBuffer::setIndexes(const QArray<uint>& values)
             d->buffer.bind();
             d->buffer.allocate(values.constData(), values.size() * sizeof(int));
             d->buffer.release();
+            QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
             // The element type may have changed from ushort to int.
             d->elementType = GL_UNSIGNED_INT;
         } else {
@@ -269,6 +272,7 @@ void QGLIndexBuffer::setIndexes(const QArray<uint>& values)
             d->buffer.bind();
             d->buffer.allocate(svalues.constData(), svalues.size() * sizeof(ushort));
             d->buffer.release();
+            QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
         }
     } else if (d->hasIntBuffers) {
         d->indexesInt = values;
@@ -309,6 +313,7 @@ void QGLIndexBuffer::replaceIndexes(int index, const QArray<ushort>& values)
         d->buffer.write(index * sizeof(ushort),
                         values.constData(), values.size() * sizeof(ushort));
         d->buffer.release();
+        QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
     } else {
         d->indexesShort.replace(index, values.constData(), values.size());
         d->indexCount = d->indexesShort.size();
@@ -348,6 +353,7 @@ void QGLIndexBuffer::replaceIndexes(int index, const QArray<uint>& values)
             d->buffer.write(index * sizeof(int),
                             values.constData(), values.size() * sizeof(int));
             d->buffer.release();
+            QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
         } else {
             QArray<ushort> svalues = qt_qarray_uint_to_ushort(values);
             d->buffer.bind();
@@ -355,6 +361,7 @@ void QGLIndexBuffer::replaceIndexes(int index, const QArray<uint>& values)
                             svalues.constData(),
                             svalues.size() * sizeof(ushort));
             d->buffer.release();
+            QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
         }
     } else if (d->elementType == GL_UNSIGNED_INT) {
         d->indexesInt.replace(index, values.constData(), values.size());
@@ -425,6 +432,7 @@ bool QGLIndexBuffer::upload()
         d->indexesInt = QArray<uint>();
     }
     d->buffer.release();
+    QGLPainterPrivate::indexBufferReleased(QGLContext::currentContext());
     return true;
 }
 
@@ -718,6 +726,8 @@ void QGLPainter::draw(QGL::DrawingMode mode, const QGLIndexBuffer& indexes)
         else
             QGLBuffer::release(QGLBuffer::IndexBuffer);
         d_ptr->boundIndexBuffer = id;
+        if (d_ptr->vertexArray)
+            d_ptr->vertexArray->indexBuffer = id;
     }
     if (id) {
         glDrawElements(GLenum(mode), d->indexCount, d->elementType, 0);
@@ -756,6 +766,8 @@ void QGLPainter::draw(QGL::DrawingMode mode, const QGLIndexBuffer& indexes, int
         else
             QGLBuffer::release(QGLBuffer::IndexBuffer);
         d_ptr->boundIndexBuffer = id;
+        if (d_ptr->vertexArray)
+            d_ptr->vertexArray->indexBuffer = id;
     }
     if (id) {
         if (d->elementType == GL_UNSIGNED_SHORT) {
@@ -42,8 +42,11 @@
 #include "qglvertexbundle.h"
 #include "qglvertexbundle_p.h"
 #include "qglabstracteffect.h"
+#include "qglext_p.h"
+#include "qglpainter_p.h"
 #include <QtCore/qlist.h>
 #include <QtCore/qatomic.h>
+#include <QtCore/qbytearray.h>
 #include <QtOpenGL/qglshaderprogram.h>
 
 QT_BEGIN_NAMESPACE
@@ -63,6 +66,40 @@ QT_BEGIN_NAMESPACE
 
     For general-purpose vertex buffers that can be allocated and modified
     in-place, use QGLBuffer instead.
+
+    If the contents will change after upload, set a usage pattern other
+    than QGLBuffer::StaticDraw with setUsagePattern() before calling
+    upload().  The attributes are then stored one after the other rather
+    than interleaved, so that replaceAttribute() can update a range of
+    vertices with a single write.  Data that changes on every frame
+    should use QGLBuffer::StreamDraw and call orphan() before rewriting
+    the attributes, which lets the GL server hand out fresh storage
+    instead of waiting for pending draws on the old contents.
+
+    Static geometry can be stored in less GPU memory by setting
+    setVertexFormat() to CompactFormat before calling upload().
+    The attributes are then quantized into smaller types as they are
+    interleaved; for example positions become half floats and normals
+    become normalized signed bytes, so that a vertex with a position,
+    normal, and texture co-ordinate occupies 16 bytes instead of 32.
+*/
+
+/*!
+    \enum QGLVertexBundle::VertexFormat
+    This enum defines how upload() stores the attributes of a
+    vertex bundle in the GL server.
+
+    \value FullPrecisionFormat The attributes are stored with the
+        type that they were supplied with.  This is the default.
+    \value CompactFormat The attributes are quantized into smaller
+        types where the GL server supports it: positions become half
+        floats, normals become normalized signed bytes, and texture
+        co-ordinates in the range 0 to 1 become normalized unsigned
+        shorts, falling back to half floats for other ranges.  Each
+        attribute is padded to a multiple of 4 bytes.  Other attributes
+        are stored unchanged.  The compact format requires shader
+        programs and is only used with the QGLBuffer::StaticDraw
+        usage pattern.
 */
 
 /*!
@@ -217,6 +254,16 @@ void QGLVertexBundle::addAttribute
     }
 }
 
+QGLVertexBundlePrivate::~QGLVertexBundlePrivate()
+{
+    // Each painter removes the object from this list as it goes.
+    while (!vertexArrays.isEmpty()) {
+        QGLVertexBundleVertexArray *vao = vertexArrays.last();
+        vao->painter->removeVertexArray(vao);
+    }
+    qDeleteAll(attributes);
+}
+
 // Interleave a source array into a destination array.
 static void vertexBufferInterleave
     (float *dst, int dstStride, const float *src, int srcStride, int count)
@@ -319,6 +366,198 @@ int QGLVertexBundle::vertexCount() const
     Returns true if vertexCount() is zero; false otherwise.
 */
 
+/*!
+    Returns the usage pattern for this vertex bundle.
+    The default value is QGLBuffer::StaticDraw.
+
+    \sa setUsagePattern()
+*/
+QGLBuffer::UsagePattern QGLVertexBundle::usagePattern() const
+{
+    Q_D(const QGLVertexBundle);
+    return d->buffer.usagePattern();
+}
+
+/*!
+    Sets the usage pattern for this vertex bundle to \a value.
+    This function must be called before upload() for the \a value
+    to take effect.
+
+    Any usage pattern other than QGLBuffer::StaticDraw causes upload()
+    to lay out the attributes in separate contiguous blocks so that
+    they can be efficiently modified with replaceAttribute().
+
+    \sa usagePattern(), upload(), replaceAttribute()
+*/
+void QGLVertexBundle::setUsagePattern(QGLBuffer::UsagePattern value)
+{
+    Q_D(QGLVertexBundle);
+    d->buffer.setUsagePattern(value);
+}
+
+/*!
+    Returns the format that upload() will use to store the attributes.
+    The default value is FullPrecisionFormat.
+
+    \sa setVertexFormat()
+*/
+QGLVertexBundle::VertexFormat QGLVertexBundle::vertexFormat() const
+{
+    Q_D(const QGLVertexBundle);
+    return d->vertexFormat;
+}
+
+/*!
+    Sets the \a format that upload() will use to store the attributes.
+    This function must be called before upload() for the \a format
+    to take effect.
+
+    Values that are quantized by CompactFormat cannot be replaced with
+    replaceAttribute(), because the supplied values are not converted.
+
+    \sa vertexFormat(), upload()
+*/
+void QGLVertexBundle::setVertexFormat(VertexFormat format)
+{
+    Q_D(QGLVertexBundle);
+    d->vertexFormat = format;
+}
+
+// Returns the half-float vertex attribute type supported by the
+// current context, or zero if half-float attributes are not supported.
+static GLenum qt_gl_halfFloatVertexType()
+{
+    const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    QGLExtensionChecker checker(extensions ? extensions : "");
+#if defined(QT_OPENGL_ES)
+    if (checker.match("GL_OES_vertex_half_float"))
+        return GL_HALF_FLOAT_OES;
+#else
+    if (checker.match("GL_ARB_half_float_vertex") ||
+            (QGLFormat::openGLVersionFlags() & QGLFormat::OpenGL_Version_3_0) != 0)
+        return GL_HALF_FLOAT;
+#endif
+    return 0;
+}
+
+// Converts a single-precision value into a half-precision value,
+// rounding to nearest.
+static quint16 qt_gl_floatToHalf(float value)
+{
+    union { float f; quint32 i; } u;
+    u.f = value;
+    quint32 sign = (u.i >> 16) & 0x8000;
+    int exponent = int((u.i >> 23) & 0xff) - 127 + 15;
+    quint32 mantissa = u.i & 0x007fffff;
+    if (exponent <= 0) {
+        // Denormalized half, or zero if too small.
+        if (exponent < -10)
+            return quint16(sign);
+        mantissa |= 0x00800000;
+        int shift = 14 - exponent;
+        quint32 half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+            ++half;
+        return quint16(sign | half);
+    } else if (exponent >= 0x1f) {
+        // Overflow to infinity, keeping NaN as NaN.
+        if (((u.i >> 23) & 0xff) == 0xff && mantissa)
+            return quint16(sign | 0x7e00);
+        return quint16(sign | 0x7c00);
+    }
+    quint32 half = sign | (quint32(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+        ++half;     // A carry into the exponent is still correct.
+    return quint16(half);
+}
+
+// Determines the quantized type and tuple size of an attribute
+// for QGLVertexBundle::CompactFormat.
+static QGLAttributeDescription compactDescription
+    (QGLVertexBundleAttribute *attr, GLenum halfType)
+{
+    const QGLAttributeValue &value = attr->value;
+    QGLAttributeDescription desc(attr->attribute, value.tupleSize(),
+                                 value.type(), 0);
+    if (value.type() != GL_FLOAT)
+        return desc;
+    if (attr->attribute == QGL::Position) {
+        if (halfType)
+            desc.setType(halfType);
+    } else if (attr->attribute == QGL::Normal && value.tupleSize() == 3) {
+        desc.setType(GL_BYTE);
+    } else if (attr->attribute >= QGL::TextureCoord0 &&
+               attr->attribute <= QGL::TextureCoord2) {
+        const float *src = reinterpret_cast<const float *>(value.data());
+        int size = attr->count() * value.tupleSize();
+        bool normalized = true;
+        for (int index = 0; index < size && normalized; ++index)
+            normalized = (src[index] >= 0.0f && src[index] <= 1.0f);
+        if (normalized)
+            desc.setType(GL_UNSIGNED_SHORT);
+        else if (halfType)
+            desc.setType(halfType);
+    }
+    return desc;
+}
+
+// Returns the number of bytes that an attribute occupies within
+// a compact vertex, padded to keep every attribute 4-byte aligned.
+static inline int compactSlotSize(const QGLAttributeDescription &desc)
+{
+    return (desc.tupleSize() * desc.sizeOfType() + 3) & ~3;
+}
+
+// Quantizes an attribute into the compact interleaved buffer at dst.
+static void compactInterleave
+    (char *dst, int dstStride, QGLVertexBundleAttribute *attr,
+     const QGLAttributeDescription &desc)
+{
+    int count = attr->count();
+    int tupleSize = desc.tupleSize();
+    if (desc.type() == attr->value.type()) {
+        const char *src = reinterpret_cast<const char *>(attr->value.data());
+        int elemSize = attr->elementSize();
+        while (count-- > 0) {
+            memcpy(dst, src, elemSize);
+            src += elemSize;
+            dst += dstStride;
+        }
+        return;
+    }
+    const float *src = reinterpret_cast<const float *>(attr->value.data());
+    switch (desc.type()) {
+    case GL_BYTE:
+        while (count-- > 0) {
+            GLbyte *out = reinterpret_cast<GLbyte *>(dst);
+            for (int component = 0; component < tupleSize; ++component)
+                out[component] = GLbyte(qRound(qBound(-1.0f, src[component], 1.0f) * 127.0f));
+            src += tupleSize;
+            dst += dstStride;
+        }
+        break;
+    case GL_UNSIGNED_SHORT:
+        while (count-- > 0) {
+            GLushort *out = reinterpret_cast<GLushort *>(dst);
+            for (int component = 0; component < tupleSize; ++component)
+                out[component] = GLushort(qRound(src[component] * 65535.0f));
+            src += tupleSize;
+            dst += dstStride;
+        }
+        break;
+    default:
+        // Half floats.
+        while (count-- > 0) {
+            quint16 *out = reinterpret_cast<quint16 *>(dst);
+            for (int component = 0; component < tupleSize; ++component)
+                out[component] = qt_gl_floatToHalf(src[component]);
+            src += tupleSize;
+            dst += dstStride;
+        }
+        break;
+    }
+}
+
 /*!
     Uploads the vertex data specified by previous addAttribute()
     calls into the GL server as a vertex buffer object.
@@ -351,17 +590,86 @@ bool QGLVertexBundle::upload()
         return false;
     d->buffer.bind();
 
+    // Quantize the attributes into a compact interleaved layout if
+    // requested and the values will not be replaced later.
+    if (d->vertexFormat == CompactFormat &&
+            d->buffer.usagePattern() == QGLBuffer::StaticDraw &&
+            QGLShaderProgram::hasOpenGLShaderPrograms()) {
+        GLenum halfType = qt_gl_halfFloatVertexType();
+        QList<QGLAttributeDescription> layout;
+        int stride = 0;
+        int maxCount = 0;
+        for (int index = 0; index < d->attributes.size(); ++index) {
+            attr = d->attributes[index];
+            QGLAttributeDescription desc = compactDescription(attr, halfType);
+            layout.append(desc);
+            stride += compactSlotSize(desc);
+            maxCount = qMax(maxCount, attr->count());
+        }
+        d->bufferSize = stride * maxCount;
+        QByteArray data(d->bufferSize, '\0');
+        int offset = 0;
+        for (int index = 0; index < d->attributes.size(); ++index) {
+            attr = d->attributes[index];
+            const QGLAttributeDescription &desc = layout.at(index);
+            compactInterleave(data.data() + offset, stride, attr, desc);
+            attr->bufferOffset = offset;
+            attr->bufferStride = stride;
+            attr->bufferElementSize = desc.tupleSize() * desc.sizeOfType();
+            attr->bufferCount = attr->count();
+            attr->value = QGLAttributeValue(desc.tupleSize(), desc.type(),
+                                            stride, offset, attr->count());
+            offset += compactSlotSize(desc);
+            attr->clear();
+        }
+        d->buffer.allocate(data.constData(), d->bufferSize);
+        d->buffer.release();
+        return true;
+    }
+
     // If there is only one attribute, then realloc and write in one step.
     if (d->attributes.size() == 1) {
         attr = d->attributes[0];
-        d->buffer.allocate(attr->value.data(),
-                           attr->count() * attr->elementSize());
+        d->bufferSize = attr->count() * attr->elementSize();
+        d->buffer.allocate(attr->value.data(), d->bufferSize);
         attr->value.setOffset(0);
+        attr->bufferOffset = 0;
+        attr->bufferStride = attr->elementSize();
+        attr->bufferElementSize = attr->elementSize();
+        attr->bufferCount = attr->count();
         attr->clear();
         d->buffer.release();
         return true;
     }
 
+    // If the contents will be modified later, then keep each attribute
+    // in its own contiguous block so replaceAttribute() can write a range
+    // of vertices in one step instead of one vertex at a time.
+    if (d->buffer.usagePattern() != QGLBuffer::StaticDraw) {
+        d->bufferSize = 0;
+        for (int index = 0; index < d->attributes.size(); ++index) {
+            attr = d->attributes[index];
+            d->bufferSize += attr->count() * attr->elementSize();
+        }
+        d->buffer.allocate(d->bufferSize);
+        int offset = 0;
+        for (int index = 0; index < d->attributes.size(); ++index) {
+            attr = d->attributes[index];
+            int size = attr->count() * attr->elementSize();
+            if (size > 0)
+                d->buffer.write(offset, attr->value.data(), size);
+            attr->value.setOffset(offset);
+            attr->bufferOffset = offset;
+            attr->bufferStride = attr->elementSize();
+            attr->bufferElementSize = attr->elementSize();
+            attr->bufferCount = attr->count();
+            offset += size;
+            attr->clear();
+        }
+        d->buffer.release();
+        return true;
+    }
+
     // Calculate the total size of the VBO that we will need,
     // the maximum number of interleaved vertices, and the
     // interleaved stride.
@@ -378,6 +686,7 @@ bool QGLVertexBundle::upload()
         stride += elemSize;
     }
     int bufferSize = size;
+    d->bufferSize = bufferSize;
     d->buffer.allocate(bufferSize);
     stride /= sizeof(float);
 
@@ -425,6 +734,10 @@ bool QGLVertexBundle::upload()
         attr = d->attributes[index];
         attr->value.setOffset(offset);
         attr->value.setStride(stride * sizeof(float));
+        attr->bufferOffset = offset;
+        attr->bufferStride = stride * sizeof(float);
+        attr->bufferElementSize = attr->elementSize();
+        attr->bufferCount = attr->count();
         offset += attr->elementSize();
         attr->clear();
     }
@@ -448,6 +761,76 @@ bool QGLVertexBundle::isUploaded() const
     return d->buffer.isCreated();
 }
 
+/*!
+    Replaces the elements of \a attribute in this vertex bundle, starting
+    at vertex \a index, with the contents of \a value.  All other
+    elements keep their current values.  Returns false if the bundle
+    has not been uploaded, \a attribute is not present in the bundle,
+    or the element size of \a value does not match the attribute.
+
+    This function must be called with a current GL context that is
+    compatible with the uploaded buffer.  If the usagePattern() is
+    QGLBuffer::StaticDraw then the attributes are interleaved and each
+    element is written separately; other usage patterns allow the whole
+    range to be written at once.
+
+    \sa upload(), setUsagePattern(), orphan()
+*/
+bool QGLVertexBundle::replaceAttribute
+    (QGL::VertexAttribute attribute, int index, const QGLAttributeValue& value)
+{
+    Q_D(QGLVertexBundle);
+    if (!d->buffer.isCreated() || value.isNull() || index < 0)
+        return false;
+    QGLVertexBundleAttribute *attr = d->findAttribute(attribute);
+    if (!attr)
+        return false;
+    int elemSize = attr->bufferElementSize;
+    if (value.tupleSize() * value.sizeOfType() != elemSize)
+        return false;
+    int count = qMin(value.count(), attr->bufferCount - index);
+    if (count <= 0)
+        return true;
+    int srcStride = value.stride() ? value.stride() : elemSize;
+    const char *src = reinterpret_cast<const char *>(value.data());
+    d->buffer.bind();
+    if (attr->bufferStride == elemSize && srcStride == elemSize) {
+        d->buffer.write(attr->bufferOffset + index * elemSize,
+                        src, count * elemSize);
+    } else {
+        int offset = attr->bufferOffset + index * attr->bufferStride;
+        while (count-- > 0) {
+            d->buffer.write(offset, src, elemSize);
+            offset += attr->bufferStride;
+            src += srcStride;
+        }
+    }
+    d->buffer.release();
+    return true;
+}
+
+/*!
+    Discards the current contents of the uploaded buffer while keeping
+    its size and attribute layout, so that the GL server can allocate
+    fresh storage rather than synchronizing with draws that are still
+    using the old contents.  Every attribute must be rewritten with
+    replaceAttribute() before the bundle is drawn again.
+
+    This is intended for bundles with a QGLBuffer::StreamDraw usage
+    pattern whose contents change on every frame.
+
+    \sa replaceAttribute(), setUsagePattern()
+*/
+void QGLVertexBundle::orphan()
+{
+    Q_D(QGLVertexBundle);
+    if (!d->buffer.isCreated())
+        return;
+    d->buffer.bind();
+    d->buffer.allocate(d->bufferSize);
+    d->buffer.release();
+}
+
 /*!
     Returns the QGLBuffer in use by this vertex bundle object,
     so that its properties or contents can be modified directly.
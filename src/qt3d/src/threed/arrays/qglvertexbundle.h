@@ -68,6 +68,12 @@ public:
 
     QGLVertexBundle& operator=(const QGLVertexBundle& other);
 
+    enum VertexFormat
+    {
+        FullPrecisionFormat,
+        CompactFormat
+    };
+
     void addAttribute(QGL::VertexAttribute attribute,
                       const QArray<float>& value);
     void addAttribute(QGL::VertexAttribute attribute,
@@ -88,9 +94,19 @@ public:
     int vertexCount() const;
     bool isEmpty() const { return vertexCount() == 0; }
 
+    QGLBuffer::UsagePattern usagePattern() const;
+    void setUsagePattern(QGLBuffer::UsagePattern value);
+
+    VertexFormat vertexFormat() const;
+    void setVertexFormat(VertexFormat format);
+
     bool upload();
     bool isUploaded() const;
 
+    bool replaceAttribute(QGL::VertexAttribute attribute, int index,
+                          const QGLAttributeValue& value);
+    void orphan();
+
     QGLBuffer buffer() const;
 
     bool bind();
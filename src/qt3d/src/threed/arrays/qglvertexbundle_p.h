@@ -62,7 +62,9 @@ QT_BEGIN_NAMESPACE
 class QGLVertexBundleAttribute
 {
 public:
-    QGLVertexBundleAttribute(QGL::VertexAttribute attr) : attribute(attr) {}
+    QGLVertexBundleAttribute(QGL::VertexAttribute attr)
+        : attribute(attr), bufferOffset(0), bufferStride(0)
+        , bufferElementSize(0), bufferCount(0) {}
     virtual ~QGLVertexBundleAttribute() {}
 
     virtual void clear() = 0;
@@ -72,6 +74,12 @@ public:
 
     QGL::VertexAttribute attribute;
     QGLAttributeValue value;
+
+    // Location of the attribute within the uploaded buffer.
+    int bufferOffset;
+    int bufferStride;
+    int bufferElementSize;
+    int bufferCount;
 };
 
 class QGLVertexBundleFloatAttribute : public QGLVertexBundleAttribute
@@ -188,25 +196,70 @@ public:
     QCustomDataArray customArray;
 };
 
+class QGLPainterPrivate;
+class QGLVertexBundlePrivate;
+
+// Vertex array object that captures the attribute bindings of an
+// uploaded vertex bundle, created on first use by
+// QGLPainter::setVertexBundle().  Vertex array objects are not shared
+// between contexts, so there is one for each context that the bundle
+// is drawn in.  The element array binding is part of the object's
+// state, so the index buffer that was last bound with it is
+// remembered as well.
+class QGLVertexBundleVertexArray
+{
+public:
+    QGLVertexBundleVertexArray(QGLVertexBundlePrivate *b,
+                               QGLPainterPrivate *p, GLuint i)
+        : bundle(b), painter(p), id(i), indexBuffer(0) {}
+
+    QGLVertexBundlePrivate *bundle;
+    QGLPainterPrivate *painter;
+    GLuint id;
+    GLuint indexBuffer;
+};
+
 class QGLVertexBundlePrivate
 {
 public:
     QGLVertexBundlePrivate()
         : buffer(QGLBuffer::VertexBuffer),
-          vertexCount(0)
+          vertexCount(0),
+          bufferSize(0),
+          vertexFormat(QGLVertexBundle::FullPrecisionFormat)
     {
         ref = 1;
     }
-    ~QGLVertexBundlePrivate()
-    {
-        qDeleteAll(attributes);
-    }
+    ~QGLVertexBundlePrivate();
 
     QBasicAtomicInt ref;
     QGLBuffer buffer;
     QList<QGLVertexBundleAttribute *> attributes;
     int vertexCount;
+    int bufferSize;
+    QGLVertexBundle::VertexFormat vertexFormat;
     QGLAttributeSet attributeSet;
+
+    QList<QGLVertexBundleVertexArray *> vertexArrays;
+
+    QGLVertexBundleVertexArray *findVertexArray
+        (const QGLPainterPrivate *painter) const
+    {
+        for (int index = 0; index < vertexArrays.size(); ++index) {
+            if (vertexArrays[index]->painter == painter)
+                return vertexArrays[index];
+        }
+        return 0;
+    }
+
+    QGLVertexBundleAttribute *findAttribute(QGL::VertexAttribute attr) const
+    {
+        for (int index = 0; index < attributes.size(); ++index) {
+            if (attributes[index]->attribute == attr)
+                return attributes[index];
+        }
+        return 0;
+    }
 };
 
 QT_END_NAMESPACE
@@ -14,6 +14,7 @@ SOURCES += \
     qgllitmaterialeffect.cpp \
     qgllittextureeffect.cpp \
     qglshaderprogrameffect.cpp \
+    qglshaderprogramcache.cpp \
     qglcolladafxeffect.cpp \
     qglcolladafxeffectfactory.cpp \
     qglcolladafxeffectloader.cpp
@@ -23,4 +24,5 @@ PRIVATE_HEADERS += \
     qglflattextureeffect_p.h \
     qgllitmaterialeffect_p.h \
     qgllittextureeffect_p.h \
-    qglcolladafxeffect_p.h
+    qglcolladafxeffect_p.h \
+    qglshaderprogramcache_p.h
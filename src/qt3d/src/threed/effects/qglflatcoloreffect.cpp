@@ -41,6 +41,7 @@
 
 #include "qglflatcoloreffect_p.h"
 #include "qglabstracteffect_p.h"
+#include "qglshaderprogramcache_p.h"
 #include <QtOpenGL/qglshaderprogram.h>
 
 QT_BEGIN_NAMESPACE
@@ -149,10 +150,9 @@ void QGLFlatColorEffect::setActive(QGLPainter *painter, bool flag)
         if (!flag)
             return;
         program = new QGLShaderProgram();
-        program->addShaderFromSourceCode(QGLShader::Vertex, flatColorVertexShader);
-        program->addShaderFromSourceCode(QGLShader::Fragment, flatColorFragmentShader);
         program->bindAttributeLocation("vertex", QGL::Position);
-        if (!program->link()) {
+        if (!QGLShaderProgramCache::link(program, flatColorVertexShader,
+                                         flatColorFragmentShader)) {
             qWarning("QGLFlatColorEffect::setActive(): could not link shader program");
             delete program;
             return;
@@ -294,11 +294,10 @@ void QGLPerVertexColorEffect::setActive(QGLPainter *painter, bool flag)
         if (!flag)
             return;
         program = new QGLShaderProgram();
-        program->addShaderFromSourceCode(QGLShader::Vertex, pvColorVertexShader);
-        program->addShaderFromSourceCode(QGLShader::Fragment, pvColorFragmentShader);
         program->bindAttributeLocation("vertex", QGL::Position);
         program->bindAttributeLocation("color", QGL::Color);
-        if (!program->link()) {
+        if (!QGLShaderProgramCache::link(program, pvColorVertexShader,
+                                         pvColorFragmentShader)) {
             qWarning("QGLPerVertexColorEffect::setActive(): could not link shader program");
             delete program;
             program = 0;
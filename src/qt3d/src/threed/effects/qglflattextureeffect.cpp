@@ -42,6 +42,7 @@
 #include "qglflattextureeffect_p.h"
 #include "qglabstracteffect_p.h"
 #include "qglext_p.h"
+#include "qglshaderprogramcache_p.h"
 #include <QtOpenGL/qglshaderprogram.h>
 
 QT_BEGIN_NAMESPACE
@@ -174,11 +175,10 @@ void QGLFlatTextureEffect::setActive(QGLPainter *painter, bool flag)
         if (!flag)
             return;
         program = new QGLShaderProgram();
-        program->addShaderFromSourceCode(QGLShader::Vertex, flatTexVertexShader);
-        program->addShaderFromSourceCode(QGLShader::Fragment, flatTexFragmentShader);
         program->bindAttributeLocation("vertex", QGL::Position);
         program->bindAttributeLocation("texcoord", QGL::TextureCoord0);
-        if (!program->link()) {
+        if (!QGLShaderProgramCache::link(program, flatTexVertexShader,
+                                         flatTexFragmentShader)) {
             qWarning("QGLFlatTextureEffect::setActive(): could not link shader program");
             delete program;
             program = 0;
@@ -307,11 +307,10 @@ void QGLFlatDecalTextureEffect::setActive(QGLPainter *painter, bool flag)
         if (!flag)
             return;
         program = new QGLShaderProgram();
-        program->addShaderFromSourceCode(QGLShader::Vertex, flatTexVertexShader);
-        program->addShaderFromSourceCode(QGLShader::Fragment, flatDecalFragmentShader);
         program->bindAttributeLocation("vertex", QGL::Position);
         program->bindAttributeLocation("texcoord", QGL::TextureCoord0);
-        if (!program->link()) {
+        if (!QGLShaderProgramCache::link(program, flatTexVertexShader,
+                                         flatDecalFragmentShader)) {
             qWarning("QGLFlatDecalTextureEffect::setActive(): could not link shader program");
             delete program;
             program = 0;
@@ -42,6 +42,7 @@
 #include "qgllitmaterialeffect_p.h"
 #include "qglabstracteffect_p.h"
 #include "qglext_p.h"
+#include "qglshaderprogramcache_p.h"
 #include <QtOpenGL/qglshaderprogram.h>
 #include <QtCore/qfile.h>
 
@@ -427,13 +428,14 @@ void QGLLitMaterialEffect::setActive(QGLPainter *painter, bool flag)
         if (!flag)
             return;
         program = new QGLShaderProgram();
-        program->addShaderFromSourceCode(QGLShader::Vertex, createVertexSource(litMaterialLightingShader, d->vertexShader));
-        program->addShaderFromSourceCode(QGLShader::Fragment, d->fragmentShader);
         program->bindAttributeLocation("vertex", QGL::Position);
         program->bindAttributeLocation("normal", QGL::Normal);
         if (d->textureMode != 0)
             program->bindAttributeLocation("texcoord", QGL::TextureCoord0);
-        if (!program->link()) {
+        if (!QGLShaderProgramCache::link
+                (program, createVertexSource(litMaterialLightingShader, d->vertexShader),
+                 d->fragmentShader, QByteArray(),
+                 d->textureMode != 0 ? "texcoord" : "")) {
             qWarning("QGLLitMaterialEffect::setActive(): could not link shader program");
             delete program;
             program = 0;
@@ -495,8 +497,9 @@ void QGLLitMaterialEffect::update
     }
 #endif
     QGLShaderProgram *program = d->program;
-    if ((updates & QGLPainter::UpdateMatrices) != 0) {
+    if ((updates & QGLPainter::UpdateMatrices) != 0)
         program->setUniformValue(d->matrixUniform, painter->combinedMatrix());
+    if ((updates & QGLPainter::UpdateModelViewMatrix) != 0) {
         program->setUniformValue(d->modelViewUniform, painter->modelViewMatrix());
         program->setUniformValue(d->normalMatrixUniform, painter->normalMatrix());
     }
@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qglshaderprogramcache_p.h"
+#include "qglext_p.h"
+#include <QtOpenGL/qglshaderprogram.h>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtGui/qdesktopservices.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QGLShaderProgramCache
+    \brief The QGLShaderProgramCache class keeps linked shader programs in an on-disk cache.
+    \since 4.8
+    \ingroup qt3d
+    \ingroup qt3d::painting
+    \internal
+
+    Linking a shader program from source is slow on many mobile drivers.
+    When the GL implementation supports program binaries
+    (\c{GL_OES_get_program_binary} or \c{GL_ARB_get_program_binary}),
+    link() retrieves the binary of each program it links and stores it
+    in the cache directory of the application.  Later runs load the
+    binary instead of compiling the sources.
+
+    The binaries are keyed by a hash of the shader sources and the GL
+    vendor, renderer and version strings, so a driver update invalidates
+    them.  The driver may still reject a binary, in which case the program
+    is compiled from source and the cached binary is replaced.
+
+    The cache can be disabled by setting the \c{QT3D_NO_SHADER_CACHE}
+    environment variable.
+*/
+
+#define QT3D_NO_SHADER_CACHE "QT3D_NO_SHADER_CACHE"
+
+// Version of the cache file layout and of the key computation.
+static const quint32 qt_gl_shaderCacheVersion = 1;
+
+struct QGLProgramBinaryHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 format;
+    quint32 length;
+};
+
+/*!
+    Links \a program from \a vertexShader, \a fragmentShader and the
+    optional \a geometryShader, using a cached program binary if there
+    is one.  \a keyData identifies any other state that affects the
+    linked program, such as conditional attribute bindings.
+
+    The attribute locations and geometry shader parameters must be set on
+    \a program before calling this function.  Returns the result of
+    QGLShaderProgram::link().
+*/
+bool QGLShaderProgramCache::link
+    (QGLShaderProgram *program, const QByteArray &vertexShader,
+     const QByteArray &fragmentShader, const QByteArray &geometryShader,
+     const QByteArray &keyData)
+{
+    const QGLContext *ctx = QGLContext::currentContext();
+    QGLProgramBinaryExtensions *extn = 0;
+    QString fileName;
+    // Shaders attached by the caller are not part of the key, so such
+    // programs are always linked from source.
+    if (ctx && !getenv(QT3D_NO_SHADER_CACHE) && program->shaders().isEmpty()) {
+        extn = qt_gl_programBinaryExtensions(ctx);
+        if (extn->hasProgramBinary()) {
+            fileName = cacheFileName
+                (vertexShader, fragmentShader, geometryShader, keyData);
+        }
+    }
+
+    // QGLShaderProgram::link() accepts a program without shaders that
+    // has already been linked from a binary.
+    if (!fileName.isEmpty() && loadBinary(program, extn, fileName))
+        return program->link();
+
+    program->addShaderFromSourceCode(QGLShader::Vertex, vertexShader);
+    program->addShaderFromSourceCode(QGLShader::Fragment, fragmentShader);
+    if (!geometryShader.isEmpty())
+        program->addShaderFromSourceCode(QGLShader::Geometry, geometryShader);
+    if (!fileName.isEmpty() && extn->programParameteri) {
+        extn->programParameteri(program->programId(),
+                                GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    if (!program->link())
+        return false;
+
+    if (!fileName.isEmpty())
+        saveBinary(program, extn, fileName);
+    return true;
+}
+
+/*!
+    Returns the path of the cache file for the shader sources and
+    \a keyData in the current context.
+*/
+QString QGLShaderProgramCache::cacheFileName
+    (const QByteArray &vertexShader, const QByteArray &fragmentShader,
+     const QByteArray &geometryShader, const QByteArray &keyData)
+{
+    static QString cacheDir;
+    if (cacheDir.isEmpty()) {
+        cacheDir = QDesktopServices::storageLocation
+            (QDesktopServices::CacheLocation) + QLatin1String("/qt3d-shaders");
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(reinterpret_cast<const char *>(&qt_gl_shaderCacheVersion),
+                 sizeof(qt_gl_shaderCacheVersion));
+    static const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (int index = 0; index < 3; ++index) {
+        const char *str =
+            reinterpret_cast<const char *>(glGetString(strings[index]));
+        hash.addData(str ? str : "", str ? qstrlen(str) + 1 : 1);
+    }
+    hash.addData(vertexShader.constData(), vertexShader.size() + 1);
+    hash.addData(fragmentShader.constData(), fragmentShader.size() + 1);
+    hash.addData(geometryShader.constData(), geometryShader.size() + 1);
+    hash.addData(keyData);
+
+    return cacheDir + QLatin1Char('/') +
+           QString::fromLatin1(hash.result().toHex()) +
+           QLatin1String(".bin");
+}
+
+/*!
+    Loads the program binary in \a fileName into \a program.  Returns
+    false if there is no binary, or if the driver rejected it.
+*/
+bool QGLShaderProgramCache::loadBinary
+    (QGLShaderProgram *program, QGLProgramBinaryExtensions *extn,
+     const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray contents = file.readAll();
+    file.close();
+
+    const QGLProgramBinaryHeader *header =
+        reinterpret_cast<const QGLProgramBinaryHeader *>(contents.constData());
+    if (contents.size() < int(sizeof(QGLProgramBinaryHeader)) ||
+            qstrncmp(header->magic, "QGLB", 4) != 0 ||
+            header->version != qt_gl_shaderCacheVersion ||
+            header->length != quint32(contents.size()) - sizeof(QGLProgramBinaryHeader))
+        return false;
+
+    GLuint id = program->programId();
+    if (!id)
+        return false;
+    extn->programBinary(id, GLenum(header->format), header + 1,
+                        GLint(header->length));
+    GLint linked = 0;
+    glGetProgramiv(id, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Stale binary, for example after a driver update with the same
+        // version string.  It is replaced when the program is linked.
+        QFile::remove(fileName);
+        return false;
+    }
+    return true;
+}
+
+/*!
+    Retrieves the binary of the linked \a program and writes it to
+    \a fileName.
+*/
+void QGLShaderProgramCache::saveBinary
+    (QGLShaderProgram *program, QGLProgramBinaryExtensions *extn,
+     const QString &fileName)
+{
+    GLuint id = program->programId();
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    QByteArray contents(int(sizeof(QGLProgramBinaryHeader)) + length, 0);
+    QGLProgramBinaryHeader *header =
+        reinterpret_cast<QGLProgramBinaryHeader *>(contents.data());
+    GLsizei written = 0;
+    GLenum format = 0;
+    extn->getProgramBinary(id, length, &written, &format, header + 1);
+    if (written <= 0)
+        return;
+    memcpy(header->magic, "QGLB", 4);
+    header->version = qt_gl_shaderCacheVersion;
+    header->format = quint32(format);
+    header->length = quint32(written);
+    contents.resize(int(sizeof(QGLProgramBinaryHeader)) + written);
+
+    // Write to a temporary file first, so that an interrupted write
+    // never leaves a truncated binary behind.
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QString tempFileName = fileName + QLatin1String(".tmp");
+    QFile file(tempFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    bool ok = (file.write(contents) == contents.size());
+    file.close();
+    QFile::remove(fileName);
+    if (!ok || !QFile::rename(tempFileName, fileName))
+        QFile::remove(tempFileName);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QGLSHADERPROGRAMCACHE_P_H
+#define QGLSHADERPROGRAMCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+class QGLShaderProgram;
+class QGLProgramBinaryExtensions;
+
+class QGLShaderProgramCache
+{
+public:
+    static bool link(QGLShaderProgram *program,
+                     const QByteArray &vertexShader,
+                     const QByteArray &fragmentShader,
+                     const QByteArray &geometryShader = QByteArray(),
+                     const QByteArray &keyData = QByteArray());
+
+private:
+    static QString cacheFileName(const QByteArray &vertexShader,
+                                 const QByteArray &fragmentShader,
+                                 const QByteArray &geometryShader,
+                                 const QByteArray &keyData);
+    static bool loadBinary(QGLShaderProgram *program,
+                           QGLProgramBinaryExtensions *extn,
+                           const QString &fileName);
+    static void saveBinary(QGLShaderProgram *program,
+                           QGLProgramBinaryExtensions *extn,
+                           const QString &fileName);
+};
+
+QT_END_NAMESPACE
+
+#endif
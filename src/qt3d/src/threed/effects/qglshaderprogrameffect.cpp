@@ -41,6 +41,7 @@
 
 #include "qglshaderprogrameffect.h"
 #include "qglabstracteffect_p.h"
+#include "qglshaderprogramcache_p.h"
 #include <QtOpenGL/qglshaderprogram.h>
 #include <QtCore/qfile.h>
 
@@ -703,24 +704,23 @@ void QGLShaderProgramEffect::setActive(QGLPainter *painter, bool flag)
         Q_ASSERT(!d->vertexShader.isEmpty());
         Q_ASSERT(!d->fragmentShader.isEmpty());
         d->program = new QGLShaderProgram();
-        d->program->addShaderFromSourceCode
-            (QGLShader::Vertex, d->vertexShader);
-        d->program->addShaderFromSourceCode
-            (QGLShader::Fragment, d->fragmentShader);
+        QByteArray keyData;
         if (!d->geometryShader.isEmpty())
         {
-            d->program->addShaderFromSourceCode
-                (QGLShader::Geometry, d->geometryShader);
             d->program->setGeometryInputType(d->geometryInputType);
             d->program->setGeometryOutputType(d->geometryOutputType);
-
+            keyData += QByteArray::number(d->geometryInputType) + ' ' +
+                       QByteArray::number(d->geometryOutputType) + ' ';
         }
 
         if (beforeLink()) {
             for (attr = 0; attr < numAttributes; ++attr)
                 d->program->bindAttributeLocation(attributes[attr], attr);
+            keyData += "attributes";
         }
-        if (!d->program->link()) {
+        if (!QGLShaderProgramCache::link
+                (d->program, d->vertexShader, d->fragmentShader,
+                 d->geometryShader, keyData)) {
             qWarning("QGLShaderProgramEffect::setActive(): could not link shader program");
             delete d->program;
             d->program = 0;
@@ -1101,6 +1101,11 @@ QGLShaderProgram *QGLShaderProgramEffect::program() const
     vertex attribute bindings, or to add additional shader stages
     to program().
 
+    The linked program is stored in an on-disk cache of program
+    binaries when the GL implementation supports them, and later
+    loaded from the cache instead of being compiled.  Programs
+    with additional shader stages added here are not cached.
+
     \sa afterLink()
 */
 bool QGLShaderProgramEffect::beforeLink()
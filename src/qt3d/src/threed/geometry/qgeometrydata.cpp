@@ -142,8 +142,12 @@ public:
     QGLIndexBuffer indexBuffer;
     bool uploadsViable;
     bool modified;
+    mutable bool buffersShared;
     QBox3D bb;
     static const int ATTR_CNT = 32;
+    quint32 dirtyFields;
+    int dirtyStart[ATTR_CNT];
+    int dirtyEnd[ATTR_CNT];
     quint32 fields;
     qint8 key[ATTR_CNT];
     quint8 size[ATTR_CNT];
@@ -151,11 +155,28 @@ public:
     int reserved;
     bool boxValid;
     QGeometryData::BufferStrategy bufferStrategy;
+
+    // Records that element i of field was changed in place, so that
+    // upload() can write just the changed span into the existing buffer.
+    inline void markDirty(QGL::VertexAttribute field, int i)
+    {
+        const quint32 mask = QGL::fieldMask(field);
+        if (dirtyFields & mask) {
+            dirtyStart[field] = qMin(dirtyStart[field], i);
+            dirtyEnd[field] = qMax(dirtyEnd[field], i + 1);
+        } else {
+            dirtyFields |= mask;
+            dirtyStart[field] = i;
+            dirtyEnd[field] = i + 1;
+        }
+    }
 };
 
 QGeometryDataPrivate::QGeometryDataPrivate()
     : uploadsViable(true)
     , modified(false)
+    , buffersShared(false)
+    , dirtyFields(0)
     , fields(0)
     , count(0)
     , reserved(-1)
@@ -184,6 +205,13 @@ QGeometryDataPrivate *QGeometryDataPrivate::clone() const
     temp->indexBuffer = indexBuffer;
     temp->uploadsViable = uploadsViable;
     temp->modified = modified;
+    // The copy refers to the same GL buffers, so neither may update them
+    // in place until it has uploaded buffers of its own.
+    temp->buffersShared = true;
+    buffersShared = true;
+    temp->dirtyFields = dirtyFields;
+    qMemCopy(temp->dirtyStart, dirtyStart, sizeof(dirtyStart));
+    qMemCopy(temp->dirtyEnd, dirtyEnd, sizeof(dirtyEnd));
     temp->bb = bb;
     temp->fields = fields;
     qMemCopy(temp->key, key, ATTR_CNT);
@@ -216,9 +244,26 @@ QGeometryDataPrivate *QGeometryDataPrivate::clone() const
     in this case KeepClientData may be used resulting in no attempt to upload
     the data and client side arrays used instead.
 
+    Geometry whose vertex values are changed in place after upload, for
+    example with texCoord() or vertex(), can specify DynamicData so that
+    upload() writes only the changed range of each attribute into the
+    existing buffer.  Geometry that is rewritten on every frame can
+    specify StreamData: the buffers are then orphaned and refilled on
+    each upload, and the geometry may even be cleared and rebuilt as long
+    as the vertex and index counts stay the same.  Both require
+    KeepClientData.
+
+    Static geometry can specify CompactData to have the vertex attributes
+    quantized into a smaller format on upload, see
+    QGLVertexBundle::CompactFormat.  It is ignored together with
+    DynamicData or StreamData.
+
     \value InvalidStrategy No valid strategy has been specified.
     \value KeepClientData Keep the client data, even after successful upload to the GPU.
     \value BufferIfPossible Try to upload the data to the GPU.
+    \value DynamicData The vertex data will be modified occasionally after upload.
+    \value StreamData The vertex data will be modified on most frames.
+    \value CompactData Quantize the vertex data into a compact format on upload.
 */
 
 /*!
@@ -900,14 +945,33 @@ bool QGeometryData::upload()
 
     if (!d)
         return false;
-    if (!d->modified)
+    if (!d->modified && !d->dirtyFields)
         return d->vertexBundle.isUploaded() && d->indexBuffer.isUploaded();
 
     check();
 
+    // Write changed values into the existing buffers if possible.
+    if (updateUploadedBuffers())
+        return true;
+
     // Need to recreate the buffers from the modified data.
     d->vertexBundle = QGLVertexBundle();
     d->indexBuffer = QGLIndexBuffer();
+    d->buffersShared = false;
+    d->dirtyFields = 0;
+    if ((d->bufferStrategy & StreamData) != 0)
+    {
+        d->vertexBundle.setUsagePattern(QGLBuffer::StreamDraw);
+        d->indexBuffer.setUsagePattern(QGLBuffer::StreamDraw);
+    }
+    else if ((d->bufferStrategy & DynamicData) != 0)
+    {
+        d->vertexBundle.setUsagePattern(QGLBuffer::DynamicDraw);
+    }
+    else if ((d->bufferStrategy & CompactData) != 0)
+    {
+        d->vertexBundle.setVertexFormat(QGLVertexBundle::CompactFormat);
+    }
 
     // Copy the geometry data to the vertex buffer.
     const quint32 mask = 0x01;
@@ -953,6 +1017,77 @@ bool QGeometryData::upload()
     return vboUploaded && iboUploaded;
 }
 
+/*!
+    \internal
+    Writes the data that changed since the last upload() into the buffers
+    that were created by it, rather than recreating them.  Returns false
+    if the buffers have to be recreated: nothing was uploaded yet, the
+    buffers are shared with a copy of this geometry, or the layout or
+    size of the data changed.
+*/
+bool QGeometryData::updateUploadedBuffers()
+{
+    if (!(d->bufferStrategy & (DynamicData | StreamData)) ||
+            !(d->bufferStrategy & KeepClientData) || d->buffersShared)
+        return false;
+    if (!d->vertexBundle.isUploaded() || !d->indexBuffer.isUploaded())
+        return false;
+    const bool stream = (d->bufferStrategy & StreamData) != 0;
+    if (d->modified)
+    {
+        // Structural changes can only be streamed into buffers that
+        // have exactly the same layout as the new data.
+        if (!stream || d->vertexBundle.vertexCount() != d->count ||
+                d->indexBuffer.indexCount() != d->indices.count())
+            return false;
+        QGLAttributeSet attributes = d->vertexBundle.attributes();
+        for (int field = 0; field < d->ATTR_CNT; ++field)
+        {
+            QGL::VertexAttribute attr = static_cast<QGL::VertexAttribute>(field);
+            bool enabled = (d->fields & QGL::fieldMask(attr)) != 0;
+            if (enabled != attributes.contains(attr))
+                return false;
+            if (enabled && count(attr) != d->count)
+                return false;
+        }
+    }
+
+    if (stream)
+        d->vertexBundle.orphan();
+    const quint32 mask = 0x01;
+    quint32 fields = d->fields;
+    for (int field = 0; fields; ++field, fields >>= 1)
+    {
+        if (!(mask & fields))
+            continue;
+        QGL::VertexAttribute attr = static_cast<QGL::VertexAttribute>(field);
+        int start = 0;
+        int end = count(attr);
+        if (!stream && !d->modified)
+        {
+            if (!(d->dirtyFields & QGL::fieldMask(attr)))
+                continue;
+            start = d->dirtyStart[field];
+            end = qMin(d->dirtyEnd[field], end);
+            if (start >= end)
+                continue;
+        }
+        QGLAttributeValue value = attributeValue(attr);
+        int elemSize = value.tupleSize() * value.sizeOfType();
+        const char *data = reinterpret_cast<const char *>(value.data());
+        QGLAttributeValue span(value.tupleSize(), value.type(), 0,
+                               data + start * elemSize, end - start);
+        if (!d->vertexBundle.replaceAttribute(attr, start, span))
+            return false;
+    }
+    if (d->modified)
+        d->indexBuffer.replaceIndexes(0, d->indices);
+
+    d->modified = false;
+    d->dirtyFields = 0;
+    return true;
+}
+
 /*!
     Sets the buffer \a strategy for this geometry.
 
@@ -1445,7 +1580,7 @@ void QGeometryData::appendColorArray(const QArray<QColor4ub> &ary)
 QVector3D &QGeometryData::vertex(int i)
 {
     create();
-    d->modified = true;
+    d->markDirty(QGL::Position, i);
     d->boxValid = false;
     return d->vertices[i];
 }
@@ -1487,7 +1622,7 @@ const QVector3D &QGeometryData::vertexAt(int i) const
 QVector3D &QGeometryData::normal(int i)
 {
     create();
-    d->modified = true;
+    d->markDirty(QGL::Normal, i);
     return d->normals[i];
 }
 
@@ -1516,7 +1651,7 @@ QVector3DArray QGeometryData::normals() const
 QColor4ub &QGeometryData::color(int i)
 {
     create();
-    d->modified = true;
+    d->markDirty(QGL::Color, i);
     return d->colors[i];
 }
 
@@ -1545,7 +1680,7 @@ QArray<QColor4ub> QGeometryData::colors() const
 QVector2D &QGeometryData::texCoord(int i, QGL::VertexAttribute field)
 {
     create();
-    d->modified = true;
+    d->markDirty(field, i);
     return d->textures[d->key[field]][i];
 }
 
@@ -1572,7 +1707,7 @@ const QVector2D &QGeometryData::texCoordAt(int i, QGL::VertexAttribute field) co
 float &QGeometryData::floatAttribute(int i, QGL::VertexAttribute field)
 {
     create();
-    d->modified = true;
+    d->markDirty(field, i);
     QCustomDataArray &ary = d->attributes[d->key[field]];
     Q_ASSERT(ary.elementType() == QCustomDataArray::Float);
     return ary.m_array[i];
@@ -1584,7 +1719,7 @@ float &QGeometryData::floatAttribute(int i, QGL::VertexAttribute field)
 QVector2D &QGeometryData::vector2DAttribute(int i, QGL::VertexAttribute field)
 {
     create();
-    d->modified = true;
+    d->markDirty(field, i);
     QCustomDataArray &ary = d->attributes[d->key[field]];
     Q_ASSERT(ary.elementType() == QCustomDataArray::Vector2D);
     float *data = ary.m_array.data();
@@ -1598,7 +1733,7 @@ QVector2D &QGeometryData::vector2DAttribute(int i, QGL::VertexAttribute field)
 QVector3D &QGeometryData::vector3DAttribute(int i, QGL::VertexAttribute field)
 {
     create();
-    d->modified = true;
+    d->markDirty(field, i);
     QCustomDataArray &ary = d->attributes[d->key[field]];
     Q_ASSERT(ary.elementType() == QCustomDataArray::Vector3D);
     float *data = ary.m_array.data();
@@ -102,6 +102,9 @@ public:
         InvalidStrategy     = 0x00,
         KeepClientData      = 0x01,
         BufferIfPossible    = 0x02,
+        DynamicData         = 0x04,
+        StreamData          = 0x08,
+        CompactData         = 0x10
     };
 #if !defined(Q_QDOC)
     Q_DECLARE_FLAGS(BufferStrategy, BufferStrategyFlags)
@@ -194,6 +197,7 @@ protected:
     const QVector3DArray *vertexData() const;
 private:
     void create();
+    bool updateUploadedBuffers();
 #ifndef QT_NO_DEBUG
     void check() const;
 #else
@@ -415,7 +415,6 @@ QGLBuilderPrivate::QGLBuilderPrivate(QGLBuilder *parent)
     : currentSection(0)
     , currentNode(0)
     , rootNode(0)
-    , defThreshold(5)
     , q(parent)
 {
 }
@@ -1194,7 +1193,6 @@ void QGLBuilder::newSection(QGL::Smoothing smooth)
 void QGLBuilder::addSection(QGLSection *sec)
 {
     dptr->currentSection = sec;
-    sec->setMapThreshold(dptr->defThreshold);
     dptr->sections.append(sec);
     dptr->nodeStack.clear();
     newNode();
@@ -1218,15 +1216,6 @@ QList<QGLSection*> QGLBuilder::sections() const
     return dptr->sections;
 }
 
-/*!
-    \internal
-    Test function only.
-*/
-void QGLBuilder::setDefaultThreshold(int t)
-{
-    dptr->defThreshold = t;
-}
-
 /*!
     Returns the root scene node of the geometry created by this builder.
 
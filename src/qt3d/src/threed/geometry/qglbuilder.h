@@ -97,7 +97,6 @@ protected:
     // internal and test functions
     QGLSection *currentSection() const;
     QList<QGLSection*> sections() const;
-    void setDefaultThreshold(int);
 
 private:
     Q_DISABLE_COPY(QGLBuilder);
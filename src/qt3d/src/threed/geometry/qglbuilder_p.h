@@ -80,7 +80,6 @@ public:
     QList<QGLSceneNode*> nodeStack;
     QGLSceneNode *currentNode;
     QGLSceneNode *rootNode;
-    int defThreshold;
     QGLBuilder *q;
 };
 
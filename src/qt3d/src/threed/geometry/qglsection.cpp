@@ -47,7 +47,8 @@
 #include <QtGui/qvector3d.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qpointer.h>
-#include <QtCore/qmap.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmath.h>
 #include <QtCore/qbitarray.h>
 
 #include <limits.h>
@@ -105,33 +106,6 @@
     discussion of smoothing.
 */
 
-// allow QVector3D's to be stored in a QMap
-inline bool operator<(const QVector3D &a, const QVector3D &b)
-{
-    if (qFskCompare(a.x(), b.x()))
-    {
-        if (qFskCompare(a.y(), b.y()))
-        {
-            if (qFskCompare(a.z(), b.z()))
-            {
-                return false;  // equal so not less-than
-            }
-            else
-            {
-                return a.z() < b.z();
-            }
-        }
-        else
-        {
-            return a.y() < b.y();
-        }
-    }
-    else
-    {
-        return a.x() < b.x();
-    }
-}
-
 static inline bool qSameDirection(const QVector3D &a , const QVector3D &b)
 {
     bool res = false;
@@ -148,11 +122,7 @@ class QGLSectionPrivate
 public:
     QGLSectionPrivate(const QVector3DArray *ary)
         : vec_data(ary)
-        , it(vec_map.end())
-        , map_threshold(5)
-        , number_mapped(0)
-        , start_ptr(-1)
-        , end_ptr(-1)
+        , cell_count(0)
     {
         normIndices.fill(-1, 32);
     }
@@ -204,96 +174,157 @@ public:
         }
     }
 
-    void mapVertex(const QVector3D &v, int ix)
+    // Vertices are welded by hashing the grid cell that contains them.
+    // The cells are much larger than the qFskCompare() tolerance, so a
+    // fuzzy match is either in the same cell as the target or in a
+    // neighbouring one when the target is close to a cell boundary.
+    // The cell table uses open addressing with linear probing, and the
+    // vertices in each cell are chained through a flat entry arena.
+    struct Cell
     {
-        Q_UNUSED(ix);
-        Q_UNUSED(v);
-        static bool seeded = false;
-        if (!seeded)
-            qsrand(31415);
-        Q_ASSERT(vec_data->at(ix) == v);
-        if ((vec_data->size() - number_mapped) > map_threshold)
+        int x;
+        int y;
+        int z;
+        int head;
+    };
+
+    struct Entry
+    {
+        int vertex;
+        int next;
+    };
+
+    static inline int quantize(float value)
+    {
+        return int(qFloor(qBound(float(-INT_MAX / 2), value * 1024.0f,
+                                 float(INT_MAX / 2))));
+    }
+
+    static inline uint cellHash(int x, int y, int z)
+    {
+        return (uint(x) * 73856093U) ^ (uint(y) * 19349663U) ^
+               (uint(z) * 83492791U);
+    }
+
+    int findCell(int x, int y, int z) const
+    {
+        uint mask = uint(cells.size() - 1);
+        uint slot = cellHash(x, y, z) & mask;
+        for (;;)
         {
-            int to_map = vec_data->size() - number_mapped;
-            QArray<int, 100> shuffle(to_map, -1);
-            for (int i = number_mapped, k = 0; i < vec_data->size(); ++i, ++k)
-                shuffle[k] = i;
-            for (int n = to_map; n > 1; --n)
-            {
-                int k = qrand() % n;
-                int tmp = shuffle[k];
-                shuffle[k] = shuffle[n - 1];
-                shuffle[n - 1] = tmp;
-            }
-            for (int i = 0; i < to_map; ++i)
-                vec_map.insertMulti(vec_data->at(shuffle.at(i)), shuffle.at(i));
-            number_mapped += to_map;
+            const Cell &cell = cells.at(int(slot));
+            if (cell.head == -1)
+                return -1;
+            if (cell.x == x && cell.y == y && cell.z == z)
+                return int(slot);
+            slot = (slot + 1) & mask;
         }
     }
 
-    int nextIndex()
+    int insertCell(int x, int y, int z)
     {
-        int result = -1;
-        if (end_ptr != -1)
+        uint mask = uint(cells.size() - 1);
+        uint slot = cellHash(x, y, z) & mask;
+        for (;;)
         {
-            // first look through the unmapped items
-            while (start_ptr <= end_ptr && result == -1)
+            Cell &cell = cells[int(slot)];
+            if (cell.head == -1)
             {
-                // search from the end and beginning, favouring the end - most often
-                // its in the last few we added, sometimes in the first ones
-                if (qFskCompare(vec_data->at(end_ptr--), target))
-                    result = end_ptr+1;
-                else if (start_ptr <= end_ptr && qFskCompare(vec_data->at(end_ptr--), target))
-                    result = end_ptr+1;
-                else if (start_ptr <= end_ptr && qFskCompare(vec_data->at(start_ptr++), target))
-                    result = start_ptr-1;
-            }
-            // if that found nothing, have a look at the map
-            if (result == -1)
-            {
-                start_ptr = -1;
-                end_ptr = -1;
-                it = vec_map.constEnd();
-                if (vec_map.size() > 0)
-                    it = vec_map.find(target);
+                cell.x = x;
+                cell.y = y;
+                cell.z = z;
+                ++cell_count;
+                return int(slot);
             }
+            if (cell.x == x && cell.y == y && cell.z == z)
+                return int(slot);
+            slot = (slot + 1) & mask;
         }
-        if (it != vec_map.constEnd())
+    }
+
+    void rehash(int size)
+    {
+        QArray<Cell> old = cells;
+        Cell empty = { 0, 0, 0, -1 };
+        cells = QArray<Cell>(size, empty);
+        cell_count = 0;
+        for (int i = 0; i < old.size(); ++i)
         {
-            // if there was something in the map see if its still on target
-            if (qFskCompare(it.key(), target))
-            {
-                result = it.value();
-                ++it;  // increment to find more insertMulti instances
-            }
-            else
-            {
-                // not on target - flag that we're done here
-                it = vec_map.constEnd();
-            }
+            const Cell &cell = old.at(i);
+            if (cell.head != -1)
+                cells[insertCell(cell.x, cell.y, cell.z)].head = cell.head;
         }
+    }
+
+    void reserveVertices(int amount)
+    {
+        entries.reserve(amount);
+        int size = 64;
+        while (size < amount * 2)
+            size *= 2;
+        if (size > cells.size())
+            rehash(size);
+    }
+
+    void mapVertex(const QVector3D &v, int ix)
+    {
+        Q_ASSERT(vec_data->at(ix) == v);
+        if ((cell_count + 1) * 2 > cells.size())
+            rehash(qMax(64, cells.size() * 2));
+        int slot = insertCell(quantize(v.x()), quantize(v.y()), quantize(v.z()));
+        Entry entry = { ix, cells.at(slot).head };
+        cells[slot].head = entries.size();
+        entries.append(entry);
+    }
+
+    int nextIndex()
+    {
+        if (matches.isEmpty())
+            return -1;
+        int result = matches.last();
+        matches.removeLast();
         return result;
     }
 
     int findVertex(const QVector3D &v)
     {
-        end_ptr = vec_data->size() - 1;   // last one not in QMap
-        start_ptr = number_mapped;        // first one not in QMap
-        target = v;
+        matches.resize(0);
+        if (cells.isEmpty())
+            return -1;
+        const float eps = 0.00001f;
+        int x0 = quantize(v.x() - eps), x1 = quantize(v.x() + eps);
+        int y0 = quantize(v.y() - eps), y1 = quantize(v.y() + eps);
+        int z0 = quantize(v.z() - eps), z1 = quantize(v.z() + eps);
+        for (int x = x0; x <= x1; ++x)
+        {
+            for (int y = y0; y <= y1; ++y)
+            {
+                for (int z = z0; z <= z1; ++z)
+                {
+                    int slot = findCell(x, y, z);
+                    if (slot == -1)
+                        continue;
+                    for (int e = cells.at(slot).head; e != -1; e = entries.at(e).next)
+                    {
+                        int ix = entries.at(e).vertex;
+                        if (qFskCompare(vec_data->at(ix), v))
+                            matches.append(ix);
+                    }
+                }
+            }
+        }
+        // Entries in a cell are chained newest first, so taking the
+        // matches from the end of the list visits older vertices first.
         return nextIndex();
     }
 
     // mapper
-    int index;
-    QVector3D target;
     const QVector3DArray *vec_data;
-    QMap<QVector3D, int> vec_map;
-    QMap<int, int> index_map;
-    QMap<QVector3D,int>::const_iterator it;
-    int map_threshold;   // if more than this is unmapped, do a mapping run
-    int number_mapped;    // how many vertices have been mapped
-    int start_ptr;
-    int end_ptr;
+    QArray<Cell> cells;
+    QArray<Entry> entries;
+    QArray<int, 8> matches;
+    int cell_count;
+    QHash<int, int> index_map;
 
     QArray<int, 32> normIndices;
     QArray<int, 32> normPtrs;
@@ -349,6 +380,7 @@ void QGLSection::reserve(int amount)
     d->normIndices.reserve(amount);
     d->normPtrs.reserve(amount * 2);
     d->normValues.reserve(amount);
+    d->reserveVertices(amount);
 }
 
 /*!
@@ -546,7 +578,7 @@ void QGLSection::appendSmooth(const QLogicalVertex &lv, int index)
     Q_ASSERT(lv.hasField(QGL::Normal));
 
     int found_index = -1;
-    QMap<int, int>::const_iterator it = d->index_map.constFind(index);
+    QHash<int, int>::const_iterator it = d->index_map.constFind(index);
     if (it != d->index_map.constEnd())
         found_index = it.value();
     if (found_index == -1)
@@ -607,34 +639,6 @@ void QGLSection::appendFaceted(const QLogicalVertex &lv)
     }
 }
 
-/*!
-    \internal
-    Returns the current map threshold for this section.  The threshold is the
-    point at which the section switches from using a plain QArray - with
-    linear performance ie O(n) - to using a QMap - with approx O(log n).  These
-    structures are used for looking up vertices during the index generation and
-    normals calculation.
-
-    The default value is 50.
-
-    \sa setMapThreshold()
-*/
-int QGLSection::mapThreshold() const
-{
-    return d->map_threshold;
-}
-
-/*!
-    \internal
-    Sets the current map threshold to \a t for this section.
-
-    \sa mapThreshold()
-*/
-void QGLSection::setMapThreshold(int t)
-{
-    d->map_threshold = t;
-}
-
 /*!
     \internal
     Returns a list of the QGLSceneNode instances associated with this section.
@@ -97,8 +97,6 @@ public:
 
     inline QGL::Smoothing smoothing() const;
     inline void setSmoothing(QGL::Smoothing s);
-    int mapThreshold() const;
-    void setMapThreshold(int);
     QList<QGLSceneNode*> nodes() const;
     void addNode(QGLSceneNode *node);
     bool deleteNode(QGLSceneNode *node);
@@ -96,4 +96,83 @@ void qt_gl_ClientActiveTexture(GLenum texture)
 
 #endif
 
+Q_GLOBAL_STATIC(QGLResource<QGLVertexArrayExtensions>, qt_vertexarray_funcs)
+
+QGLVertexArrayExtensions *qt_gl_vertexArrayExtensions(const QGLContext *ctx)
+{
+    QGLVertexArrayExtensions *extn = qt_vertexarray_funcs()->value(ctx);
+    if (!(extn->vertexArraysResolved)) {
+        extn->vertexArraysResolved = true;
+        const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        QGLExtensionChecker checker(extensions ? extensions : "");
+#if defined(QT_OPENGL_ES)
+        if (checker.match("GL_OES_vertex_array_object")) {
+            extn->genVertexArrays = (q_PFNGLGENVERTEXARRAYSPROC)
+                ctx->getProcAddress(QLatin1String("glGenVertexArraysOES"));
+            extn->bindVertexArray = (q_PFNGLBINDVERTEXARRAYPROC)
+                ctx->getProcAddress(QLatin1String("glBindVertexArrayOES"));
+            extn->deleteVertexArrays = (q_PFNGLDELETEVERTEXARRAYSPROC)
+                ctx->getProcAddress(QLatin1String("glDeleteVertexArraysOES"));
+        }
+#else
+        if (checker.match("GL_ARB_vertex_array_object") ||
+                (QGLFormat::openGLVersionFlags() & QGLFormat::OpenGL_Version_3_0) != 0) {
+            extn->genVertexArrays = (q_PFNGLGENVERTEXARRAYSPROC)
+                ctx->getProcAddress(QLatin1String("glGenVertexArrays"));
+            extn->bindVertexArray = (q_PFNGLBINDVERTEXARRAYPROC)
+                ctx->getProcAddress(QLatin1String("glBindVertexArray"));
+            extn->deleteVertexArrays = (q_PFNGLDELETEVERTEXARRAYSPROC)
+                ctx->getProcAddress(QLatin1String("glDeleteVertexArrays"));
+        }
+#endif
+        if (!extn->genVertexArrays || !extn->bindVertexArray ||
+                !extn->deleteVertexArrays) {
+            extn->genVertexArrays = 0;
+            extn->bindVertexArray = 0;
+            extn->deleteVertexArrays = 0;
+        }
+    }
+    return extn;
+}
+
+Q_GLOBAL_STATIC(QGLResource<QGLProgramBinaryExtensions>, qt_programbinary_funcs)
+
+QGLProgramBinaryExtensions *qt_gl_programBinaryExtensions(const QGLContext *ctx)
+{
+    QGLProgramBinaryExtensions *extn = qt_programbinary_funcs()->value(ctx);
+    if (!(extn->programBinaryResolved)) {
+        extn->programBinaryResolved = true;
+        const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        QGLExtensionChecker checker(extensions ? extensions : "");
+#if defined(QT_OPENGL_ES)
+        if (checker.match("GL_OES_get_program_binary")) {
+            extn->getProgramBinary = (q_PFNGLGETPROGRAMBINARYPROC)
+                ctx->getProcAddress(QLatin1String("glGetProgramBinaryOES"));
+            extn->programBinary = (q_PFNGLPROGRAMBINARYPROC)
+                ctx->getProcAddress(QLatin1String("glProgramBinaryOES"));
+        }
+#else
+        if (checker.match("GL_ARB_get_program_binary")) {
+            extn->getProgramBinary = (q_PFNGLGETPROGRAMBINARYPROC)
+                ctx->getProcAddress(QLatin1String("glGetProgramBinary"));
+            extn->programBinary = (q_PFNGLPROGRAMBINARYPROC)
+                ctx->getProcAddress(QLatin1String("glProgramBinary"));
+            extn->programParameteri = (q_PFNGLPROGRAMPARAMETERIPROC)
+                ctx->getProcAddress(QLatin1String("glProgramParameteri"));
+        }
+#endif
+        // Drivers may advertise the extension without supporting any
+        // binary formats, in which case nothing can be retrieved.
+        GLint formats = 0;
+        if (extn->programBinary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (!extn->getProgramBinary || !extn->programBinary || formats <= 0) {
+            extn->getProgramBinary = 0;
+            extn->programBinary = 0;
+            extn->programParameteri = 0;
+        }
+    }
+    return extn;
+}
+
 QT_END_NAMESPACE
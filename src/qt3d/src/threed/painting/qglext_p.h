@@ -55,6 +55,7 @@
 
 #include <QtOpenGL/qgl.h>
 #include "qt3dglobal.h"
+#include "qopenglfunctions.h"
 
 QT_BEGIN_HEADER
 
@@ -72,6 +73,74 @@ extern void Q_QT3D_EXPORT qt_gl_ClientActiveTexture(GLenum texture);
 
 #endif
 
+// Vertex array objects from GL_OES_vertex_array_object (OpenGL/ES),
+// GL_ARB_vertex_array_object or OpenGL 3.0 (desktop).  The function
+// pointers are null if the context does not support them.
+
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLGENVERTEXARRAYSPROC) (GLsizei, GLuint *);
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLBINDVERTEXARRAYPROC) (GLuint);
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLDELETEVERTEXARRAYSPROC) (GLsizei, const GLuint *);
+
+class QGLVertexArrayExtensions
+{
+public:
+    QGLVertexArrayExtensions(const QGLContext * = 0)
+    {
+        genVertexArrays = 0;
+        bindVertexArray = 0;
+        deleteVertexArrays = 0;
+        vertexArraysResolved = false;
+    }
+
+    bool hasVertexArrays() const { return bindVertexArray != 0; }
+
+    q_PFNGLGENVERTEXARRAYSPROC genVertexArrays;
+    q_PFNGLBINDVERTEXARRAYPROC bindVertexArray;
+    q_PFNGLDELETEVERTEXARRAYSPROC deleteVertexArrays;
+    bool vertexArraysResolved;
+};
+
+extern Q_QT3D_EXPORT QGLVertexArrayExtensions *qt_gl_vertexArrayExtensions(const QGLContext *ctx);
+
+// Program binaries from GL_OES_get_program_binary (OpenGL/ES) or
+// GL_ARB_get_program_binary (desktop).  The function pointers are null
+// if the context does not support them.
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH            0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS       0x87FE
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT  0x8257
+#endif
+
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLGETPROGRAMBINARYPROC) (GLuint, GLsizei, GLsizei *, GLenum *, void *);
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLPROGRAMBINARYPROC) (GLuint, GLenum, const void *, GLint);
+typedef void (QT3D_GLF_APIENTRYP q_PFNGLPROGRAMPARAMETERIPROC) (GLuint, GLenum, GLint);
+
+class QGLProgramBinaryExtensions
+{
+public:
+    QGLProgramBinaryExtensions(const QGLContext * = 0)
+    {
+        getProgramBinary = 0;
+        programBinary = 0;
+        programParameteri = 0;
+        programBinaryResolved = false;
+    }
+
+    bool hasProgramBinary() const { return programBinary != 0; }
+
+    q_PFNGLGETPROGRAMBINARYPROC getProgramBinary;
+    q_PFNGLPROGRAMBINARYPROC programBinary;
+    q_PFNGLPROGRAMPARAMETERIPROC programParameteri;
+    bool programBinaryResolved;
+};
+
+extern Q_QT3D_EXPORT QGLProgramBinaryExtensions *qt_gl_programBinaryExtensions(const QGLContext *ctx);
+
 class QGLExtensionChecker
 {
 public:
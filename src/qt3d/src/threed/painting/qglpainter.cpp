@@ -120,11 +120,19 @@ QGLPainterPrivate::QGLPainterPrivate()
       viewingCube(QVector3D(-1, -1, -1), QVector3D(1, 1, 1)),
       color(255, 255, 255, 255),
       updates(QGLPainter::UpdateAll),
+      updatedModelViewGeneration(0),
+      updatedProjectionGeneration(0),
+      combinedModelViewGeneration(0),
+      combinedProjectionGeneration(0),
+      normalMatrixGeneration(0),
       pick(0),
       boundVertexBuffer(0),
       boundIndexBuffer(0),
       renderSequencer(0),
-      isFixedFunction(true) // Updated by QGLPainter::begin()
+      isFixedFunction(true), // Updated by QGLPainter::begin()
+      vertexArrayFuncs(0),
+      vertexArray(0),
+      defaultIndexBuffer(0)
 {
     context = 0;
     effect = 0;
@@ -145,6 +153,68 @@ QGLPainterPrivate::~QGLPainterPrivate()
     delete pick;
     qDeleteAll(cachedPrograms);
     delete renderSequencer;
+    detachVertexArrays();
+}
+
+// Switches back to the default vertex array object.  This must be done
+// before anything else modifies vertex attribute state, such as effects
+// enabling their attribute arrays or raw GL code, so that the cached
+// bindings in the vertex bundles stay intact.
+void QGLPainterPrivate::releaseVertexArray()
+{
+    if (!vertexArray)
+        return;
+    vertexArrayFuncs->bindVertexArray(0);
+    boundIndexBuffer = defaultIndexBuffer;
+    vertexArray = 0;
+}
+
+// Called by a vertex bundle that is being destroyed to delete its
+// vertex array object in this context.  If the context is not current,
+// the object is deleted by the next begin() instead.
+void QGLPainterPrivate::removeVertexArray(QGLVertexBundleVertexArray *vao)
+{
+    if (vertexArray == vao) {
+        // Deleting the bound object reverts to the default object.
+        vertexArray = 0;
+        boundIndexBuffer = defaultIndexBuffer;
+    }
+    if (context && QGLContext::currentContext() == context)
+        vertexArrayFuncs->deleteVertexArrays(1, &vao->id);
+    else if (context)
+        deletedVertexArrays.append(vao->id);
+    vertexArrays.removeOne(vao);
+    vao->bundle->vertexArrays.removeOne(vao);
+    delete vao;
+}
+
+// Forgets the vertex array objects of all vertex bundles when the
+// context is destroyed, which deletes the objects along with it.
+void QGLPainterPrivate::detachVertexArrays()
+{
+    for (int index = 0; index < vertexArrays.size(); ++index) {
+        QGLVertexBundleVertexArray *vao = vertexArrays[index];
+        vao->bundle->vertexArrays.removeOne(vao);
+        delete vao;
+    }
+    vertexArrays.clear();
+    deletedVertexArrays.clear();
+    vertexArray = 0;
+}
+
+// Called by QGLIndexBuffer after it has bound and released an index
+// buffer outside of QGLPainter to upload its contents.  The element
+// array binding is part of the state of the vertex array object that
+// is bound, so its cached binding is reset; the object stays bound.
+void QGLPainterPrivate::indexBufferReleased(const QGLContext *context)
+{
+    QGLPainterPrivate *priv =
+        QGLPainterPrivateCache::instance()->cache.value(context, 0);
+    if (!priv)
+        return;
+    priv->boundIndexBuffer = 0;
+    if (priv->vertexArray)
+        priv->vertexArray->indexBuffer = 0;
 }
 
 QGLPainterPickPrivate::QGLPainterPickPrivate()
@@ -216,6 +286,7 @@ void QGLPainterPrivateCache::contextDestroyed(const QGLContext *context)
 {
     QGLPainterPrivate *priv = cache.value(context, 0);
     if (priv) {
+        priv->detachVertexArrays();
         priv->context = 0;
         cache.remove(context);
         if (!priv->ref.deref())
@@ -391,6 +462,16 @@ bool QGLPainter::begin
 
     // Determine if the OpenGL implementation is fixed-function or not.
     d_ptr->isFixedFunction = !hasOpenGLFeature(QOpenGLFunctions::Shaders);
+
+    // Vertex array objects are used to cache vertex bundle bindings.
+    d_ptr->vertexArrayFuncs = qt_gl_vertexArrayExtensions(context);
+    // Delete the objects of vertex bundles that were destroyed while
+    // another context was current.
+    for (int index = 0; index < d_ptr->deletedVertexArrays.size(); ++index) {
+        GLuint id = d_ptr->deletedVertexArrays.at(index);
+        d_ptr->vertexArrayFuncs->deleteVertexArrays(1, &id);
+    }
+    d_ptr->deletedVertexArrays.clear();
     return true;
 }
 
@@ -474,7 +555,8 @@ bool QGLPainter::end()
     if (!d)
         return false;
 
-    // Unbind the current vertex and index buffers.
+    // Unbind the current vertex array and vertex and index buffers.
+    d->releaseVertexArray();
     if (d->boundVertexBuffer) {
         QGLBuffer::release(QGLBuffer::VertexBuffer);
         d->boundVertexBuffer = 0;
@@ -647,7 +729,8 @@ QMatrix4x4Stack& QGLPainter::modelViewMatrix()
 
     Calling this function is more efficient than calling
     projectionMatrix() and modelViewMatrix() separately and
-    multiplying the return values.
+    multiplying the return values.  The product is cached and is
+    only recomputed when one of the two matrices has changed.
 
     \sa projectionMatrix(), modelViewMatrix(), normalMatrix()
 */
@@ -658,7 +741,13 @@ QMatrix4x4 QGLPainter::combinedMatrix() const
         return QMatrix4x4();
     const QMatrix4x4StackPrivate *proj = d->projectionMatrix.d_func();
     const QMatrix4x4StackPrivate *mv = d->modelViewMatrix.d_func();
-    return proj->matrix * mv->matrix;
+    if (d->combinedProjectionGeneration != proj->generation ||
+            d->combinedModelViewGeneration != mv->generation) {
+        d->combinedMatrix = proj->matrix * mv->matrix;
+        d->combinedProjectionGeneration = proj->generation;
+        d->combinedModelViewGeneration = mv->generation;
+    }
+    return d->combinedMatrix;
 }
 
 // Inverting the eye transformation will often result in values like
@@ -728,6 +817,9 @@ QMatrix4x4 QGLPainter::worldMatrix() const
     3x3 part of the 4x4 modelview matrix.  If the 3x3 sub-matrix is not
     invertible, this function returns the identity.
 
+    The inverse-transpose is cached and is only recomputed when the
+    modelview matrix has changed.
+
     \sa modelViewMatrix(), combinedMatrix()
 */
 QMatrix3x3 QGLPainter::normalMatrix() const
@@ -736,7 +828,11 @@ QMatrix3x3 QGLPainter::normalMatrix() const
     if (!d)
         return QMatrix3x3();
     const QMatrix4x4StackPrivate *mv = d->modelViewMatrix.d_func();
-    return mv->matrix.normalMatrix();
+    if (d->normalMatrixGeneration != mv->generation) {
+        d->normalMatrix = mv->matrix.normalMatrix();
+        d->normalMatrixGeneration = mv->generation;
+    }
+    return d->normalMatrix;
 }
 
 /*!
@@ -927,6 +1023,7 @@ void QGLPainter::setUserEffect(QGLAbstractEffect *effect)
     QGLPAINTER_CHECK_PRIVATE();
     if (d->userEffect == effect)
         return;
+    d->releaseVertexArray();
     if (d->effect)
         d->effect->setActive(this, false);
     d->userEffect = effect;
@@ -968,6 +1065,7 @@ void QGLPainter::setStandardEffect(QGL::StandardEffect effect)
     QGLPAINTER_CHECK_PRIVATE();
     if (d->standardEffect == effect && d->effect && d->userEffect == 0)
         return;
+    d->releaseVertexArray();
     if (d->effect)
         d->effect->setActive(this, false);
     d->standardEffect = effect;
@@ -993,6 +1091,7 @@ void QGLPainter::disableEffect()
 {
     Q_D(QGLPainter);
     QGLPAINTER_CHECK_PRIVATE();
+    d->releaseVertexArray();
     if (d->effect)
         d->effect->setActive(this, false);
     d->userEffect = 0;
@@ -1046,6 +1145,7 @@ void QGLPainter::setCachedProgram
 
 void QGLPainterPrivate::createEffect(QGLPainter *painter)
 {
+    releaseVertexArray();
     if (userEffect) {
         if (!pick || !pick->isPicking) {
             effect = userEffect;
@@ -1216,6 +1316,10 @@ QGLAttributeSet QGLPainter::attributes() const
     painter state by setVertexAttribute() and setVertexBundle().
     See the documentation for attributes() for more information.
 
+    Any vertex array object that was bound by setVertexBundle() stays
+    bound, so that drawing the same vertex bundle again does not need
+    to bind it again.
+
     \sa attributes()
 */
 void QGLPainter::clearAttributes()
@@ -1250,6 +1354,7 @@ void QGLPainter::setVertexAttribute
     Q_D(QGLPainter);
     QGLPAINTER_CHECK_PRIVATE();
     d->ensureEffect(this);
+    d->releaseVertexArray();
     if (d->boundVertexBuffer) {
         QGLBuffer::release(QGLBuffer::VertexBuffer);
         d->boundVertexBuffer = 0;
@@ -1280,6 +1385,13 @@ void QGLPainter::setVertexAttribute
     being provided and that the previous geometry is now invalid.
     See the documentation for attributes() for more information.
 
+    If \a buffer has been uploaded and the GL server supports vertex
+    array objects, then the attribute bindings are recorded in a vertex
+    array object the first time the bundle is set on the painter, and
+    later calls only need to bind that object.  All attributes of the
+    bundle are enabled within the vertex array object, independent of
+    the attributes used by the effect().
+
     \sa setVertexAttribute(), draw(), clearAttributes(), attributes()
 */
 void QGLPainter::setVertexBundle(const QGLVertexBundle& buffer)
@@ -1288,6 +1400,51 @@ void QGLPainter::setVertexBundle(const QGLVertexBundle& buffer)
     QGLPAINTER_CHECK_PRIVATE();
     d->ensureEffect(this);
     QGLVertexBundlePrivate *bd = const_cast<QGLVertexBundlePrivate *>(buffer.d_func());
+    if (!d->isFixedFunction && bd->buffer.isCreated() &&
+            d->vertexArrayFuncs && d->vertexArrayFuncs->hasVertexArrays()) {
+        QGLVertexBundleVertexArray *vao = bd->findVertexArray(d);
+        if (vao && vao == d->vertexArray) {
+            // Drawing the same bundle again, the object is still bound.
+            d->attributeSet.unite(buffer.attributes());
+            return;
+        }
+        bool created = false;
+        if (!vao) {
+            GLuint id = 0;
+            d->vertexArrayFuncs->genVertexArrays(1, &id);
+            if (id) {
+                vao = new QGLVertexBundleVertexArray(bd, d, id);
+                bd->vertexArrays.append(vao);
+                d->vertexArrays.append(vao);
+                created = true;
+            }
+        }
+        if (vao) {
+            if (!d->vertexArray)
+                d->defaultIndexBuffer = d->boundIndexBuffer;
+            d->vertexArrayFuncs->bindVertexArray(vao->id);
+            d->vertexArray = vao;
+            d->boundIndexBuffer = vao->indexBuffer;
+            if (created) {
+                // Record the attribute bindings in the new vertex array
+                // object.  The buffer is bound explicitly, because uploads
+                // may have changed the binding behind the painter's back.
+                bd->buffer.bind();
+                d->boundVertexBuffer = bd->buffer.bufferId();
+                for (int index = 0; index < bd->attributes.size(); ++index) {
+                    QGLVertexBundleAttribute *attr = bd->attributes[index];
+                    glEnableVertexAttribArray(GLuint(attr->attribute));
+                    glVertexAttribPointer(GLuint(attr->attribute),
+                                          attr->value.tupleSize(),
+                                          attr->value.type(), GL_TRUE,
+                                          attr->value.stride(), attr->value.data());
+                }
+            }
+            d->attributeSet.unite(buffer.attributes());
+            return;
+        }
+    }
+    d->releaseVertexArray();
     if (bd->buffer.isCreated()) {
         GLuint id = bd->buffer.bufferId();
         if (id != d->boundVertexBuffer) {
@@ -1340,14 +1497,22 @@ void QGLPainter::update()
     d->ensureEffect(this);
     QGLPainter::Updates updates = d->updates;
     d->updates = 0;
+    // A matrix stack that was modified and then popped back to the
+    // value that the effect already has does not need to be sent again.
     if (d->modelViewMatrix.isDirty()) {
-        updates |= UpdateModelViewMatrix;
+        if (d->modelViewMatrix.generation() != d->updatedModelViewGeneration)
+            updates |= UpdateModelViewMatrix;
         d->modelViewMatrix.setDirty(false);
     }
     if (d->projectionMatrix.isDirty()) {
-        updates |= UpdateProjectionMatrix;
+        if (d->projectionMatrix.generation() != d->updatedProjectionGeneration)
+            updates |= UpdateProjectionMatrix;
         d->projectionMatrix.setDirty(false);
     }
+    if ((updates & UpdateModelViewMatrix) != 0)
+        d->updatedModelViewGeneration = d->modelViewMatrix.generation();
+    if ((updates & UpdateProjectionMatrix) != 0)
+        d->updatedProjectionGeneration = d->projectionMatrix.generation();
     if ((updates & UpdateViewport) != 0) {
         QRect viewport = currentSurface()->viewportGL();
         glViewport(viewport.x(), viewport.y(),
@@ -1608,6 +1773,8 @@ void QGLPainter::draw(QGL::DrawingMode mode, const ushort *indices, int count)
     if (d->boundIndexBuffer) {
         QGLBuffer::release(QGLBuffer::IndexBuffer);
         d->boundIndexBuffer = 0;
+        if (d->vertexArray)
+            d->vertexArray->indexBuffer = 0;
     }
     glDrawElements(GLenum(mode), count, GL_UNSIGNED_SHORT, indices);
 }
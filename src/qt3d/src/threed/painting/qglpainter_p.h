@@ -62,6 +62,9 @@
 
 QT_BEGIN_NAMESPACE
 
+class QGLVertexArrayExtensions;
+class QGLVertexBundleVertexArray;
+
 #define QGL_MAX_LIGHTS      32
 #define QGL_MAX_STD_EFFECTS 16
 
@@ -116,6 +119,13 @@ public:
     QBox3D viewingCube;
     QColor color;
     QGLPainter::Updates updates;
+    uint updatedModelViewGeneration;
+    uint updatedProjectionGeneration;
+    mutable QMatrix4x4 combinedMatrix;
+    mutable uint combinedModelViewGeneration;
+    mutable uint combinedProjectionGeneration;
+    mutable QMatrix3x3 normalMatrix;
+    mutable uint normalMatrixGeneration;
     QGLPainterPickPrivate *pick;
     QMap<QString, QGLShaderProgram *> cachedPrograms;
     QStack<QGLPainterSurfaceInfo> surfaceStack;
@@ -124,10 +134,20 @@ public:
     QGLRenderSequencer *renderSequencer;
     bool isFixedFunction;
     QGLAttributeSet attributeSet;
+    QGLVertexArrayExtensions *vertexArrayFuncs;
+    QList<QGLVertexBundleVertexArray *> vertexArrays;
+    QList<GLuint> deletedVertexArrays;
+    QGLVertexBundleVertexArray *vertexArray;
+    GLuint defaultIndexBuffer;
 
     inline void ensureEffect(QGLPainter *painter)
         { if (!effect) createEffect(painter); }
     void createEffect(QGLPainter *painter);
+    void releaseVertexArray();
+    void removeVertexArray(QGLVertexBundleVertexArray *vao);
+    void detachVertexArrays();
+
+    static void indexBufferReleased(const QGLContext *context);
 };
 
 class QGLPainterPrivateCache : public QObject
@@ -137,6 +137,7 @@ void QMatrix4x4Stack::push()
 {
     Q_D(QMatrix4x4Stack);
     d->stack.push(d->matrix);
+    d->generationStack.push(d->generation);
 }
 
 /*!
@@ -149,8 +150,10 @@ void QMatrix4x4Stack::push()
 void QMatrix4x4Stack::pop()
 {
     Q_D(QMatrix4x4Stack);
-    if (!d->stack.isEmpty())
+    if (!d->stack.isEmpty()) {
         d->matrix = d->stack.pop();
+        d->generation = d->generationStack.pop();
+    }
     d->isDirty = true;
 }
 
@@ -163,7 +166,7 @@ void QMatrix4x4Stack::setToIdentity()
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.setToIdentity();
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -197,7 +200,7 @@ QMatrix4x4Stack& QMatrix4x4Stack::operator=(const QMatrix4x4& matrix)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix = matrix;
-    d->isDirty = true;
+    d->changed();
     return *this;
 }
 
@@ -210,7 +213,7 @@ QMatrix4x4Stack& QMatrix4x4Stack::operator*=(const QMatrix4x4& matrix)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix *= matrix;
-    d->isDirty = true;
+    d->changed();
     return *this;
 }
 
@@ -230,7 +233,7 @@ void QMatrix4x4Stack::translate(qreal x, qreal y, qreal z)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.translate(x, y, z);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -243,7 +246,7 @@ void QMatrix4x4Stack::translate(const QVector3D& vector)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.translate(vector);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -262,7 +265,7 @@ void QMatrix4x4Stack::scale(qreal x, qreal y, qreal z)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.scale(x, y, z);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -281,7 +284,7 @@ void QMatrix4x4Stack::scale(qreal factor)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.scale(factor);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -294,7 +297,7 @@ void QMatrix4x4Stack::scale(const QVector3D& vector)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.scale(vector);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -314,7 +317,7 @@ void QMatrix4x4Stack::rotate(qreal angle, qreal x, qreal y, qreal z)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.rotate(angle, x, y, z);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -327,7 +330,7 @@ void QMatrix4x4Stack::rotate(qreal angle, const QVector3D& vector)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.rotate(angle, vector);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -347,7 +350,7 @@ void QMatrix4x4Stack::rotate(const QQuaternion &quaternion)
 {
     Q_D(QMatrix4x4Stack);
     d->matrix.rotate(quaternion);
-    d->isDirty = true;
+    d->changed();
 }
 
 /*!
@@ -374,7 +377,31 @@ bool QMatrix4x4Stack::isDirty() const
 void QMatrix4x4Stack::setDirty(bool dirty)
 {
     Q_D(QMatrix4x4Stack);
-    d->isDirty = dirty;
+    if (dirty)
+        d->changed();
+    else
+        d->isDirty = false;
+}
+
+/*!
+    Returns the generation number of the matrix at the top of this
+    matrix stack.
+
+    The generation changes every time the top of the stack is given
+    a new value by translate(), scale(), operator=(), etc.  Popping the
+    stack restores the generation of the matrix that was saved by push(),
+    so two equal generation numbers always refer to the same matrix value.
+    QGLPainter uses this to avoid recomputing derived values such as
+    the combined and normal matrices when their inputs have not changed.
+
+    Setting the dirty flag with setDirty() also starts a new generation.
+
+    \sa isDirty()
+*/
+uint QMatrix4x4Stack::generation() const
+{
+    Q_D(const QMatrix4x4Stack);
+    return d->generation;
 }
 
 QT_END_NAMESPACE
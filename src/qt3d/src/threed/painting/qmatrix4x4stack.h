@@ -84,6 +84,8 @@ public:
     bool isDirty() const;
     void setDirty(bool dirty);
 
+    uint generation() const;
+
 private:
     Q_DISABLE_COPY(QMatrix4x4Stack)
     Q_DECLARE_PRIVATE(QMatrix4x4Stack)
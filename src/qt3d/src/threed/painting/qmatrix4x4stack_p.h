@@ -63,11 +63,24 @@ QT_BEGIN_NAMESPACE
 class QMatrix4x4StackPrivate
 {
 public:
-    QMatrix4x4StackPrivate() : isDirty(true) {}
+    QMatrix4x4StackPrivate()
+        : isDirty(true), generation(1), nextGeneration(2) {}
 
     QMatrix4x4 matrix;
     QStack<QMatrix4x4> stack;
+    QStack<uint> generationStack;
     bool isDirty;
+    uint generation;
+    uint nextGeneration;
+
+    // Every new matrix value gets a fresh generation number so that
+    // values derived from it can be cached by the painter.  pop()
+    // restores the generation that was saved by push().
+    inline void changed()
+    {
+        isDirty = true;
+        generation = nextGeneration++;
+    }
 };
 
 QT_END_NAMESPACE
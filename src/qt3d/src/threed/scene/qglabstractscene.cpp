@@ -42,6 +42,7 @@
 #include "qglabstractscene.h"
 #include "qglsceneformatplugin.h"
 #include "qglpicknode.h"
+#include "qglsceneloader.h"
 
 // copied private header
 #include "qfactoryloader_p.h"
@@ -58,6 +59,7 @@
 #include <QBuffer>
 
 #include "qt3d/src/plugins/sceneformats/assimp/qaiscenehandler.h"
+#include "qt3d/src/plugins/sceneformats/mesh/qglmeshscenehandler.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -370,6 +372,7 @@ QGLAbstractScene *QGLAbstractScene::loadScene
 
     // If the format is not specified, then use the filename/url extension.
     QString fmt = format;
+    QString suffix;
     if (fmt.isEmpty()) {
         //First try to resolve a file io device
         QFile *file = qobject_cast<QFile *>(device);
@@ -387,13 +390,18 @@ QGLAbstractScene *QGLAbstractScene::loadScene
             }
         }
         int dot = name.lastIndexOf(QLatin1Char('.'));
-        QString suffix = name.mid(dot+1).toLower();
+        suffix = name.mid(dot+1).toLower();
         int index = keys.indexOf(suffix);
         if (index >= 0)
             fmt = suffix;
     }
 
-    QGLSceneFormatHandler *handler = new QAiSceneHandler;
+    // Binary meshes are read directly, everything else goes through Assimp.
+    QGLSceneFormatHandler *handler;
+    if (fmt == QLatin1String("qmesh") || suffix == QLatin1String("qmesh"))
+        handler = new QGLMeshSceneHandler;
+    else
+        handler = new QAiSceneHandler;
     if (handler) {
         handler->setDevice(device);
         handler->setUrl(url);
@@ -537,6 +545,25 @@ QGLAbstractScene *QGLAbstractScene::loadScene
     }
 }
 
+/*!
+    Starts loading a scene from \a fileName in the specified \a format,
+    with the supplied \a options, on a background thread and returns
+    a loader that tracks the load.  The loader is attached to \a parent.
+
+    The arguments have the same meaning as for loadScene().  Once the
+    loader emits QGLSceneLoader::finished() the scene can be claimed
+    with QGLSceneLoader::takeScene(), which returns null if the scene
+    could not be loaded.
+
+    \sa QGLSceneLoader
+*/
+QGLSceneLoader *QGLAbstractScene::loadSceneAsync
+    (const QString& fileName, const QString& format, const QString &options,
+     QObject *parent)
+{
+    return new QGLSceneLoader(fileName, format, options, parent);
+}
+
 /*!
     \enum QGLAbstractScene::FormatListType
     This enum specifies the format of the list returned by the supportedFormats() function.
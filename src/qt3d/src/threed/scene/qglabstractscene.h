@@ -58,6 +58,7 @@ QT_MODULE(Qt3D)
 class QGLAbstractScenePrivate;
 class QIODevice;
 class QGLPickNode;
+class QGLSceneLoader;
 
 class Q_QT3D_EXPORT QGLAbstractScene : public QObject
 {
@@ -86,6 +87,9 @@ public:
     static QGLAbstractScene *loadScene
         (const QString& fileName, const QString& format = QString(),
      const QString& options = QString());
+    static QGLSceneLoader *loadSceneAsync
+        (const QString& fileName, const QString& format = QString(),
+        const QString& options = QString(), QObject *parent = 0);
 
     enum FormatListType {
         AsFilter, AsSuffix
@@ -0,0 +1,400 @@
+/****************************************************************************
+**
+** Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+** All rights reserved.
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** This file is part of the QtQuick3D module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** GNU Lesser General Public License Usage
+** This file may be used under the terms of the GNU Lesser General Public
+** License version 2.1 as published by the Free Software Foundation and
+** appearing in the file LICENSE.LGPL included in the packaging of this
+** file. Please review the following information to ensure the GNU Lesser
+** General Public License version 2.1 requirements will be met:
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Nokia gives you certain additional
+** rights. These rights are described in the Nokia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU General
+** Public License version 3.0 as published by the Free Software Foundation
+** and appearing in the file LICENSE.GPL included in the packaging of this
+** file. Please review the following information to ensure the GNU General
+** Public License version 3.0 requirements will be met:
+** http://www.gnu.org/copyleft/gpl.html.
+**
+** Other Usage
+** Alternatively, this file may be used in accordance with the terms and
+** conditions contained in a signed written agreement between you and Nokia.
+**
+**
+**
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qglsceneloader.h"
+#include "qglabstractscene.h"
+#include "qglmaterialcollection.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qset.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qurl.h>
+#include <QtCore/qwaitcondition.h>
+#include <QtCore/qdebug.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QGLSceneLoader
+    \brief The QGLSceneLoader class tracks a scene being loaded in the background.
+    \since 4.8
+    \ingroup qt3d
+    \ingroup qt3d::scene
+
+    Loaders are created with QGLAbstractScene::loadSceneAsync().  The
+    file is read, parsed and converted into scene nodes on a worker
+    thread, so the thread that requested the scene is free to keep
+    rendering in the meantime.  When the load completes the finished()
+    signal is emitted and the scene can be claimed with takeScene().
+
+    \code
+    QGLSceneLoader *loader = QGLAbstractScene::loadSceneAsync(fileName);
+    connect(loader, SIGNAL(finished()), this, SLOT(sceneLoaded()));
+    \endcode
+
+    The scene and all of its nodes, materials and textures are owned by
+    the thread that created the loader by the time finished() is
+    emitted.  No GL calls are made while loading: textures and vertex
+    buffers are uploaded the first time the scene is drawn, as they
+    are for scenes loaded with QGLAbstractScene::loadScene().
+
+    Loads are run one at a time in the order they were requested, as
+    the underlying importers keep global state.  Only local files and
+    resources can be loaded in the background; network URLs are already
+    loaded asynchronously by QGLAbstractScene::loadScene().
+
+    \sa QGLAbstractScene
+*/
+
+/*!
+    \fn void QGLSceneLoader::progressChanged(int progress)
+
+    This signal is emitted when the load \a progress, in percent,
+    advances.
+
+    \sa progress()
+*/
+
+/*!
+    \fn void QGLSceneLoader::finished()
+
+    This signal is emitted once when the load has completed, has failed
+    or has been canceled.
+
+    \sa isFinished(), takeScene()
+*/
+
+Q_GLOBAL_STATIC_WITH_INITIALIZER(QThreadPool, sceneLoaderPool, {
+    x->setMaxThreadCount(1);
+})
+
+// Shared between the loader and its worker task, so that either one can
+// go away first.
+class QGLSceneLoaderState
+{
+public:
+    QGLSceneLoaderState()
+        : loader(0), thread(0), scene(0), done(false), canceled(false) {}
+    QMutex mutex;
+    QWaitCondition doneCondition;
+    QGLSceneLoader *loader;
+    QThread *thread;
+    QGLAbstractScene *scene;
+    bool done;
+    bool canceled;
+};
+
+class QGLSceneLoaderPrivate
+{
+public:
+    QGLSceneLoaderPrivate()
+        : progress(0), finished(false) {}
+    QString fileName;
+    int progress;
+    bool finished;
+    QSharedPointer<QGLSceneLoaderState> state;
+};
+
+static QObject *topLevelObject(QObject *object)
+{
+    while (object->parent())
+        object = object->parent();
+    return object;
+}
+
+// Hands the scene over to \a thread.  Scene nodes, palettes and the
+// scene itself are not necessarily parented to each other, so each
+// distinct object tree is moved separately.
+static void moveSceneToThread(QGLAbstractScene *scene, QThread *thread)
+{
+    QSet<QObject *> roots;
+    roots.insert(topLevelObject(scene));
+    QList<QGLSceneNode *> nodes;
+    if (scene->mainNode()) {
+        nodes.append(scene->mainNode());
+        nodes += scene->mainNode()->allChildren();
+    }
+    QList<QGLSceneNode *>::const_iterator it = nodes.constBegin();
+    for ( ; it != nodes.constEnd(); ++it) {
+        roots.insert(topLevelObject(*it));
+        if ((*it)->palette())
+            roots.insert(topLevelObject((*it)->palette()));
+    }
+    QList<QObject *> objects = scene->objects();
+    for (int index = 0; index < objects.size(); ++index)
+        roots.insert(topLevelObject(objects.at(index)));
+
+    QSet<QObject *>::const_iterator root = roots.constBegin();
+    for ( ; root != roots.constEnd(); ++root)
+        (*root)->moveToThread(thread);
+}
+
+class QGLSceneLoadTask : public QRunnable
+{
+public:
+    QGLSceneLoadTask(const QSharedPointer<QGLSceneLoaderState> &state,
+                     const QString &fileName, const QString &format,
+                     const QString &options)
+        : m_state(state), m_fileName(fileName), m_format(format)
+        , m_options(options) {}
+
+    void run();
+
+private:
+    bool reportProgress(int progress);
+    void finish(QGLAbstractScene *scene);
+
+    QSharedPointer<QGLSceneLoaderState> m_state;
+    QString m_fileName;
+    QString m_format;
+    QString m_options;
+};
+
+/*!
+    \internal
+    The importers do not report fractional progress and cannot be
+    interrupted, so progress is reported per phase and cancellation
+    is honored before and after the import.
+*/
+void QGLSceneLoadTask::run()
+{
+    if (!reportProgress(10)) {
+        finish(0);
+        return;
+    }
+    QGLAbstractScene *scene =
+        QGLAbstractScene::loadScene(m_fileName, m_format, m_options);
+    reportProgress(90);
+    finish(scene);
+}
+
+bool QGLSceneLoadTask::reportProgress(int progress)
+{
+    QMutexLocker locker(&m_state->mutex);
+    if (!m_state->loader || m_state->canceled)
+        return false;
+    QMetaObject::invokeMethod(m_state->loader, "updateProgress",
+                              Qt::QueuedConnection, Q_ARG(int, progress));
+    return true;
+}
+
+void QGLSceneLoadTask::finish(QGLAbstractScene *scene)
+{
+    QMutexLocker locker(&m_state->mutex);
+    if (scene && (!m_state->loader || m_state->canceled)) {
+        delete scene;
+        scene = 0;
+    }
+    if (scene)
+        moveSceneToThread(scene, m_state->thread);
+    m_state->scene = scene;
+    m_state->done = true;
+    m_state->doneCondition.wakeAll();
+    if (m_state->loader) {
+        QMetaObject::invokeMethod(m_state->loader, "complete",
+                                  Qt::QueuedConnection);
+    }
+}
+
+/*!
+    \internal
+    Starts loading \a fileName on the scene loader thread pool.  Use
+    QGLAbstractScene::loadSceneAsync() to create loaders.
+*/
+QGLSceneLoader::QGLSceneLoader(const QString &fileName, const QString &format,
+                               const QString &options, QObject *parent)
+    : QObject(parent)
+    , d_ptr(new QGLSceneLoaderPrivate)
+{
+    Q_D(QGLSceneLoader);
+    d->fileName = fileName;
+    d->state = QSharedPointer<QGLSceneLoaderState>(new QGLSceneLoaderState);
+    d->state->loader = this;
+    d->state->thread = thread();
+
+    QUrl url(fileName);
+    if (url.scheme() == QLatin1String("http") ||
+            url.scheme() == QLatin1String("ftp")) {
+        qWarning("QGLSceneLoader: cannot load %s in the background, "
+                 "use QGLAbstractScene::loadScene() for network URLs",
+                 qPrintable(fileName));
+        d->state->done = true;
+        QMetaObject::invokeMethod(this, "complete", Qt::QueuedConnection);
+        return;
+    }
+
+    sceneLoaderPool()->start
+        (new QGLSceneLoadTask(d->state, fileName, format, options));
+}
+
+/*!
+    Destroys this loader.  If the load is still in progress its result
+    is discarded once the worker completes, and a scene that was loaded
+    but not taken with takeScene() is deleted.
+*/
+QGLSceneLoader::~QGLSceneLoader()
+{
+    Q_D(QGLSceneLoader);
+    QMutexLocker locker(&d->state->mutex);
+    d->state->loader = 0;
+    if (d->state->done) {
+        delete d->state->scene;
+        d->state->scene = 0;
+    }
+}
+
+/*!
+    Returns the name of the file that is being loaded.
+*/
+QString QGLSceneLoader::fileName() const
+{
+    Q_D(const QGLSceneLoader);
+    return d->fileName;
+}
+
+/*!
+    Returns the load progress in percent, 100 once the loader has
+    finished.
+
+    \sa progressChanged()
+*/
+int QGLSceneLoader::progress() const
+{
+    Q_D(const QGLSceneLoader);
+    return d->progress;
+}
+
+/*!
+    Returns true if the finished() signal has been emitted.
+
+    \sa waitForFinished()
+*/
+bool QGLSceneLoader::isFinished() const
+{
+    Q_D(const QGLSceneLoader);
+    return d->finished;
+}
+
+/*!
+    Returns true if cancel() has been called.
+*/
+bool QGLSceneLoader::isCanceled() const
+{
+    Q_D(const QGLSceneLoader);
+    QMutexLocker locker(&d->state->mutex);
+    return d->state->canceled;
+}
+
+/*!
+    Returns the loaded scene and transfers its ownership to the caller.
+    Returns null if the loader has not finished, if the scene could not
+    be loaded, if the load was canceled, or if the scene has already
+    been taken.
+*/
+QGLAbstractScene *QGLSceneLoader::takeScene()
+{
+    Q_D(QGLSceneLoader);
+    QMutexLocker locker(&d->state->mutex);
+    QGLAbstractScene *scene = d->state->scene;
+    d->state->scene = 0;
+    return scene;
+}
+
+/*!
+    Blocks until the load has completed and emits finished() if it has
+    not been emitted yet.  This is useful when the scene is needed
+    before the background load would normally have been picked up.
+*/
+void QGLSceneLoader::waitForFinished()
+{
+    Q_D(QGLSceneLoader);
+    {
+        QMutexLocker locker(&d->state->mutex);
+        while (!d->state->done)
+            d->state->doneCondition.wait(&d->state->mutex);
+    }
+    complete();
+}
+
+/*!
+    Cancels the load.  A load that has not yet started is skipped, and
+    the result of a load that is already running is discarded.  The
+    finished() signal is still emitted.
+*/
+void QGLSceneLoader::cancel()
+{
+    Q_D(QGLSceneLoader);
+    QMutexLocker locker(&d->state->mutex);
+    d->state->canceled = true;
+}
+
+/*!
+    \internal
+*/
+void QGLSceneLoader::updateProgress(int progress)
+{
+    Q_D(QGLSceneLoader);
+    if (d->finished || progress <= d->progress)
+        return;
+    d->progress = progress;
+    emit progressChanged(progress);
+}
+
+/*!
+    \internal
+*/
+void QGLSceneLoader::complete()
+{
+    Q_D(QGLSceneLoader);
+    if (d->finished)
+        return;
+    d->finished = true;
+    if (d->progress < 100) {
+        d->progress = 100;
+        emit progressChanged(100);
+    }
+    emit finished();
+}
+
+QT_END_NAMESPACE
@@ -3,6 +3,7 @@ VPATH += $$PWD
 HEADERS += qglabstractscene.h \
     qglsceneformatplugin.h \
     qglscenenode.h \
+    qglsceneloader.h \
     qglpicknode.h \
     qglrendersequencer.h \
     qglrenderorder.h \
@@ -11,6 +12,7 @@ HEADERS += qglabstractscene.h \
 SOURCES += qglabstractscene.cpp \
     qglsceneformatplugin.cpp \
     qglscenenode.cpp \
+    qglsceneloader.cpp \
     qglpicknode.cpp \
     qglrendersequencer.cpp \
     qglrenderorder.cpp \
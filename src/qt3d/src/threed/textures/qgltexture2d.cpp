@@ -320,6 +320,13 @@ void QGLTexture2D::clearImage()
     supported, assuming that the GL implementation has the
     appropriate extension.
 
+    Cooked texture containers (\c{.qtex}), which hold the same texture
+    in several of these encodings, each with a precomputed mipmap chain,
+    are also supported.  The first encoding in the container that the GL
+    implementation of the current context supports is uploaded as-is.
+    If there is none, false is returned so that the caller can load an
+    image file instead.
+
     \sa setImage(), setSize()
 */
 bool QGLTexture2D::setCompressedFile(const QString &path)
@@ -400,7 +407,8 @@ void QGLTexture2D::setUrl(const QUrl &url)
                 fileName = QLatin1String(":")+tempUrl.toString();
             }
 
-            if (fileName.endsWith(QLatin1String(".dds"), Qt::CaseInsensitive))
+            if (fileName.endsWith(QLatin1String(".dds"), Qt::CaseInsensitive) ||
+                    fileName.endsWith(QLatin1String(".qtex"), Qt::CaseInsensitive))
             {
                 setCompressedFile(fileName);
             }
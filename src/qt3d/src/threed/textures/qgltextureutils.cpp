@@ -460,6 +460,7 @@ struct PvrHeader
 #define PVR_FORMAT_PVRTC2       0x00000018
 #define PVR_FORMAT_PVRTC4       0x00000019
 #define PVR_FORMAT_ETC1         0x00000036
+#define PVR_FORMAT_RGBA8888     0x00000012
 
 #define PVR_HAS_MIPMAPS         0x00000100
 #define PVR_TWIDDLED            0x00000200
@@ -482,6 +483,84 @@ struct PvrHeader
 #define GL_ETC1_RGB8_OES                        0x8D64
 #endif
 
+// Container for cooked textures, which stores the same texture in several
+// encodings with precomputed mipmaps.  Each entry is a complete DDS or PVR
+// image, flipped so that the first row is the bottom of the texture.  The
+// entries are ordered by preference, and the first one that the GL server
+// supports is uploaded.  An uncompressed RGBA entry may be last, but is
+// normally left out in favour of a separate image file as the fallback.
+struct CookedTextureHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 flags;
+    quint32 entryCount;
+};
+
+struct CookedTextureEntry
+{
+    quint32 encoding;
+    quint32 offset;
+    quint32 size;
+};
+
+#define COOKED_VERSION          1
+#define COOKED_HAS_ALPHA        0x00000001
+
+#define COOKED_ENCODING_ETC1    0x31435445      // "ETC1" in little-endian
+#define COOKED_ENCODING_DXT1    FOURCC_DXT1
+#define COOKED_ENCODING_DXT5    FOURCC_DXT5
+#define COOKED_ENCODING_RGBA    0x41424752      // "RGBA" in little-endian
+
+// Returns the first entry of the cooked texture in buf that the GL server
+// described by extensions supports, or null if there is none or the container
+// is not valid.  Without extensions any valid entry is returned.
+static const CookedTextureEntry *qt_gl_findCookedTextureEntry
+    (const char *buf, int len, const QGLTextureExtensions *extensions)
+{
+    const CookedTextureHeader *header =
+        reinterpret_cast<const CookedTextureHeader *>(buf);
+    if (header->version != COOKED_VERSION)
+        return 0;
+
+    // Check the entry count against the size before computing the end of
+    // the entry table, so that a corrupt count cannot wrap it around.
+    quint32 maxEntries = (quint32(len) - sizeof(CookedTextureHeader)) /
+                         sizeof(CookedTextureEntry);
+    if (header->entryCount > maxEntries)
+        return 0;
+    quint32 entriesEnd = sizeof(CookedTextureHeader) +
+                         header->entryCount * sizeof(CookedTextureEntry);
+
+    bool compressed = extensions && extensions->compressedTexImage2D != 0;
+    const CookedTextureEntry *entries =
+        reinterpret_cast<const CookedTextureEntry *>(header + 1);
+    for (quint32 index = 0; index < header->entryCount; ++index) {
+        const CookedTextureEntry &entry = entries[index];
+        if (entry.offset < entriesEnd || entry.size > quint32(len) ||
+                entry.offset > quint32(len) - entry.size)
+            continue;
+        switch (entry.encoding) {
+        case COOKED_ENCODING_ETC1:
+            if (!extensions ||
+                    (compressed && extensions->etc1TextureCompression))
+                return &entry;
+            break;
+        case COOKED_ENCODING_DXT1:
+        case COOKED_ENCODING_DXT5:
+            if (!extensions ||
+                    (compressed && extensions->ddsTextureCompression))
+                return &entry;
+            break;
+        case COOKED_ENCODING_RGBA:
+            return &entry;
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
 bool QGLBoundTexture::canBindCompressedTexture
     (const char *buf, int len, const char *format, bool *hasAlpha,
      bool *isFlipped)
@@ -491,6 +570,17 @@ bool QGLBoundTexture::canBindCompressedTexture
         // systems such as x86 and ARM at the moment.
         return false;
     }
+    if (len >= int(sizeof(CookedTextureHeader)) && !qstrncmp(buf, "QTEX", 4) &&
+            (!format || !qstricmp(format, "QTEX"))) {
+        const CookedTextureHeader *cookedHeader =
+            reinterpret_cast<const CookedTextureHeader *>(buf);
+        *hasAlpha = ((cookedHeader->flags & COOKED_HAS_ALPHA) != 0);
+        *isFlipped = true;
+        // Refuse containers with no encoding for the current context, so
+        // that the caller can fall back to an image file instead.
+        return qt_gl_findCookedTextureEntry
+            (buf, len, QGLTextureExtensions::extensions()) != 0;
+    }
     if (!format) {
         // Auto-detect the format from the header.
         if (len >= 4 && !qstrncmp(buf, "DDS ", 4)) {
@@ -533,6 +623,10 @@ bool QGLBoundTexture::bindCompressedTexture
         // systems such as x86 and ARM at the moment.
         return false;
     }
+    // Cooked textures check the extensions for each of their encodings.
+    if (len >= int(sizeof(CookedTextureHeader)) && !qstrncmp(buf, "QTEX", 4) &&
+            (!format || !qstricmp(format, "QTEX")))
+        return bindCompressedTextureCooked(buf, len);
 #if !defined(QT_OPENGL_ES)
     QGLTextureExtensions *extensions = QGLTextureExtensions::extensions();
     if (!extensions)
@@ -623,7 +717,10 @@ bool QGLBoundTexture::bindCompressedTextureDDS(const char *buf, int len)
     glGenTextures(1, &id);
     glBindTexture(GL_TEXTURE_2D, id);
     q_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    q_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    if (ddsHeader->dwMipMapCount > 1)
+        q_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    else
+        q_glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     m_resource.attach(QGLContext::currentContext(), id);
 
     int size;
@@ -654,7 +751,7 @@ bool QGLBoundTexture::bindCompressedTextureDDS(const char *buf, int len)
     m_options &= ~QGLContext::InvertedYBindOption;
 
     m_size = QSize(ddsHeader->dwWidth, ddsHeader->dwHeight);
-    m_hasAlpha = false;
+    m_hasAlpha = (format != GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
     return true;
 }
 
@@ -693,6 +790,12 @@ bool QGLBoundTexture::bindCompressedTexturePVR(const char *buf, int len)
         minHeight = 4;
         break;
 
+    case PVR_FORMAT_RGBA8888:
+        textureFormat = GL_RGBA;
+        minWidth = 1;
+        minHeight = 1;
+        break;
+
     default:
         qWarning("QGLBoundTexture::bindCompressedTexturePVR(): PVR image format 0x%x not supported.", int(pvrHeader->flags & PVR_FORMAT_MASK));
         return false;
@@ -704,7 +807,7 @@ bool QGLBoundTexture::bindCompressedTexturePVR(const char *buf, int len)
             qWarning("QGLBoundTexture::bindCompressedTexturePVR(): ETC1 texture compression is not supported.");
             return false;
         }
-    } else {
+    } else if (textureFormat != GL_RGBA) {
         if (!extensions->pvrtcTextureCompression) {
             qWarning("QGLBoundTexture::bindCompressedTexturePVR(): PVRTC texture compression is not supported.");
             return false;
@@ -758,11 +861,20 @@ bool QGLBoundTexture::bindCompressedTexturePVR(const char *buf, int len)
              pvrHeader->bitsPerPixel) / 8;
         if (size > bufferSize)
             break;
-        extensions->compressedTexImage2D
-            (GL_TEXTURE_2D, GLint(level), textureFormat,
-             GLsizei(width), GLsizei(height), 0, GLsizei(size), buffer);
-        width /= 2;
-        height /= 2;
+        if (textureFormat == GL_RGBA) {
+            glTexImage2D(GL_TEXTURE_2D, GLint(level), GL_RGBA,
+                         GLsizei(qMax(width, minWidth)),
+                         GLsizei(qMax(height, minHeight)), 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+        } else {
+            extensions->compressedTexImage2D
+                (GL_TEXTURE_2D, GLint(level), textureFormat,
+                 GLsizei(width), GLsizei(height), 0, GLsizei(size), buffer);
+        }
+        // Non-square textures keep halving the longer side after the
+        // shorter one has reached 1.
+        width = qMax(width / 2, quint32(1));
+        height = qMax(height / 2, quint32(1));
         buffer += size;
         ++level;
     }
@@ -782,4 +894,32 @@ bool QGLBoundTexture::bindCompressedTexturePVR(const char *buf, int len)
     return true;
 }
 
+bool QGLBoundTexture::bindCompressedTextureCooked(const char *buf, int len)
+{
+    QGLTextureExtensions *extensions = QGLTextureExtensions::extensions();
+    if (!extensions)
+        return false;
+
+    const CookedTextureHeader *header =
+        reinterpret_cast<const CookedTextureHeader *>(buf);
+    if (header->version != COOKED_VERSION) {
+        qWarning("QGLBoundTexture::bindCompressedTextureCooked(): Container version %d not supported.", int(header->version));
+        return false;
+    }
+
+    // Upload the first encoding that the GL server supports.
+    const CookedTextureEntry *entry =
+        qt_gl_findCookedTextureEntry(buf, len, extensions);
+    if (!entry) {
+        qWarning("QGLBoundTexture::bindCompressedTextureCooked(): No supported encoding in the container.");
+        return false;
+    }
+    const char *data = buf + entry->offset;
+    int size = int(entry->size);
+    if (entry->encoding == COOKED_ENCODING_DXT1 ||
+            entry->encoding == COOKED_ENCODING_DXT5)
+        return bindCompressedTextureDDS(data, size);
+    return bindCompressedTexturePVR(data, size);
+}
+
 QT_END_NAMESPACE
@@ -150,6 +150,7 @@ public:
         (const char *buf, int len, const char *format = 0);
     bool bindCompressedTextureDDS(const char *buf, int len);
     bool bindCompressedTexturePVR(const char *buf, int len);
+    bool bindCompressedTextureCooked(const char *buf, int len);
 
 private:
     QGLSharedResource m_resource;
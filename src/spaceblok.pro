@@ -12,12 +12,11 @@ TEMPLATE = app
 
 VERSION = 1.2
 
-CONFIG += qt3d
-
 # Include static Qt3D, the Qt3D source will be compiled into the
-# application binary. Be sure to comment the CONFIG += qt3d, if
-# you decide to use the static build.
-#include(qt3d/qt3d.pri)
+# application binary. The game relies on the changes made to the bundled
+# Qt3D, so it can no longer be built against the Qt3D of the SDK with
+# CONFIG += qt3d.
+include(qt3d/qt3d.pri)
 
 
 # Include bullet sources
@@ -46,7 +45,10 @@ SOURCES += \
     src/scoremodel.cpp \
     src/scoredigit.cpp \
     src/score.cpp \
-    src/blackholeshadereffect.cpp
+    src/blackholeshadereffect.cpp \
+    src/textureatlas.cpp \
+    src/textureloader.cpp \
+    src/startupgraph.cpp
 
 
 HEADERS += \
@@ -66,7 +68,10 @@ HEADERS += \
     src/scoremodel.h \
     src/scoredigit.h \
     src/score.h \
-    src/blackholeshadereffect.h
+    src/blackholeshadereffect.h \
+    src/textureatlas.h \
+    src/textureloader.h \
+    src/startupgraph.h
 
 
 RESOURCES += \
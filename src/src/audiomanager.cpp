@@ -10,14 +10,23 @@
 #include "audiomanager.h"
 #include "pullaudioout.h"
 #include "pushaudioout.h"
+#include "offlineaudioout.h"
 #include "audiomixer.h"
 #include "audiobuffer.h"
+#include "soundbank.h"
 #include "audiobufferplayinstance.h"
 #include "echoeffect.h"
 #include "cutoffeffect.h"
 
 using namespace GE;
 
+// How far ahead of the mixer the hit sounds are scheduled, in seconds. Hits
+// of one frame are simulated in a burst, the lead lets them play spaced out
+// at their simulation times.
+static const double HitSoundLead = 0.02;
+
+static const char *AudioSinkVariable = "SPACEBLOK_AUDIO_SINK";
+
 /*!
   \class AudioManager
   \brief Handles the playing and real time manipulation of the audio effects.
@@ -25,35 +34,104 @@ using namespace GE;
 
 
 /*!
-  Constuctor, initializes the GE audio objects and begins to play the wind
-  effect.
+  Constuctor, initializes the GE audio mixer and output. The sounds are
+  loaded with loadSounds() and the wind effect begins to play on start().
 */
 AudioManager::AudioManager(QObject *parent)
-    : QObject(parent)
+    : QObject(parent),
+      m_SoundBank(0),
+      m_HitSound(0),
+      m_Wind(0),
+      m_WindPlayInstance(0),
+      m_ClockOffset(0.0)
 {
     m_AudioMixer = new AudioMixer(this);
 
+    // For running without a sound card, SPACEBLOK_AUDIO_SINK=null renders
+    // the audio in real time without playing it, and a .wav file name
+    // renders it into the file.
+    const QByteArray sink = qgetenv(AudioSinkVariable);
+    if (!sink.isEmpty()) {
+        OfflineAudioOut *offlineOut = new OfflineAudioOut(m_AudioMixer, this);
+        if (sink != "null") {
+            offlineOut->setWavFile(QString::fromLocal8Bit(sink));
+        }
+        offlineOut->setRealtime(true);
+        m_AudioOut = offlineOut;
+        return;
+    }
+
 #ifdef Q_OS_SYMBIAN
     m_AudioOut = new PullAudioOut(m_AudioMixer, this);
 #else
     m_AudioOut = new PushAudioOut(m_AudioMixer, this);
 #endif
+}
 
-    m_HitSound = AudioBuffer::loadWav(":/click.wav", this);
-    m_Wind = AudioBuffer::loadWav(":/effect.wav", this);
 
-    m_WindPlayInstance = m_Wind->playWithMixer(*m_AudioMixer);
-    m_WindPlayInstance->setLoopCount(-1);
+/*!
+  Loads the sound effects. May be called from a worker thread, the loaded
+  sound bank is moved to the thread of the manager.
+*/
+void AudioManager::loadSounds()
+{
+    // The sounds are cooked into the native format of the mixer and are
+    // played in place from the bank, see the soundcooker tool.
+    m_SoundBank = SoundBank::load(":/sounds.gesb");
+    if (m_SoundBank) {
+        m_HitSound = m_SoundBank->buffer("click");
+        m_Wind = m_SoundBank->buffer("effect");
+        m_SoundBank->moveToThread(thread());
+    }
 }
 
 
 /*!
-  Plays the ball-hit-to-a-block sound effect using the GE audio mixer.
+  Takes the loaded sounds into use and begins to play the wind effect. Must
+  be called from the thread of the manager after loadSounds().
 */
-void AudioManager::playHitSound()
+void AudioManager::start()
 {
-    m_HitSound->playWithMixer(*m_AudioMixer);
-    m_HitSound->playWithMixer(*m_AudioMixer);
+    if (m_SoundBank) {
+        m_SoundBank->setParent(this);
+    }
+
+    if (m_HitSound) {
+        // Rapid hits steal the oldest hit voices instead of piling up.
+        m_HitSound->setMaxVoices(8);
+    }
+
+    if (m_Wind) {
+        m_WindPlayInstance = m_Wind->playWithMixer(*m_AudioMixer);
+        m_WindPlayInstance->setLoopCount(-1);
+    }
+}
+
+
+/*!
+  Plays the ball-hit-to-a-block sound effect using the GE audio mixer, at
+  the sample matching \a simulationTime, in seconds of the physics
+  simulation.
+*/
+void AudioManager::playHitSound(double simulationTime)
+{
+    if (!m_HitSound) {
+        return;
+    }
+
+    double time = simulationTime + m_ClockOffset;
+    const double now = m_AudioMixer->time();
+
+    // The offset is kept as long as the hits fall in the scheduling window,
+    // and is set again e.g. after a pause or when the clocks drift apart.
+    if (time < now || time > now + HitSoundLead * 4.0) {
+        m_ClockOffset = now + HitSoundLead - simulationTime;
+        time = now + HitSoundLead;
+    }
+
+    // Played on a pooled voice at double volume, like two overlapping
+    // instances used to.
+    m_AudioMixer->playVoiceAt(time, m_HitSound, 2.0f);
 }
 
 
@@ -62,6 +140,10 @@ void AudioManager::playHitSound()
 */
 void AudioManager::applyWindEffect(float speed, float power)
 {
+    if (!m_WindPlayInstance) {
+        return;
+    }
+
     m_WindPlayInstance->setSpeed(0.1f + speed );
     m_WindPlayInstance->setLeftVolume(0.4f + power * 0.6f);
     m_WindPlayInstance->setRightVolume(0.4f + power * 0.6f);
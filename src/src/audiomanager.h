@@ -17,6 +17,7 @@ namespace GE {
     class AudioOut;
     class AudioMixer;
     class AudioBuffer;
+    class SoundBank;
     class AudioBufferPlayInstance;
     class CutOffEffect;
 }
@@ -28,21 +29,28 @@ class AudioManager : public QObject
 public:
     explicit AudioManager(QObject *parent = 0);
 
+    void loadSounds();
+    void start();
+
 signals:
 
 public slots:
-    void playHitSound();
+    void playHitSound(double simulationTime);
     void applyWindEffect(float speed, float power);
 
 protected:
     GE::AudioOut *m_AudioOut;
     GE::AudioMixer *m_AudioMixer;
 
+    GE::SoundBank *m_SoundBank;
     GE::AudioBuffer *m_HitSound;
     GE::AudioBuffer *m_Wind;
     GE::AudioBufferPlayInstance *m_WindPlayInstance;
 
     GE::CutOffEffect *m_WindEffect;
+
+    // Maps the simulation time to the time of the mixer
+    double m_ClockOffset;
 };
 
 #endif // AUDIOMANAGER_H
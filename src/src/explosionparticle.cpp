@@ -34,7 +34,14 @@ ExplosionParticle::ExplosionParticle(QGLShaderProgramEffect *effect,
     QGLBuilder builder;
     builder.newSection(QGL::Faceted);
     builder << QGLCube(0.6);
-    addNode(builder.finalizedSceneNode());
+    QGLSceneNode *cube = builder.finalizedSceneNode();
+    foreach (QGLSceneNode *node, cube->allChildren() << cube) {
+        QGeometryData gmData = node->geometry();
+        if (!gmData.isEmpty())
+            gmData.setBufferStrategy(gmData.bufferStrategy() |
+                                     QGeometryData::CompactData);
+    }
+    addNode(cube);
 
     if (effect)
         setUserEffect(effect);
@@ -8,9 +8,12 @@
 
 #include <QEvent>
 #include <QMouseEvent>
+#include <QStringList>
 #include <QTimer>
 #include <qglshaderprogram.h>
 #include <qgltexture2d.h>
+#include <qglabstractscene.h>
+#include <qglsceneloader.h>
 #include <qglscenenode.h>
 #include <qglrendersequencer.h>
 #include <qglrenderordercomparator.h>
@@ -26,9 +29,12 @@
 #include "audiomanager.h"
 #include "menumanager.h"
 #include "scoremodel.h"
+#include "startupgraph.h"
 #include "particlesystem.h"
 #include "blocksshader.h"
 #include "blackholeshadereffect.h"
+#include "textureatlas.h"
+#include "textureloader.h"
 
 
 
@@ -76,6 +82,7 @@ public:
 
 // Z-position of platforms in the space.
 const qreal GameView::PLATFORM_Z_POS = 70.0f;
+const int GameView::TEXTURE_UPLOAD_BUDGET = 4;
 
 
 /*!
@@ -87,9 +94,16 @@ GameView::GameView(QWidget *parent)
 {
     m_Level = 0;
     m_MenuManager = 0;
+    m_TextureLoader = 0;
+    m_StartupGraph = new StartupGraph(this);
+    m_LevelLoader = 0;
+    m_PlatformLoader = 0;
+    m_LevelScene = 0;
+    m_PlatformScene = 0;
     m_ExplosionParticles = 0;
     m_LightParticles = 0;
     m_FPSCounter = 0;
+    m_SimulationTime = 0.0;
     m_BlokFlashPower  = 0.0f;
     m_BlackHoleShaderEffect = 0;
 
@@ -105,6 +119,9 @@ GameView::~GameView()
 {
     delete m_RootNode;
 
+    delete m_LevelScene;
+    delete m_PlatformScene;
+
     delete m_BlokShaderEffect;
     delete m_BlackHoleShaderEffect;
 
@@ -148,26 +165,29 @@ void GameView::initializeMaterials()
 {
     m_MaterialCollection = new QGLMaterialCollection(this);
 
-    QGLTexture2D *lightTexture = new QGLTexture2D;
-    lightTexture->setImage(QImage(":/reflectionmap.png"));
+    // The small textures drawn with the flat texture effect are packed into
+    // one atlas texture. Their decoding is started first, the atlas is built
+    // after the other textures have been requested.
+    QStringList atlasImages;
+    atlasImages << "pause_button" << "flare" << "scorefont";
+    foreach (const QString &name, atlasImages) {
+        m_TextureLoader->decode(":/" + name + ".png");
+    }
+
+    QGLTexture2D *lightTexture =
+            m_TextureLoader->texture(":/reflectionmap.png");
 
     QColor ambientColor = QColor(64, 64, 190);
 
-    QGLMaterial *material = new QGLMaterial;
-    material->setObjectName("PauseButtonMaterial");
-    QGLTexture2D *texture = new QGLTexture2D;
-    texture->setImage(QImage(":/pause_button.png"));
-    material->setTexture(texture);
-    m_MaterialCollection->addMaterial(material);
+    QGLMaterial *material;
+    QGLTexture2D *texture;
 
     // Black hole material
     material = new QGLMaterial;
     material->setObjectName("BlackHoleMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/BlackHole.jpg"));
+    texture = m_TextureLoader->texture(":/BlackHole.jpg");
     material->setTexture(texture);
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/bh_sprial.png"));
+    texture = m_TextureLoader->texture(":/bh_sprial.png");
     material->setTexture(texture, 1);
     material->setTextureCombineMode(QGLMaterial::Replace);
     m_MaterialCollection->addMaterial(material);
@@ -176,8 +196,7 @@ void GameView::initializeMaterials()
     // Black hole center material
     material = new QGLMaterial;
     material->setObjectName("BlackHoleFrontMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/bh_sprial.png"));
+    texture = m_TextureLoader->texture(":/bh_sprial.png");
     material->setTexture(texture);
     material->setTexture(lightTexture, 1);
     m_MaterialCollection->addMaterial(material);
@@ -185,16 +204,14 @@ void GameView::initializeMaterials()
     // Platform material
     material = new QGLMaterial;
     material->setObjectName("PlatformMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/platformtex.png"));
+    texture = m_TextureLoader->texture(":/platformtex.png");
     material->setTexture(texture);
     m_MaterialCollection->addMaterial(material);
 
     // Blok material
     material = new QGLMaterial;
     material->setObjectName("BlokMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/SimpleBlock.png"));
+    texture = m_TextureLoader->texture(":/SimpleBlock.png");
     material->setTexture(texture);
     material->setTexture(lightTexture, 1);
     material->setAmbientColor(ambientColor);
@@ -242,18 +259,36 @@ void GameView::initializeMaterials()
     material->setSpecularColor(material->diffuseColor());
     m_MaterialCollection->addMaterial(material);
 
+    // The nodes drawn with the atlas map their texture coordinates into the
+    // sub-rectangle stored in the material.
+    TextureAtlas atlas;
+    foreach (const QString &name, atlasImages) {
+        atlas.addImage(name, m_TextureLoader->image(":/" + name + ".png"));
+    }
+
+    QGLTexture2D *atlasTexture = new QGLTexture2D;
+    atlasTexture->setImage(atlas.image());
+    atlasTexture->setHorizontalWrap(QGL::ClampToEdge);
+    atlasTexture->setVerticalWrap(QGL::ClampToEdge);
+
+    material = new QGLMaterial;
+    material->setObjectName("PauseButtonMaterial");
+    material->setTexture(atlasTexture);
+    TextureAtlas::setMaterialTextureRect(material,
+                                         atlas.textureRect("pause_button"));
+    m_MaterialCollection->addMaterial(material);
+
     material = new QGLMaterial;
     material->setObjectName("LightFlareMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/flare.png"));
-    material->setTexture(texture);
+    material->setTexture(atlasTexture);
+    TextureAtlas::setMaterialTextureRect(material, atlas.textureRect("flare"));
     m_MaterialCollection->addMaterial(material);
 
     material = new QGLMaterial;
     material->setObjectName("FontMaterial");
-    texture = new QGLTexture2D;
-    texture->setImage(QImage(":/scorefont.png"));
-    material->setTexture(texture);
+    material->setTexture(atlasTexture);
+    TextureAtlas::setMaterialTextureRect(material,
+                                         atlas.textureRect("scorefont"));
     m_MaterialCollection->addMaterial(material);
 }
 
@@ -264,6 +299,24 @@ void GameView::initializeMaterials()
 void GameView::initializeAudioEngine()
 {
     m_AudioManager = new AudioManager(this);
+}
+
+
+/*!
+  Loads the sound effects, run on a worker thread during the startup.
+*/
+void GameView::loadAudioEffects()
+{
+    m_AudioManager->loadSounds();
+}
+
+
+/*!
+  Begins to play the wind effect after the sounds have been loaded.
+*/
+void GameView::startAudioEngine()
+{
+    m_AudioManager->start();
     m_AudioManager->applyWindEffect(0.1, 0.2);
 }
 
@@ -276,6 +329,9 @@ void GameView::initializeMenuManager()
     m_MenuManager = new MenuManager(camera(), this);
 
     connect(m_MenuManager, SIGNAL(newGame()), this, SLOT(loadLevel()));
+    connect(m_MenuManager, SIGNAL(menuShownChanged(bool)),
+            this, SLOT(menuShownChanged(bool)));
+    connect(m_MenuManager, SIGNAL(redrawRequested()), this, SLOT(update()));
 }
 
 
@@ -307,10 +363,14 @@ void GameView::createGameObjects()
     scaleMat.scale(3.5f);
     QGLSceneNode *scoreNode;
 
+    m_PlatformScene = takeLoadedScene(m_PlatformLoader);
+    QGLSceneNode *platformModel = m_PlatformScene->mainNode();
+
     Platform *platform = new Platform(
                 m_DynamicsWorld,
                 QVector3D(16, 8.5, PLATFORM_Z_POS),
                 QQuaternion::fromAxisAndAngle(0, 0, 1, 0) * rotation,
+                platformModel,
                 m_MaterialCollection,
                 m_MaterialCollection->indexOf("PlatformMaterial"),
                 m_BlokShaderEffect,
@@ -331,6 +391,7 @@ void GameView::createGameObjects()
                 m_DynamicsWorld,
                 QVector3D(-16, 8.5, PLATFORM_Z_POS),
                 QQuaternion::fromAxisAndAngle(0, 0, 1, 90) * rotation,
+                platformModel,
                 m_MaterialCollection,
                 m_MaterialCollection->indexOf("PlatformMaterial"),
                 m_BlokShaderEffect,
@@ -351,6 +412,7 @@ void GameView::createGameObjects()
                 m_DynamicsWorld,
                 QVector3D(-16, -8.5, PLATFORM_Z_POS),
                 QQuaternion::fromAxisAndAngle(0, 0, 1, 180) * rotation,
+                platformModel,
                 m_MaterialCollection,
                 m_MaterialCollection->indexOf("PlatformMaterial"),
                 m_BlokShaderEffect,
@@ -371,6 +433,7 @@ void GameView::createGameObjects()
                 m_DynamicsWorld,
                 QVector3D(16, -8.5, PLATFORM_Z_POS),
                 QQuaternion::fromAxisAndAngle(0, 0, 1, 270) * rotation,
+                platformModel,
                 m_MaterialCollection,
                 m_MaterialCollection->indexOf("PlatformMaterial"),
                 m_BlokShaderEffect,
@@ -421,6 +484,23 @@ void GameView::createGameObjects()
 }
 
 
+/*!
+  Returns the scene imported by the given background \a loader, waiting for
+  the import to finish if it is still running. The ownership of the scene is
+  transferred to the caller.
+*/
+QGLAbstractScene *GameView::takeLoadedScene(QGLSceneLoader *loader)
+{
+    loader->waitForFinished();
+    QGLAbstractScene *scene = loader->takeScene();
+    if (!scene) {
+        qFatal("Failed to load the model %s", qPrintable(loader->fileName()));
+    }
+
+    return scene;
+}
+
+
 /*!
   Loads the level. If level was already loaded the existing level is destroyed.
 */
@@ -429,9 +509,14 @@ void GameView::loadLevel()
     delete m_Level;
     m_Level = 0;
 
+    if (!m_LevelScene) {
+        m_LevelScene = takeLoadedScene(m_LevelLoader);
+    }
+
     m_Level = new Level(m_DynamicsWorld,
                         QVector3D(0, 0, PLATFORM_Z_POS),
                         QQuaternion(),
+                        m_LevelScene->mainNode(),
                         m_MaterialCollection,
                         m_MaterialCollection->indexOf("BlokMaterial"),
                         m_BlokShaderEffect,
@@ -470,6 +555,24 @@ void GameView::pauseGame()
 }
 
 
+/*!
+  Stops the game loop while the menus are shown, the menus are then redrawn
+  only when the QML scene changes. The loop is restarted when the menus are
+  hidden.
+*/
+void GameView::menuShownChanged(bool isShown)
+{
+    if (isShown) {
+        m_Timer->stop();
+        update();
+    }
+    else {
+        m_LastTime = QTime::currentTime();
+        m_Timer->start(0);
+    }
+}
+
+
 /*!
   Removes the given game object from the member QList container.
   Does not delete the given object.
@@ -654,7 +757,7 @@ void GameView::simulationCallback(btDynamicsWorld *world, btScalar time)
 */
 void GameView::simulateSubStep(btScalar time)
 {
-    Q_UNUSED(time);
+    m_SimulationTime += time;
 
     // Collision detection.
     int manifoldsCount = m_Dispatcher->getNumManifolds();
@@ -739,7 +842,7 @@ void GameView::simulateSubStep(btScalar time)
                                                 ball->materialIndex(),
                                                 platform);
 
-                    m_AudioManager->playHitSound();
+                    m_AudioManager->playHitSound(m_SimulationTime);
 
                     if (hitInfo.m_BlokDestroyed) {
                         m_LightParticles->spray(4, pos, QVector3D(0, 0, 16),
@@ -798,9 +901,9 @@ void GameView::updateGL()
     int relTime = m_LastTime.msecsTo(time);
     m_LastTime = time;
 
-    // If the menus are visible, only freeze the world.
+    // If the menus are visible, only freeze the world. The menus request
+    // their own redraws when the QML scene changes.
     if (m_MenuManager->isMenuShown()) {
-        QGLView::updateGL();
         return;
     }
 
@@ -898,11 +1001,39 @@ void GameView::initializeGL(QGLPainter *painter)
 
     camera()->setEye(QVector3D(0, 0, 120));
 
-    initializeMenuManager();
-    initializeBulletEngine();
-    initializeMaterials();
-    initializeAudioEngine();
-    createGameObjects();
+    m_TextureLoader = new TextureLoader(this);
+
+    // Import the models on a background thread, they are only needed when
+    // the game objects are created.
+    m_LevelLoader = QGLAbstractScene::loadSceneAsync(":/level.obj",
+                                                     QString(), QString(),
+                                                     this);
+    m_PlatformLoader = QGLAbstractScene::loadSceneAsync(":/platform.obj",
+                                                        QString(), QString(),
+                                                        this);
+
+    // The tasks independent of the GL context run on worker threads, the
+    // others run here in the order they are added. The materials are
+    // initialized first, so that the texture images are decoded while the
+    // menus initialize.
+    m_StartupGraph->addTask("materials", StartupGraph::GLThread,
+                            this, "initializeMaterials");
+    m_StartupGraph->addTask("bullet", StartupGraph::WorkerThread,
+                            this, "initializeBulletEngine");
+    m_StartupGraph->addTask("menus", StartupGraph::GLThread,
+                            this, "initializeMenuManager");
+    m_StartupGraph->addTask("audio", StartupGraph::GLThread,
+                            this, "initializeAudioEngine");
+    m_StartupGraph->addTask("sounds", StartupGraph::WorkerThread,
+                            this, "loadAudioEffects",
+                            QStringList() << "audio");
+    m_StartupGraph->addTask("gameobjects", StartupGraph::GLThread,
+                            this, "createGameObjects",
+                            QStringList() << "materials" << "bullet");
+    m_StartupGraph->addTask("audiostart", StartupGraph::GLThread,
+                            this, "startAudioEngine",
+                            QStringList() << "sounds");
+    m_StartupGraph->run();
 
     m_LightPosition = QVector3D(20, 20, -25.0f);
     m_LightTargetPosition = m_LightPosition;
@@ -931,6 +1062,9 @@ void GameView::paintGL(QGLPainter *painter)
     }
     */
 
+    // Upload the textures decoded since the last frame.
+    m_TextureLoader->uploadPending(TEXTURE_UPLOAD_BUDGET);
+
     if (!m_MenuManager->isMenuShown()) {
         glFrontFace(GL_CCW);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -973,4 +1107,16 @@ void GameView::paintGL(QGLPainter *painter)
         painter->disableEffect();
         m_MenuManager->draw(painter);
     }
+
+    // The startup is complete when all of the textures have been uploaded,
+    // keep drawing until then even if the menus do not change.
+    if (!m_StartupGraph->isInteractive()) {
+        m_StartupGraph->markFirstFrame();
+        if (m_TextureLoader->hasPendingUploads()) {
+            QTimer::singleShot(0, this, SLOT(update()));
+        }
+        else {
+            m_StartupGraph->markInteractive();
+        }
+    }
 }
@@ -25,6 +25,8 @@ class btDynamicsWorld;
 
 // Qt3D forward declarations
 class QGLMaterialCollection;
+class QGLAbstractScene;
+class QGLSceneLoader;
 
 
 // Qt forward declarations
@@ -40,6 +42,8 @@ class Platform;
 class Ball;
 class AudioManager;
 class MenuManager;
+class StartupGraph;
+class TextureLoader;
 class ParticleSystem;
 class BlocksShaderEffect;
 class BlackHoleShaderEffect;
@@ -60,18 +64,23 @@ protected slots:
 
     void loadLevel();
     void pauseGame();
+    void menuShownChanged(bool isShown);
 
-protected:
-
-    void initializeGL(QGLPainter *painter);
-
+    // Startup tasks run by the StartupGraph
     void initializeBulletEngine();
     void initializeMaterials();
     void initializeAudioEngine();
+    void loadAudioEffects();
+    void startAudioEngine();
     void initializeMenuManager();
 
     void createGameObjects();
 
+protected:
+
+    void initializeGL(QGLPainter *painter);
+
+    QGLAbstractScene *takeLoadedScene(QGLSceneLoader *loader);
     QPointF convertPointToGLPos(const QPointF &pos);
     void removeBall(GameObject *gameObject);
 
@@ -93,13 +102,28 @@ protected:
 
     static const qreal PLATFORM_Z_POS;
 
+    // Milliseconds per frame used for uploading decoded textures.
+    static const int TEXTURE_UPLOAD_BUDGET;
+
     BlocksShaderEffect *m_BlokShaderEffect;
     BlackHoleShaderEffect *m_BlackHoleShaderEffect;
 
     QTimer *m_Timer;
     QTime m_LastTime;
 
+    // Seconds simulated by Bullet, advanced by every substep
+    double m_SimulationTime;
+
     QGLMaterialCollection *m_MaterialCollection;
+    TextureLoader *m_TextureLoader;
+    StartupGraph *m_StartupGraph;
+
+    // The models are imported in the background while the rest of the game
+    // initializes, the scenes are taken from the loaders when first needed.
+    QGLSceneLoader *m_LevelLoader;
+    QGLSceneLoader *m_PlatformLoader;
+    QGLAbstractScene *m_LevelScene;
+    QGLAbstractScene *m_PlatformScene;
 
     QVector3D m_LightPosition;
     QVector3D m_LightTargetPosition;
@@ -8,7 +8,6 @@
 
 
 #include <btBulletDynamicsCommon.h>
-#include <qglabstractscene.h>
 #include <qglbuilder.h>
 #include <qglshaderprogram.h>
 #include <qglcube.h>
@@ -31,7 +30,8 @@
 
 
 /*!
-  Constuctor, loads the 3D model of the level from .obj file. Scans the
+  Constuctor, creates the level from a clone of the given \a model, imported
+  from the level .obj file. The model can be shared between levels. Scans the
   vertexes of the model and generates collision shapes for the each cube. The
   each collision shape are compound to a single body, making the level rotate
   as one. The linear damping of the body is set to really large to prevent
@@ -46,6 +46,7 @@
 Level::Level(btDiscreteDynamicsWorld *world,
              const QVector3D &pos,
              const QQuaternion &quaternion,
+             QGLSceneNode *model,
              QGLMaterialCollection *materialCollection,
              int blokMaterialIndex,
              QGLShaderProgramEffect *effect,
@@ -59,27 +60,39 @@ Level::Level(btDiscreteDynamicsWorld *world,
     m_LightPositionLoc = -1;
     m_ShininessLoc = -1;
 
-    QGLAbstractScene *levelModel = QGLAbstractScene::loadScene(":/level.obj");
-    addNode(levelModel->mainNode()->clone(this));
-    delete levelModel;
+    addNode(model->clone(this));
 
     if (effect)
         setUserEffect(effect);
     else
         setEffect(QGL::FlatReplaceTexture2D);
 
-    // Scale the level to better size
+    // Scale the level to better size. The bloks share the geometry of
+    // the model, scale a copy of it once and give it to all of them.
+    quint64 originalId = 0;
+    QGeometryData scaled;
     foreach (QGLSceneNode *node, allChildren()) {
         QGeometryData gmData = node->geometry();
         if (gmData.vertices().isEmpty()) {
             continue;
         }
 
-        for (int i = 0; i<gmData.vertices().size(); i++) {
-            gmData.vertex(i) *= 1.3f;
+        if (scaled.isNull()) {
+            originalId = gmData.id();
+            scaled = gmData;
+            scaled.detach();
+            for (int i = 0; i<scaled.vertices().size(); i++) {
+                scaled.vertex(i) *= 1.3f;
+            }
+
+            // The level is static, store it in the compact vertex format
+            scaled.setBufferStrategy(scaled.bufferStrategy() |
+                                     QGeometryData::CompactData);
         }
 
-        break;
+        if (gmData.id() == originalId) {
+            node->setGeometry(scaled);
+        }
     }
 
     btCompoundShape *compoundShape = new btCompoundShape;
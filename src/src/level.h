@@ -50,6 +50,8 @@ public:
     Level(btDiscreteDynamicsWorld *world,
           const QVector3D &pos,
           const QQuaternion &quaternion,
+          //Imported level model, cloned for this level.
+          QGLSceneNode *model,
           QGLMaterialCollection *materialCollection,
           int blokMaterialIndex,
           //Shader effect to be assigned for level objects.
@@ -10,7 +10,9 @@
 #include <qglbuilder.h>
 #include <qglsphere.h>
 #include <qglcube.h>
+#include <qglmaterialcollection.h>
 #include "lightparticle.h"
+#include "textureatlas.h"
 
 /*!
   \class LightParticle
@@ -28,7 +30,11 @@ LightParticle::LightParticle(QGLMaterialCollection *materialCollection,
     QGLBuilder builder;
     builder.newSection(QGL::Faceted);
     builder.addPane(QSizeF(4.0f, 4.0f));
-    addNode(builder.finalizedSceneNode());
+    QGLSceneNode *node = builder.finalizedSceneNode();
+    TextureAtlas::mapTextureCoordinates(node,
+            TextureAtlas::materialTextureRect(
+                materialCollection->material(materialIndex)));
+    addNode(node);
 
     setEffect(QGL::FlatReplaceTexture2D);
     setPalette(materialCollection);
@@ -42,7 +42,9 @@
   texture of the material will be upadted later on renderToTexture calls.
 */
 MenuManager::MenuManager(QGLCamera *camera, QObject *parent)
-    : QObject(parent)
+    : QObject(parent),
+      m_Fbo(0),
+      m_MenuShown(false)
 {
     setMenuShown(false);
 
@@ -51,6 +53,11 @@ MenuManager::MenuManager(QGLCamera *camera, QObject *parent)
     m_GraphicsScene = new QGraphicsEmbedScene(0, 0, 640, 360, this);
     m_GraphicsScene->setItemIndexMethod(QGraphicsScene::NoIndex);
 
+    // The scene reports the areas changed by QML updates and animations,
+    // only those are repainted to the texture.
+    connect(m_GraphicsScene, SIGNAL(changed(QList<QRectF>)),
+            this, SLOT(sceneChanged(QList<QRectF>)));
+
     m_DeclarativeEngine = new QDeclarativeEngine(this);
     m_DeclarativeComponent =
             new QDeclarativeComponent(m_DeclarativeEngine,
@@ -91,6 +98,15 @@ MenuManager::MenuManager(QGLCamera *camera, QObject *parent)
 }
 
 
+/*!
+  Destructor, releases the framebuffer object of the menu texture.
+*/
+MenuManager::~MenuManager()
+{
+    delete m_Fbo;
+}
+
+
 /*!
   Returns true if the menus are shown (will be drawn).
 */
@@ -101,11 +117,35 @@ bool MenuManager::isMenuShown() const
 
 
 /*!
+  Sets the menus shown or hidden. Emits menuShownChanged when the state
+  changes, so that the view can stop or restart the game loop.
 */
 void MenuManager::setMenuShown(bool isShown)
 {
+    bool changed = (m_MenuShown != isShown);
     m_MenuShown = isShown;
     toggleSwipe(m_MenuShown);
+
+    if (changed) {
+        emit menuShownChanged(m_MenuShown);
+    }
+}
+
+
+/*!
+  Collects the areas of the QML scene that have changed since the texture
+  was last rendered. A redraw is requested only if the menus are shown, so
+  an idle menu does not cause any rendering.
+*/
+void MenuManager::sceneChanged(const QList<QRectF> &region)
+{
+    foreach (const QRectF &rect, region) {
+        m_DirtyRegion += rect.toAlignedRect();
+    }
+
+    if (m_MenuShown && !m_DirtyRegion.isEmpty()) {
+        emit redrawRequested();
+    }
 }
 
 
@@ -235,28 +275,43 @@ void MenuManager::renderToTexture()
     if (fboSize.isEmpty())
         fboSize = QSize(16, 16);
 
-    static QGLFramebufferObject *fbo = 0;
-
-    if (fbo == 0) {
-        fbo = new QGLFramebufferObject(fboSize);
-        if (!fbo->isValid()) {
+    if (m_Fbo == 0) {
+        m_Fbo = new QGLFramebufferObject(fboSize);
+        if (!m_Fbo->isValid()) {
             qDebug() << "Failed to create fbo";
         }
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glBindTexture(GL_TEXTURE_2D, fbo->texture());
+        glBindTexture(GL_TEXTURE_2D, m_Fbo->texture());
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+        // The new texture has no content, render all of it.
+        m_DirtyRegion = QRegion(QRect(QPoint(0, 0), fboSize));
     }
 
-    QPainter painter(fbo);
-    m_GraphicsScene->render(&painter);
+    // Nothing to do if the QML scene has not changed.
+    if (m_DirtyRegion.isEmpty()) {
+        return;
+    }
+
+    // Repaint only the changed areas, the scene and the fbo share the
+    // same coordinates.
+    QPainter painter(m_Fbo);
+    painter.setClipRegion(m_DirtyRegion);
+    foreach (const QRect &rect, m_DirtyRegion.rects()) {
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(rect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        m_GraphicsScene->render(&painter, rect, rect);
+    }
     painter.end();
+    m_DirtyRegion = QRegion();
 
-    GLuint textureId = fbo->texture();
+    GLuint textureId = m_Fbo->texture();
 
     QGLTexture2D *texture = m_MenuMaterial->texture();
     if (texture == 0 || texture->textureId() != textureId) {
@@ -276,8 +331,8 @@ void MenuManager::renderToTexture()
 
 
 /*!
-  Draws the menus, the QML scene is first rendered to texture and the
-  QGLSceneNode is drawn to the screen.
+  Draws the menus, the changed areas of the QML scene are first rendered to
+  texture and the QGLSceneNode is drawn to the screen.
 */
 void MenuManager::draw(QGLPainter *painter)
 {
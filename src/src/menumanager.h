@@ -11,6 +11,7 @@
 #define MENUMANAGER_H
 
 #include <QObject>
+#include <QRegion>
 #include <QtOpenGL/qgl.h>
 #include <qvector2darray.h>
 #include <qvector3darray.h>
@@ -21,6 +22,7 @@ class QDeclarativeComponent;
 class QGraphicsEmbedScene;
 class QGraphicsObject;
 class QGLCamera;
+class QGLFramebufferObject;
 class QGLMaterialCollection;
 class QGLMaterial;
 class QGLPainter;
@@ -32,6 +34,7 @@ class MenuManager : public QObject
     Q_OBJECT
 public:
     explicit MenuManager(QGLCamera *camera, QObject *parent = 0);
+    ~MenuManager();
 
     void deliverEvent(QEvent *event, const QPointF &texCoord);
     void draw(QGLPainter *painter);
@@ -53,6 +56,8 @@ protected:
     QGraphicsObject *m_MainQML;
 
     QGraphicsEmbedScene *m_GraphicsScene;
+    QGLFramebufferObject *m_Fbo;
+    QRegion m_DirtyRegion;
 
     bool m_MenuShown;
 
@@ -60,6 +65,8 @@ protected:
 
 signals:
     void newGame();
+    void menuShownChanged(bool isShown);
+    void redrawRequested();
 
 public slots:
     void toMainMenu();
@@ -69,6 +76,7 @@ public slots:
 
 protected slots:
 
+    void sceneChanged(const QList<QRectF> &region);
     void newGameStarted();
     void resumeGame();
 };
@@ -4,6 +4,7 @@
 #include <qglmaterialcollection.h>
 #include "pausebutton.h"
 #include "gameview.h"
+#include "textureatlas.h"
 
 /*!
   \class PauseButton
@@ -30,6 +31,9 @@ PauseButton::PauseButton(const QVector3D &pos,
     builder.addPane(QSizeF(3.0f, 3.0f));
 
     QGLSceneNode *node = builder.finalizedSceneNode();
+    TextureAtlas::mapTextureCoordinates(node,
+            TextureAtlas::materialTextureRect(
+                materialCollection->material(materialIndex)));
     addNode(node);
     node->setParent(this);
 
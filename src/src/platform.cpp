@@ -9,7 +9,6 @@
 #include <QTime>
 #include <QEvent>
 #include <QMouseEvent>
-#include <qglabstractscene.h>
 #include <qglshaderprogram.h>
 #include <btBulletDynamicsCommon.h>
 #include "ball.h"
@@ -27,12 +26,13 @@
 
 
 /*!
-  Constructor, creates platform to given position. Imports platform.obj 3D model
-  and creates and instance of it. The platform does not have Bullet collision
+  Constructor, creates platform to given position. Creates an instance of the
+  given \a model, imported from platform.obj and shared by the platforms. The platform does not have Bullet collision
   shape / body at all and the object is only visible object.
 */
 Platform::Platform(btDiscreteDynamicsWorld *world, const QVector3D &pos,
                    const QQuaternion &quaternion,
+                   QGLSceneNode *model,
                    QGLMaterialCollection *materialCollection,
                    int materialIndex,
                    QGLShaderProgramEffect *effect,
@@ -56,14 +56,9 @@ Platform::Platform(btDiscreteDynamicsWorld *world, const QVector3D &pos,
     m_LastTime = 10000000;
     m_Pressed = false;
 
-    QGLAbstractScene *levelModel =
-            QGLAbstractScene::loadScene(":/platform.obj");
-    QGLSceneNode *node = levelModel->mainNode()->clone();
+    QGLSceneNode *node = model->clone();
     addNode(node);
 
-    delete levelModel;
-    levelModel = 0;
-
     if (effect) {
         setUserEffect(effect);
     }
@@ -34,6 +34,7 @@ public:
     Platform(btDiscreteDynamicsWorld *world,
              const QVector3D &pos,
              const QQuaternion &quaternion,
+             QGLSceneNode *model,
              QGLMaterialCollection *materialCollection,
              int materialIndex,
              QGLShaderProgramEffect *effect,
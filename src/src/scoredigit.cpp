@@ -2,6 +2,7 @@
 #include <qglmaterialcollection.h>
 #include <qglpainter.h>
 #include "scoredigit.h"
+#include "textureatlas.h"
 
 /*!
   \class ScoreDigit
@@ -29,6 +30,18 @@ ScoreDigit::ScoreDigit(QGLMaterialCollection *materialCollection,
     delete rootNode;
     rootNode = 0;
 
+    // The font texture may be a part of a texture atlas.
+    m_TextureRect = TextureAtlas::materialTextureRect(
+                materialCollection->material(materialIndex));
+    TextureAtlas::mapTextureCoordinates(children()[0], m_TextureRect);
+
+    // The texture coordinates are rewritten in place whenever the digit
+    // changes, so let the geometry update just those in the buffer.
+    QGeometryData geometryData = children()[0]->geometry();
+    geometryData.setBufferStrategy(QGeometryData::BufferIfPossible |
+                                   QGeometryData::KeepClientData |
+                                   QGeometryData::DynamicData);
+
     setPosition(pos);
     setPalette(materialCollection);
     setMaterialIndex(materialIndex);
@@ -68,10 +81,12 @@ void ScoreDigit::setValue(int value)
 
     m_Value = value;
     QGeometryData geometryData = children()[0]->geometry();
-    geometryData.texCoord(0).setX(0.1f * m_Value);
-    geometryData.texCoord(1).setX(0.1f * m_Value + 0.1f);
-    geometryData.texCoord(2).setX(0.1f * m_Value + 0.1f);
-    geometryData.texCoord(3).setX(0.1f * m_Value);
+    float left = m_TextureRect.x() + m_TextureRect.width() * 0.1f * m_Value;
+    float right = left + m_TextureRect.width() * 0.1f;
+    geometryData.texCoord(0).setX(left);
+    geometryData.texCoord(1).setX(right);
+    geometryData.texCoord(2).setX(right);
+    geometryData.texCoord(3).setX(left);
 }
 
 
@@ -1,6 +1,7 @@
 #ifndef SCOREDIGIT_H
 #define SCOREDIGIT_H
 
+#include <QRectF>
 #include <qglscenenode.h>
 
 class QGLMaterialCollection;
@@ -26,6 +27,7 @@ public:
 
 protected:
     int m_Value;
+    QRectF m_TextureRect;
 };
 
 #endif // SCOREDIGIT_H
@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+#include "startupgraph.h"
+
+// Environment variable naming a file the startup report is written to.
+static const char *ReportFileVariable = "SPACEBLOK_STARTUP_REPORT";
+
+
+/*!
+  \class StartupTask
+  \brief Runs one worker thread task of the StartupGraph.
+*/
+class StartupTask : public QRunnable
+{
+public:
+    StartupTask(StartupGraph *graph, int index)
+        : m_Graph(graph), m_Index(index)
+    {
+    }
+
+    void run()
+    {
+        m_Graph->runTask(m_Index);
+    }
+
+protected:
+    StartupGraph *m_Graph;
+    int m_Index;
+};
+
+
+/*!
+  \class StartupGraph
+  \brief Runs the startup tasks of the application in the order given by
+         their dependencies. The tasks independent of the GL context run on
+         worker threads, in parallel with the GL thread tasks, which run on
+         the thread calling run() in the order they were added.
+
+         The wall time of each task is recorded, together with the time to
+         the first frame and the time until the application is interactive,
+         measured from the construction of the graph. The report is printed
+         as a single line of JSON, and written to the file named by the
+         SPACEBLOK_STARTUP_REPORT environment variable when it is set.
+*/
+
+
+/*!
+  Constructor, starts the startup clock.
+*/
+StartupGraph::StartupGraph(QObject *parent)
+    : QObject(parent),
+      m_FirstFrame(-1),
+      m_Interactive(-1)
+{
+    m_Clock.start();
+}
+
+
+/*!
+  Destructor, waits for the worker thread tasks to finish.
+*/
+StartupGraph::~StartupGraph()
+{
+    m_ThreadPool.waitForDone();
+}
+
+
+/*!
+  Adds a task which invokes the slot \a method of the \a receiver, when the
+  tasks named in \a dependencies have finished. The dependencies must have
+  been added before, so the graph cannot contain cycles. Worker thread tasks
+  must not create QObjects with parents or touch the GL context.
+*/
+void StartupGraph::addTask(const QString &name, Affinity affinity,
+                           QObject *receiver, const char *method,
+                           const QStringList &dependencies)
+{
+    foreach (const QString &dependency, dependencies) {
+        if (indexOf(dependency) < 0) {
+            qWarning("StartupGraph: unknown dependency %s of the task %s",
+                     qPrintable(dependency), qPrintable(name));
+            return;
+        }
+    }
+
+    Task task;
+    task.name = name;
+    task.affinity = affinity;
+    task.receiver = receiver;
+    task.method = method;
+    task.dependencies = dependencies;
+    task.started = false;
+    task.finished = false;
+    task.start = 0;
+    task.duration = 0;
+    m_Tasks.append(task);
+}
+
+
+/*!
+  Runs all of the tasks and returns when they have finished. The ready worker
+  thread tasks are started first, then the first ready GL thread task is run
+  on the calling thread. When no GL thread task is ready, waits for a worker
+  thread task to finish.
+*/
+void StartupGraph::run()
+{
+    QMutexLocker locker(&m_Mutex);
+
+    forever {
+        bool pending = false;
+        int glTask = -1;
+
+        for (int i = 0; i < m_Tasks.count(); i++) {
+            Task &task = m_Tasks[i];
+            if (task.finished) {
+                continue;
+            }
+
+            pending = true;
+            if (task.started || !isReady(task)) {
+                continue;
+            }
+
+            if (task.affinity == WorkerThread) {
+                task.started = true;
+                m_ThreadPool.start(new StartupTask(this, i));
+            }
+            else if (glTask < 0) {
+                glTask = i;
+            }
+        }
+
+        if (!pending) {
+            break;
+        }
+
+        if (glTask >= 0) {
+            m_Tasks[glTask].started = true;
+            locker.unlock();
+            runTask(glTask);
+            locker.relock();
+        }
+        else {
+            m_TaskFinished.wait(&m_Mutex);
+        }
+    }
+}
+
+
+/*!
+  Records the time the first frame was drawn.
+*/
+void StartupGraph::markFirstFrame()
+{
+    if (m_FirstFrame < 0) {
+        m_FirstFrame = m_Clock.elapsed();
+    }
+}
+
+
+/*!
+  Records the time the application became interactive and emits the report.
+*/
+void StartupGraph::markInteractive()
+{
+    if (m_Interactive >= 0) {
+        return;
+    }
+
+    m_Interactive = m_Clock.elapsed();
+
+    QString text = report();
+    qDebug() << "Startup:" << qPrintable(text);
+
+    QByteArray fileName = qgetenv(ReportFileVariable);
+    if (!fileName.isEmpty()) {
+        QFile file(QString::fromLocal8Bit(fileName));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            file.write(text.toUtf8());
+            file.write("\n");
+        }
+        else {
+            qWarning("StartupGraph: could not write the report to %s",
+                     fileName.constData());
+        }
+    }
+}
+
+
+/*!
+  Returns true if markInteractive() has been called.
+*/
+bool StartupGraph::isInteractive() const
+{
+    return m_Interactive >= 0;
+}
+
+
+/*!
+  Returns the startup report as JSON. The times are in milliseconds from the
+  construction of the graph, -1 for the events which have not happened yet.
+*/
+QString StartupGraph::report() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    QStringList tasks;
+    foreach (const Task &task, m_Tasks) {
+        tasks.append(QString("{\"name\":\"%1\",\"thread\":\"%2\","
+                             "\"start\":%3,\"duration\":%4}")
+                     .arg(task.name)
+                     .arg(task.affinity == GLThread ? "gl" : "worker")
+                     .arg(task.start)
+                     .arg(task.duration));
+    }
+
+    return QString("{\"tasks\":[%1],\"firstFrame\":%2,\"interactive\":%3}")
+            .arg(tasks.join(","))
+            .arg(m_FirstFrame)
+            .arg(m_Interactive);
+}
+
+
+/*!
+  Returns the index of the named task, or -1 if there is no such task.
+*/
+int StartupGraph::indexOf(const QString &name) const
+{
+    for (int i = 0; i < m_Tasks.count(); i++) {
+        if (m_Tasks[i].name == name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+/*!
+  Returns true if all the dependencies of the task have finished.
+*/
+bool StartupGraph::isReady(const Task &task) const
+{
+    foreach (const QString &dependency, task.dependencies) {
+        if (!m_Tasks[indexOf(dependency)].finished) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+  Runs the task on the calling thread and records its wall time.
+*/
+void StartupGraph::runTask(int index)
+{
+    QObject *receiver;
+    QByteArray method;
+    {
+        QMutexLocker locker(&m_Mutex);
+        Task &task = m_Tasks[index];
+        task.start = m_Clock.elapsed();
+        receiver = task.receiver;
+        method = task.method;
+    }
+
+    if (!QMetaObject::invokeMethod(receiver, method.constData(),
+                                   Qt::DirectConnection)) {
+        qWarning("StartupGraph: could not invoke %s", method.constData());
+    }
+
+    QMutexLocker locker(&m_Mutex);
+    Task &task = m_Tasks[index];
+    task.duration = m_Clock.elapsed() - task.start;
+    task.finished = true;
+    m_TaskFinished.wakeAll();
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef STARTUPGRAPH_H
+#define STARTUPGRAPH_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTime>
+#include <QWaitCondition>
+
+class StartupGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Affinity {
+        GLThread,
+        WorkerThread
+    };
+
+    explicit StartupGraph(QObject *parent = 0);
+    ~StartupGraph();
+
+    void addTask(const QString &name, Affinity affinity, QObject *receiver,
+                 const char *method,
+                 const QStringList &dependencies = QStringList());
+    void run();
+
+    void markFirstFrame();
+    void markInteractive();
+    bool isInteractive() const;
+
+    QString report() const;
+
+protected:
+    struct Task {
+        QString name;
+        Affinity affinity;
+        QObject *receiver;
+        QByteArray method;
+        QStringList dependencies;
+        bool started;
+        bool finished;
+        int start;
+        int duration;
+    };
+
+    int indexOf(const QString &name) const;
+    bool isReady(const Task &task) const;
+    void runTask(int index);
+
+protected:
+    QThreadPool m_ThreadPool;
+
+    // Guards m_Tasks while the graph is running.
+    mutable QMutex m_Mutex;
+    QWaitCondition m_TaskFinished;
+    QList<Task> m_Tasks;
+
+    QTime m_Clock;
+    int m_FirstFrame;
+    int m_Interactive;
+
+    friend class StartupTask;
+};
+
+#endif // STARTUPGRAPH_H
@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QPainter>
+#include <QVariant>
+#include <qareaallocator.h>
+#include <qglmaterial.h>
+#include <qglscenenode.h>
+#include "textureatlas.h"
+
+// Name of the QGLMaterial property holding the sub-rectangle of the atlas.
+static const char *TextureRectProperty = "textureRect";
+
+// Maximum width and height the atlas is allowed to grow to.
+static const int MaxAtlasSize = 2048;
+
+// Width of the border around each image, filled with copies of the image's
+// edge pixels so that filtering and mipmapping near the edges of the image
+// sample the image itself instead of the neighbouring images.
+static const int Border = 2;
+
+
+/*!
+  Extrudes the edge pixels of the image at \a rect in the \a atlas into the
+  surrounding border, including the corners.
+*/
+static void extrudeEdges(QImage &atlas, const QRect &rect)
+{
+    // Left and right edges of each row of the image.
+    for (int y = rect.top(); y <= rect.bottom(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(atlas.scanLine(y));
+        for (int i = 1; i <= Border; i++) {
+            line[rect.left() - i] = line[rect.left()];
+            line[rect.right() + i] = line[rect.right()];
+        }
+    }
+
+    // Top and bottom edges, copying whole rows including the left and
+    // right borders fills the corners as well.
+    int left = rect.left() - Border;
+    int bytes = (rect.width() + 2 * Border) * sizeof(QRgb);
+    for (int i = 1; i <= Border; i++) {
+        qMemCopy(atlas.scanLine(rect.top() - i) + left * sizeof(QRgb),
+                 atlas.scanLine(rect.top()) + left * sizeof(QRgb), bytes);
+        qMemCopy(atlas.scanLine(rect.bottom() + i) + left * sizeof(QRgb),
+                 atlas.scanLine(rect.bottom()) + left * sizeof(QRgb), bytes);
+    }
+}
+
+/*!
+  \class TextureAtlas
+  \brief Packs small images into a single texture image, so that materials
+         using them share one texture and drawing them does not need to
+         rebind textures. The images are placed with QGeneralAreaAllocator.
+         The sub-rectangle of each image is stored in the material using
+         the atlas, and the nodes drawn with the material map their texture
+         coordinates into it with mapTextureCoordinates(). Each image is
+         surrounded by a border of its own edge pixels.
+*/
+
+
+/*!
+  Constructor, creates an empty atlas with the given initial size. The atlas
+  grows if the images do not fit.
+*/
+TextureAtlas::TextureAtlas(const QSize &size)
+    : m_Allocator(new QGeneralAreaAllocator(size)),
+      m_Image(size, QImage::Format_ARGB32)
+{
+    m_Image.fill(0);
+}
+
+
+/*!
+  Destructor.
+*/
+TextureAtlas::~TextureAtlas()
+{
+    delete m_Allocator;
+}
+
+
+/*!
+  Adds the image to the atlas with the given name. Returns false if the image
+  could not be placed into the atlas even when grown to the maximum size.
+*/
+bool TextureAtlas::addImage(const QString &name, const QImage &image)
+{
+    if (image.isNull()) {
+        return false;
+    }
+
+    QSize allocation = image.size() + QSize(2 * Border, 2 * Border);
+    QRect rect = m_Allocator->allocate(allocation);
+    while (rect.isNull()) {
+        QSize size = m_Allocator->size();
+        if (size.width() <= size.height()) {
+            size.setWidth(size.width() * 2);
+        }
+        else {
+            size.setHeight(size.height() * 2);
+        }
+
+        if (size.width() > MaxAtlasSize || size.height() > MaxAtlasSize) {
+            qWarning("TextureAtlas: no room for the image %s",
+                     qPrintable(name));
+            return false;
+        }
+
+        m_Allocator->expand(size);
+
+        QImage grown(size, QImage::Format_ARGB32);
+        grown.fill(0);
+        QPainter painter(&grown);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(0, 0, m_Image);
+        painter.end();
+        m_Image = grown;
+
+        rect = m_Allocator->allocate(allocation);
+    }
+
+    QRect imageRect(rect.topLeft() + QPoint(Border, Border), image.size());
+
+    QPainter painter(&m_Image);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(imageRect.topLeft(), image);
+    painter.end();
+
+    extrudeEdges(m_Image, imageRect);
+
+    m_Rects.insert(name, imageRect);
+    return true;
+}
+
+
+/*!
+  Returns the packed image, which should be set to a QGLTexture2D after all
+  images have been added.
+*/
+QImage TextureAtlas::image() const
+{
+    return m_Image;
+}
+
+
+/*!
+  Returns the sub-rectangle of the named image in texture coordinates. The
+  texture is flipped when uploaded, so the y axis points up as in the
+  texture coordinates of the meshes. Returns the whole texture if the image
+  was not added.
+*/
+QRectF TextureAtlas::textureRect(const QString &name) const
+{
+    QMap<QString, QRect>::const_iterator it = m_Rects.constFind(name);
+    if (it == m_Rects.constEnd()) {
+        return QRectF(0, 0, 1, 1);
+    }
+
+    const QRect &rect = it.value();
+    qreal width = m_Image.width();
+    qreal height = m_Image.height();
+
+    return QRectF(rect.x() / width,
+                  (height - rect.y() - rect.height()) / height,
+                  rect.width() / width,
+                  rect.height() / height);
+}
+
+
+/*!
+  Stores the atlas sub-rectangle of the material's texture to the material.
+*/
+void TextureAtlas::setMaterialTextureRect(QGLMaterial *material,
+                                          const QRectF &rect)
+{
+    material->setProperty(TextureRectProperty, rect);
+}
+
+
+/*!
+  Returns the atlas sub-rectangle of the material's texture, or the whole
+  texture if the material does not use an atlas.
+*/
+QRectF TextureAtlas::materialTextureRect(const QGLMaterial *material)
+{
+    if (material) {
+        QVariant rect = material->property(TextureRectProperty);
+        if (rect.isValid()) {
+            return rect.toRectF();
+        }
+    }
+
+    return QRectF(0, 0, 1, 1);
+}
+
+
+/*!
+  Maps the texture coordinates of the node and its children from the whole
+  texture into the given sub-rectangle of the atlas. Geometry shared between
+  the nodes is mapped only once.
+*/
+void TextureAtlas::mapTextureCoordinates(QGLSceneNode *node,
+                                         const QRectF &rect)
+{
+    if (rect == QRectF(0, 0, 1, 1)) {
+        return;
+    }
+
+    QList<QGLSceneNode*> nodes = node->allChildren();
+    nodes.prepend(node);
+
+    QList<QGeometryData> mapped;
+    foreach (QGLSceneNode *child, nodes) {
+        QGeometryData geometry = child->geometry();
+        if (!geometry.hasField(QGL::TextureCoord0) ||
+                mapped.contains(geometry)) {
+            continue;
+        }
+        mapped.append(geometry);
+
+        for (int i = 0; i < geometry.count(QGL::TextureCoord0); i++) {
+            QVector2D &texCoord = geometry.texCoord(i);
+            texCoord = QVector2D(rect.x() + texCoord.x() * rect.width(),
+                                 rect.y() + texCoord.y() * rect.height());
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <QImage>
+#include <QMap>
+#include <QRect>
+#include <QString>
+
+class QGeneralAreaAllocator;
+class QGLMaterial;
+class QGLSceneNode;
+
+class TextureAtlas
+{
+public:
+    explicit TextureAtlas(const QSize &size = QSize(512, 256));
+    ~TextureAtlas();
+
+    bool addImage(const QString &name, const QImage &image);
+
+    QImage image() const;
+    QRectF textureRect(const QString &name) const;
+
+    static void setMaterialTextureRect(QGLMaterial *material,
+                                       const QRectF &rect);
+    static QRectF materialTextureRect(const QGLMaterial *material);
+    static void mapTextureCoordinates(QGLSceneNode *node, const QRectF &rect);
+
+protected:
+    QGeneralAreaAllocator *m_Allocator;
+    QImage m_Image;
+    QMap<QString, QRect> m_Rects;
+};
+
+#endif // TEXTUREATLAS_H
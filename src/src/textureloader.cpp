@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QTime>
+#include <qgltexture2d.h>
+#include "textureloader.h"
+
+
+/*!
+  \class TextureDecodeTask
+  \brief Decodes one image on a worker thread of the TextureLoader. The image
+         is also converted to the 32-bit format the texture upload uses, so
+         that the GL thread does not have to convert it.
+*/
+class TextureDecodeTask : public QRunnable
+{
+public:
+    TextureDecodeTask(TextureLoader *loader, const QString &fileName)
+        : m_Loader(loader), m_FileName(fileName)
+    {
+    }
+
+    void run()
+    {
+        QImage image(m_FileName);
+        if (image.isNull()) {
+            qWarning("Could not load texture: %s", qPrintable(m_FileName));
+        }
+        else if (image.hasAlphaChannel()) {
+            image = image.convertToFormat(QImage::Format_ARGB32);
+        }
+        else {
+            image = image.convertToFormat(QImage::Format_RGB32);
+        }
+
+        m_Loader->imageDecoded(m_FileName, image);
+    }
+
+protected:
+    TextureLoader *m_Loader;
+    QString m_FileName;
+};
+
+
+/*!
+  \class TextureLoader
+  \brief Decodes the texture images on a pool of worker threads, so that the
+         decoding overlaps with the rest of the initialization instead of
+         blocking the first frame.
+
+         texture() returns at once a QGLTexture2D holding a placeholder
+         image. The decoded images are queued, and uploadPending() moves them
+         into their textures and uploads them on the GL thread within a time
+         budget per frame. Cooked texture containers (.qtex) need no decoding
+         and are uploaded by uploadPending() in the same way; when the GL
+         supports none of their encodings, the image is decoded instead.
+*/
+
+
+/*!
+  Returns the name of the cooked texture container of the image file, e.g.
+  ":/BlackHole.qtex" for ":/BlackHole.jpg".
+*/
+static QString cookedFileName(const QString &fileName)
+{
+    return fileName.left(fileName.lastIndexOf('.')) + ".qtex";
+}
+
+
+/*!
+  Returns the image shown by the textures until their upload.
+*/
+static QImage placeholder()
+{
+    static QImage image;
+    if (image.isNull()) {
+        image = QImage(1, 1, QImage::Format_RGB32);
+        image.fill(QColor(Qt::gray).rgba());
+    }
+    return image;
+}
+
+
+/*!
+  Constructor.
+*/
+TextureLoader::TextureLoader(QObject *parent)
+    : QObject(parent)
+{
+}
+
+
+/*!
+  Destructor, waits for the decoding in progress to finish.
+*/
+TextureLoader::~TextureLoader()
+{
+    m_ThreadPool.waitForDone();
+}
+
+
+/*!
+  Returns the texture of the image file. The same texture is returned for
+  the same file. The texture shows a placeholder until uploadPending() has
+  uploaded either the cooked texture container with the same base name, when
+  present, or the decoded image.
+*/
+QGLTexture2D *TextureLoader::texture(const QString &fileName)
+{
+    QGLTexture2D *texture = m_Textures.value(fileName);
+    if (texture) {
+        return texture;
+    }
+
+    texture = new QGLTexture2D;
+    m_Textures.insert(fileName, texture);
+
+    texture->setImage(placeholder());
+
+    m_PendingUploads.insert(fileName, texture);
+    if (QFile::exists(cookedFileName(fileName))) {
+        m_PendingCooked.insert(fileName);
+    }
+    else {
+        decode(fileName);
+    }
+    return texture;
+}
+
+
+/*!
+  Returns the decoded image of the file, waiting for the decoding to finish.
+  Used for the images needed on the CPU side, for example when packing them
+  into a TextureAtlas. If a texture of the same file is waiting for the
+  image, the image is left for uploadPending().
+*/
+QImage TextureLoader::image(const QString &fileName)
+{
+    decode(fileName);
+
+    QMutexLocker locker(&m_Mutex);
+    while (!m_Decoded.contains(fileName)) {
+        m_DecodedCondition.wait(&m_Mutex);
+    }
+
+    if (m_PendingUploads.contains(fileName) &&
+            !m_PendingCooked.contains(fileName)) {
+        return m_Decoded.value(fileName);
+    }
+
+    m_Requested.remove(fileName);
+    return m_Decoded.take(fileName);
+}
+
+
+/*!
+  Moves the cooked texture containers and the decoded images into their
+  textures and uploads them to the GL server. Uploading stops when \a budget
+  milliseconds have been used, the rest is uploaded on the following calls.
+  At least one texture is uploaded on each call. Must be called from the GL thread with the context current.
+*/
+void TextureLoader::uploadPending(int budget)
+{
+    if (m_PendingUploads.isEmpty()) {
+        return;
+    }
+
+    QTime time;
+    time.start();
+
+    QHash<QString, QGLTexture2D*>::iterator it = m_PendingUploads.begin();
+    while (it != m_PendingUploads.end()) {
+        QGLTexture2D *texture = it.value();
+
+        if (m_PendingCooked.remove(it.key())) {
+            if (!texture->setCompressedFile(cookedFileName(it.key()))) {
+                // No encoding in the container for this GL, the failed
+                // load cleared the placeholder. Show it again until the
+                // image has been decoded.
+                texture->setImage(placeholder());
+                decode(it.key());
+                ++it;
+                continue;
+            }
+
+            texture->bind();
+            texture->release();
+            it = m_PendingUploads.erase(it);
+
+            if (time.elapsed() >= budget) {
+                break;
+            }
+            continue;
+        }
+
+        QImage image;
+        {
+            QMutexLocker locker(&m_Mutex);
+            if (!m_Decoded.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            image = m_Decoded.take(it.key());
+        }
+
+        // A failed decode keeps the placeholder.
+        if (!image.isNull()) {
+            texture->setImage(image);
+            texture->bind();
+            texture->release();
+        }
+
+        m_Requested.remove(it.key());
+        it = m_PendingUploads.erase(it);
+
+        if (time.elapsed() >= budget) {
+            break;
+        }
+    }
+}
+
+
+/*!
+  Returns true if some textures are still waiting for their images to be
+  decoded or uploaded.
+*/
+bool TextureLoader::hasPendingUploads() const
+{
+    return !m_PendingUploads.isEmpty();
+}
+
+
+/*!
+  Starts decoding the file on the thread pool, unless it has already been
+  requested.
+*/
+void TextureLoader::decode(const QString &fileName)
+{
+    if (m_Requested.contains(fileName)) {
+        return;
+    }
+
+    m_Requested.insert(fileName);
+    m_ThreadPool.start(new TextureDecodeTask(this, fileName));
+}
+
+
+/*!
+  Called from a worker thread when the image of the file has been decoded.
+*/
+void TextureLoader::imageDecoded(const QString &fileName, const QImage &image)
+{
+    QMutexLocker locker(&m_Mutex);
+    m_Decoded.insert(fileName, image);
+    m_DecodedCondition.wakeAll();
+}
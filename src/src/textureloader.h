@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class QGLTexture2D;
+
+class TextureLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TextureLoader(QObject *parent = 0);
+    ~TextureLoader();
+
+    QGLTexture2D *texture(const QString &fileName);
+    QImage image(const QString &fileName);
+    void decode(const QString &fileName);
+
+    void uploadPending(int budget);
+    bool hasPendingUploads() const;
+
+protected:
+    void imageDecoded(const QString &fileName, const QImage &image);
+
+protected:
+    QThreadPool m_ThreadPool;
+
+    // Guards m_Decoded, which is written from the worker threads.
+    mutable QMutex m_Mutex;
+    QWaitCondition m_DecodedCondition;
+    QHash<QString, QImage> m_Decoded;
+
+    // Accessed only from the GL thread.
+    QSet<QString> m_Requested;
+    QHash<QString, QGLTexture2D*> m_Textures;
+    QHash<QString, QGLTexture2D*> m_PendingUploads;
+    QSet<QString> m_PendingCooked;
+
+    friend class TextureDecodeTask;
+};
+
+#endif // TEXTURELOADER_H
@@ -0,0 +1,23 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Offline tool that renders a script of sound events through the GE mixer
+# without a sound card, for performance and golden output tests. Run it on
+# the desktop: audiorender -o out.wav hits.txt ../../audio/sounds.gesb
+
+
+TARGET = audiorender
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+GE_PATH = $$PWD/../../geaudio
+include(../../geaudio/qtgameenableraudio.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,275 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <cstdio>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QtAlgorithms>
+#include "audiobuffer.h"
+#include "audiomixer.h"
+#include "offlineaudioout.h"
+#include "soundbank.h"
+
+using namespace GE;
+
+// How far ahead of the mixer the events are scheduled, in blocks.
+static const int LOOKAHEAD_BLOCKS = 2;
+
+
+/*!
+  A line of the script: plays the sound \a name at \a time seconds.
+*/
+struct SoundEvent
+{
+    double time;
+    QString name;
+    float volume;
+    float speed;
+    int loopCount;
+};
+
+
+static bool eventLessThan(const SoundEvent &a, const SoundEvent &b)
+{
+    return a.time < b.time;
+}
+
+
+/*!
+  Removes the option \a name and its value from \a arguments and returns the
+  value, or \a defaultValue if the option is not given.
+*/
+static QString takeOption(QStringList &arguments, const QString &name,
+                          const QString &defaultValue = QString())
+{
+    int index = arguments.indexOf(name);
+    if (index < 0 || index + 1 >= arguments.count()) {
+        return defaultValue;
+    }
+
+    QString value = arguments.at(index + 1);
+    arguments.removeAt(index + 1);
+    arguments.removeAt(index);
+    return value;
+}
+
+
+/*!
+  Reads the script \a fileName into \a events sorted by time. Each line is
+  "time name [volume] [speed] [loops]", the lines starting with # are
+  comments.
+*/
+static bool readScript(const QString &fileName, QList<SoundEvent> &events)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning("Could not open %s", qPrintable(fileName));
+        return false;
+    }
+
+    QTextStream stream(&file);
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        QString line = stream.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        QStringList fields = line.split(QRegExp("\\s+"));
+        bool ok = fields.count() >= 2 && fields.count() <= 5;
+
+        SoundEvent event;
+        event.time = ok ? fields.at(0).toDouble(&ok) : 0.0;
+        event.name = fields.value(1);
+        event.volume = 1.0f;
+        event.speed = 1.0f;
+        event.loopCount = 0;
+        if (ok && fields.count() > 2) {
+            event.volume = fields.at(2).toFloat(&ok);
+        }
+        if (ok && fields.count() > 3) {
+            event.speed = fields.at(3).toFloat(&ok);
+        }
+        if (ok && fields.count() > 4) {
+            event.loopCount = fields.at(4).toInt(&ok);
+        }
+
+        if (!ok || event.time < 0.0 || event.speed <= 0.0f) {
+            qWarning("%s:%d: invalid event", qPrintable(fileName), lineNumber);
+            return false;
+        }
+
+        events.append(event);
+    }
+
+    qStableSort(events.begin(), events.end(), eventLessThan);
+    return true;
+}
+
+
+/*!
+  Returns the length of \a buffer in seconds.
+*/
+static double bufferDuration(AudioBuffer *buffer)
+{
+    const int frameBytes =
+            buffer->getNofChannels() * buffer->getBytesPerSample();
+    if (!frameBytes || !buffer->getSamplesPerSec()) {
+        return 0.0;
+    }
+
+    return (double)(buffer->getDataLength() / frameBytes) /
+            buffer->getSamplesPerSec();
+}
+
+
+/*!
+  Plays the sound events of a script through an AudioMixer into an
+  OfflineAudioOut as fast as possible, optionally writing the result to a
+  .wav file, and prints the time spent mixing each block. The events are
+  scheduled at their exact frames, so the output does not depend on the
+  block length. The sounds are taken from the .gesb sound banks and .wav
+  files given after the script.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    const QString outputPath = takeOption(arguments, "-o");
+    const int blockLength =
+            takeOption(arguments, "-b",
+                       QString::number(GEDefaultBlockLength)).toInt();
+    double duration = takeOption(arguments, "-d", "-1").toDouble();
+
+    if (arguments.count() < 2 || blockLength <= 0) {
+        qWarning("Usage: audiorender [-o output.wav] [-b blockLength] "
+                 "[-d seconds] script.txt sounds.gesb|sound.wav...");
+        return 1;
+    }
+
+    QList<SoundEvent> events;
+    if (!readScript(arguments.takeFirst(), events)) {
+        return 1;
+    }
+
+    QMap<QString, AudioBuffer*> sounds;
+    foreach (const QString &path, arguments) {
+        if (path.endsWith(".gesb", Qt::CaseInsensitive)) {
+            SoundBank *bank = SoundBank::load(path, &app);
+            if (!bank) {
+                qWarning("Could not load the sound bank %s",
+                         qPrintable(path));
+                return 1;
+            }
+            for (int i = 0; i < bank->count(); i++) {
+                sounds.insert(bank->name(i), bank->buffer(i));
+            }
+        }
+        else {
+            AudioBuffer *buffer = AudioBuffer::loadWav(path, &app, true);
+            if (!buffer) {
+                qWarning("Could not load the sound %s", qPrintable(path));
+                return 1;
+            }
+            sounds.insert(QFileInfo(path).completeBaseName(), buffer);
+        }
+    }
+
+    // Without a duration, render until the last sound has ended.
+    const bool measureDuration = duration < 0.0;
+    if (measureDuration) {
+        duration = 0.0;
+    }
+
+    foreach (const SoundEvent &event, events) {
+        AudioBuffer *buffer = sounds.value(event.name);
+        if (!buffer) {
+            qWarning("Unknown sound %s", qPrintable(event.name));
+            return 1;
+        }
+
+        if (measureDuration) {
+            if (event.loopCount < 0) {
+                qWarning("A sound looping forever needs a duration, use -d");
+                return 1;
+            }
+            duration = qMax(duration, event.time +
+                            bufferDuration(buffer) / event.speed *
+                            qMax(event.loopCount, 1));
+        }
+    }
+
+    AudioMixer mixer;
+    OfflineAudioOut out(&mixer, 0, blockLength);
+    if (!outputPath.isEmpty() && !out.setWavFile(outputPath)) {
+        qWarning("Could not write %s", qPrintable(outputPath));
+        return 1;
+    }
+
+    const qint64 length = qRound64(duration * AUDIO_FREQUENCY) *
+            AUDIO_CHANNELS;
+    const double lookahead = (double)out.blockLength() * LOOKAHEAD_BLOCKS /
+            AUDIO_CHANNELS / AUDIO_FREQUENCY;
+
+    QVector<qint64> mixTimes;
+    mixTimes.reserve(length / out.blockLength() + 1);
+
+    int next = 0;
+    while (out.samplesRendered() < length) {
+        // The voices are posted shortly before they start, so that the
+        // voice pool is not filled with sounds waiting to play.
+        const double horizon = mixer.time() + lookahead;
+        while (next < events.count() && events.at(next).time < horizon) {
+            const SoundEvent &event = events.at(next++);
+            if (!mixer.playVoiceAt(event.time, sounds.value(event.name),
+                                   event.volume, event.speed,
+                                   event.loopCount)) {
+                qWarning("Could not play %s at %.3f s",
+                         qPrintable(event.name), event.time);
+            }
+        }
+
+        out.tick();
+        mixTimes.append(out.lastMixTime());
+    }
+
+    out.closeWavFile();
+
+    if (mixTimes.isEmpty()) {
+        qWarning("Nothing to render");
+        return 1;
+    }
+
+    qSort(mixTimes);
+    const double seconds = (double)out.samplesRendered() / AUDIO_CHANNELS /
+            AUDIO_FREQUENCY;
+    const int blocks = mixTimes.count();
+
+    printf("%d events, %d blocks of %d samples, %.3f s of audio\n",
+           events.count(), blocks, out.blockLength(), seconds);
+    printf("mix time per block: mean %.1f us, median %.1f us, "
+           "99th percentile %.1f us, max %.1f us\n",
+           out.totalMixTime() / 1000.0 / blocks,
+           mixTimes.at(blocks / 2) / 1000.0,
+           mixTimes.at(qMin(blocks - 1, blocks * 99 / 100)) / 1000.0,
+           out.maxMixTime() / 1000.0);
+    if (out.totalMixTime() > 0) {
+        printf("%.1fx real time\n", seconds * 1.0e9 / out.totalMixTime());
+    }
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Benchmark for the geometry building of the bundled Qt3D, measures
+# QGLBuilder for spheres and the teapot with QBENCHMARK. Run it on the
+# desktop or the device: builderbench -iterations 20
+
+
+TARGET = builderbench
+TEMPLATE = app
+
+CONFIG += console qtestlib
+CONFIG -= app_bundle
+
+include(../../qt3d/qt3d.pri)
+
+SOURCES += \
+    main.cpp
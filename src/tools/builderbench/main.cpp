@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QtTest/QtTest>
+#include <qglbuilder.h>
+#include <qglscenenode.h>
+#include <qglsphere.h>
+#include <qglteapot.h>
+
+// Subdivision depths of the benchmarked spheres.
+static const int MIN_DEPTH = 3;
+static const int MAX_DEPTH = 6;
+
+
+/*!
+  \class BuilderBench
+  \brief Benchmarks building the geometry of spheres and the teapot with
+         QGLBuilder. The vertices are welded as they are added to the
+         builder, and finalizedSceneNode() creates the scene nodes, so
+         both are measured.
+*/
+class BuilderBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void build_data();
+    void build();
+};
+
+
+/*!
+  Adds a row for each sphere depth and one for the teapot, which has
+  the depth zero.
+*/
+void BuilderBench::build_data()
+{
+    QTest::addColumn<int>("depth");
+
+    for (int depth = MIN_DEPTH; depth <= MAX_DEPTH; depth++) {
+        QByteArray name = "sphere depth " + QByteArray::number(depth);
+        QTest::newRow(name.constData()) << depth;
+    }
+    QTest::newRow("teapot") << 0;
+}
+
+
+/*!
+  Builds the sphere of the given depth or the teapot.
+*/
+void BuilderBench::build()
+{
+    QFETCH(int, depth);
+
+    QBENCHMARK {
+        QGLBuilder builder;
+        if (depth > 0) {
+            builder << QGLSphere(1.0, depth);
+        } else {
+            builder << QGLTeapot();
+        }
+        delete builder.finalizedSceneNode();
+    }
+}
+
+
+QTEST_MAIN(BuilderBench)
+
+#include "main.moc"
@@ -0,0 +1,22 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Benchmark for the GE audio effects, prints the cost of each effect per
+# block of 1024 frames. Run it on the desktop or the device: effectbench
+
+
+TARGET = effectbench
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+GE_PATH = $$PWD/../../geaudio
+include(../../geaudio/qtgameenableraudio.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cutoffeffect.h"
+#include "echoeffect.h"
+#include "filtereffect.h"
+
+using namespace GE;
+
+// Frames per processed block.
+static const int FRAMES = 1024;
+
+// Blocks processed per run, the fastest run is reported.
+static const int BLOCKS = 1000;
+static const int RUNS = 5;
+
+
+/*!
+  Processes blocks of noise with \a effect and prints the fastest time per
+  block.
+*/
+static void benchmark(const char *name, AudioEffect *effect,
+                      const QVector<AUDIO_SAMPLE_TYPE> &input)
+{
+    QVector<AUDIO_SAMPLE_TYPE> block(input.count());
+    qint64 best = -1;
+
+    for (int run = 0; run < RUNS; run++) {
+        effect->flush();
+        qint64 elapsed = 0;
+
+        for (int i = 0; i < BLOCKS; i++) {
+            memcpy(block.data(), input.constData(),
+                   input.count() * sizeof(AUDIO_SAMPLE_TYPE));
+
+            QElapsedTimer timer;
+            timer.start();
+            effect->process(block.data(), block.count());
+            elapsed += timer.nsecsElapsed();
+        }
+
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    const double perBlock = best / 1000.0 / BLOCKS;
+    const double blockTime = FRAMES * 1000000.0 / AUDIO_FREQUENCY;
+    printf("%-16s %8.2f us per %d frames, %6.2f %% of real time\n", name,
+           perBlock, FRAMES, perBlock * 100.0 / blockTime);
+}
+
+
+/*!
+  Runs every effect over blocks of FRAMES stereo frames of noise and prints
+  the cost per block.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QVector<AUDIO_SAMPLE_TYPE> input(FRAMES * AUDIO_CHANNELS);
+    srand(1);
+    for (int i = 0; i < input.count(); i++) {
+        input[i] = (AUDIO_SAMPLE_TYPE)(rand() % 20000 - 10000);
+    }
+
+    EchoEffect echo;
+    echo.setDelay(0.25f);
+    benchmark("echo", &echo, input);
+
+    CutOffEffect cutOff;
+    cutOff.setResonance(0.5f);
+    benchmark("cutoff", &cutOff, input);
+
+    FilterEffect lowPass(FilterEffect::LowPass);
+    benchmark("biquad lowpass", &lowPass, input);
+
+    FilterEffect bandPass(FilterEffect::BandPass);
+    bandPass.setQ(2.0f);
+    benchmark("biquad bandpass", &bandPass, input);
+
+    FilterEffect onePole(FilterEffect::OnePoleLowPass);
+    benchmark("one-pole", &onePole, input);
+
+    return 0;
+}
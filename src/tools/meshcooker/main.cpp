@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QUrl>
+#include <qglabstractscene.h>
+#include <qglmaterial.h>
+#include <qglmaterialcollection.h>
+#include <qglscenenode.h>
+#include "qglmeshscene.h"
+#include "qglmeshwriter.h"
+
+
+/*!
+  Returns the name of the material of \a node at \a index. The material
+  indices of a loaded mesh refer to its own palette, so the materials are
+  compared by name.
+*/
+static QString materialName(QGLSceneNode *node, int index)
+{
+    QGLMaterial *material =
+            node->palette() ? node->palette()->material(index) : 0;
+    return material ? material->objectName() : QString();
+}
+
+
+/*!
+  Returns true if the geometry \a loaded holds the same vertex fields and
+  indices as \a original.
+*/
+static bool sameGeometry(const QGeometryData &original,
+                         const QGeometryData &loaded)
+{
+    if (original.count() != loaded.count() ||
+            original.indices() != loaded.indices()) {
+        return false;
+    }
+
+    for (int field = 0; field <= QGL::TextureCoord2; field++) {
+        QGL::VertexAttribute attribute = QGL::VertexAttribute(field);
+        if (original.hasField(attribute) != loaded.hasField(attribute)) {
+            return false;
+        }
+        if (!original.hasField(attribute)) {
+            continue;
+        }
+
+        bool same;
+        if (attribute == QGL::Position) {
+            same = original.vertices() == loaded.vertices();
+        } else if (attribute == QGL::Normal) {
+            same = original.normals() == loaded.normals();
+        } else if (attribute == QGL::Color) {
+            same = original.colors() == loaded.colors();
+        } else {
+            same = original.texCoords(attribute) ==
+                    loaded.texCoords(attribute);
+        }
+        if (!same) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+  Returns true if the node tree \a loaded from a .qmesh file matches the
+  exported tree \a original. Prints the first difference.
+*/
+static bool sameNodes(QGLSceneNode *original, QGLSceneNode *loaded)
+{
+    QString name = original->objectName();
+    if (loaded->objectName() != name ||
+            loaded->start() != original->start() ||
+            loaded->count() != original->count() ||
+            loaded->drawingMode() != original->drawingMode() ||
+            loaded->options() != original->options() ||
+            !qFuzzyCompare(loaded->position(), original->position()) ||
+            !qFuzzyCompare(loaded->localTransform(),
+                           original->localTransform())) {
+        qWarning("The node %s differs", qPrintable(name));
+        return false;
+    }
+
+    if (materialName(loaded, loaded->materialIndex()) !=
+            materialName(original, original->materialIndex()) ||
+            materialName(loaded, loaded->backMaterialIndex()) !=
+            materialName(original, original->backMaterialIndex())) {
+        qWarning("The materials of the node %s differ", qPrintable(name));
+        return false;
+    }
+
+    if (original->geometry().count() > 0 &&
+            !sameGeometry(original->geometry(), loaded->geometry())) {
+        qWarning("The geometry of the node %s differs", qPrintable(name));
+        return false;
+    }
+
+    QList<QGLSceneNode*> originalChildren = original->children();
+    QList<QGLSceneNode*> loadedChildren = loaded->children();
+    if (originalChildren.count() != loadedChildren.count()) {
+        qWarning("The children of the node %s differ", qPrintable(name));
+        return false;
+    }
+    for (int i = 0; i < originalChildren.count(); i++) {
+        if (!sameNodes(originalChildren.at(i), loadedChildren.at(i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*!
+  Loads the written .qmesh file at \a path and compares it with the
+  exported tree \a root.
+*/
+static bool verify(QGLSceneNode *root, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QGLMeshScene scene;
+    if (!scene.load(&file, QUrl::fromLocalFile(path))) {
+        qWarning("The written file could not be loaded");
+        return false;
+    }
+
+    return sameNodes(root, scene.mainNode());
+}
+
+/*!
+  Exports the models given on the command line into .qmesh files next to the
+  models, or into the directory given with -o. Any model that Qt3D can load
+  can be exported. Each written file is loaded back and compared with the
+  exported model.
+*/
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv, false);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    QString outputDir;
+    int index = arguments.indexOf("-o");
+    if (index >= 0 && index + 1 < arguments.count()) {
+        outputDir = arguments.at(index + 1);
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+    }
+
+    if (arguments.isEmpty()) {
+        qWarning("Usage: meshcooker [-o outdir] models...");
+        return 1;
+    }
+
+    int result = 0;
+    foreach (const QString &path, arguments) {
+        QGLAbstractScene *scene = QGLAbstractScene::loadScene(path);
+        if (!scene || !scene->mainNode()) {
+            qWarning("Could not load the model %s", qPrintable(path));
+            delete scene;
+            result = 1;
+            continue;
+        }
+
+        QFileInfo info(path);
+        QDir dir = outputDir.isEmpty() ? info.dir() : QDir(outputDir);
+        QString outputPath = dir.filePath(info.completeBaseName() + ".qmesh");
+
+        QByteArray data = QGLMeshWriter::write(
+                    scene->mainNode(),
+                    QUrl::fromLocalFile(QFileInfo(outputPath).absoluteFilePath()));
+
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) < 0) {
+            qWarning("Could not write %s", qPrintable(outputPath));
+            delete scene;
+            result = 1;
+            continue;
+        }
+        file.close();
+
+        if (!verify(scene->mainNode(), outputPath)) {
+            qWarning("Verifying %s failed", qPrintable(outputPath));
+            result = 1;
+        }
+        delete scene;
+    }
+
+    return result;
+}
@@ -0,0 +1,30 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Offline tool that exports the game models into .qmesh files and checks
+# that they load back unchanged, run it on the desktop:
+# meshcooker -o ../../gfx ../../gfx/*.obj
+
+
+TARGET = meshcooker
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../qt3d/qt3d.pri)
+
+# The writer is only needed offline, the reader is part of the Qt3D sources.
+MESH_PATH = ../../qt3d/src/plugins/sceneformats/mesh
+INCLUDEPATH += $$MESH_PATH
+
+SOURCES += \
+    main.cpp \
+    $$MESH_PATH/qglmeshwriter.cpp
+
+HEADERS += \
+    $$MESH_PATH/qglmeshwriter.h
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <qmath.h>
+#include <assimp.hpp>
+#include <aiScene.h>
+
+// Number of imports per file, the fastest one is reported.
+static const int RUNS = 5;
+
+
+/*!
+  Writes a grid of about the given number of triangles with positions,
+  texture coordinates and normals to an OBJ file.
+*/
+static bool writeSyntheticObj(const QString &fileName, int triangles)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    const int size = qMax(1, int(qSqrt(triangles / 2)));
+    const int stride = size + 1;
+
+    QTextStream stream(&file);
+    stream.setRealNumberNotation(QTextStream::FixedNotation);
+    stream.setRealNumberPrecision(6);
+    stream << "o grid\n";
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            stream << "v " << x * 0.1 << ' ' << y * 0.1 << ' '
+                   << ((x * 7 + y * 13) % 17) * 0.01 << '\n';
+        }
+    }
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            stream << "vt " << qreal(x) / size << ' ' << qreal(y) / size
+                   << '\n';
+        }
+    }
+    stream << "vn 0 0 1\n";
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int a = y * stride + x + 1;
+            int b = a + 1;
+            int c = a + stride;
+            int d = c + 1;
+            stream << "f " << a << '/' << a << "/1 " << b << '/' << b
+                   << "/1 " << d << '/' << d << "/1\n";
+            stream << "f " << a << '/' << a << "/1 " << d << '/' << d
+                   << "/1 " << c << '/' << c << "/1\n";
+        }
+    }
+
+    return stream.status() == QTextStream::Ok;
+}
+
+
+/*!
+  Imports the OBJ files given on the command line without post processing
+  and prints the fastest import time of each. With -synthetic <triangles> a
+  generated model is imported instead.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    int index = arguments.indexOf("-synthetic");
+    if (index >= 0 && index + 1 < arguments.count()) {
+        QString fileName = QDir::temp().filePath("objbench-synthetic.obj");
+        if (!writeSyntheticObj(fileName, arguments.at(index + 1).toInt())) {
+            qWarning("Could not write %s", qPrintable(fileName));
+            return 1;
+        }
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+        arguments.append(fileName);
+    }
+
+    if (arguments.isEmpty()) {
+        qWarning("Usage: objbench [-synthetic triangles] files...");
+        return 1;
+    }
+
+    int result = 0;
+    foreach (const QString &path, arguments) {
+        qint64 best = -1;
+        unsigned int faces = 0;
+        for (int run = 0; run < RUNS; run++) {
+            Assimp::Importer importer;
+            QElapsedTimer timer;
+            timer.start();
+            const aiScene *scene =
+                    importer.ReadFile(QFile::encodeName(path).constData(), 0);
+            qint64 elapsed = timer.nsecsElapsed();
+            if (!scene) {
+                qWarning("Could not import %s: %s", qPrintable(path),
+                         importer.GetErrorString());
+                result = 1;
+                break;
+            }
+
+            faces = 0;
+            for (unsigned int mesh = 0; mesh < scene->mNumMeshes; mesh++) {
+                faces += scene->mMeshes[mesh]->mNumFaces;
+            }
+            if (best < 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+
+        if (best >= 0) {
+            printf("%s: %u faces, %.3f ms\n", qPrintable(path), faces,
+                   best / 1000000.0);
+        }
+    }
+
+    return result;
+}
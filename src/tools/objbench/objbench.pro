@@ -0,0 +1,24 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Benchmark for the OBJ importer of the bundled Assimp, run it on the
+# desktop: objbench ../../gfx/level.obj
+# or with a generated model of about a million triangles:
+# objbench -synthetic 1000000
+
+
+TARGET = objbench
+TEMPLATE = app
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../qt3d/3rdparty/assimp/assimp.pri)
+
+SOURCES += \
+    main.cpp
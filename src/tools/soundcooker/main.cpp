@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include "audiobuffer.h"
+#include "soundbank.h"
+
+using namespace GE;
+
+/*!
+  Converts the .wav files given on the command line into the native format
+  of the mixer and writes them into the sound bank given with -o. The
+  sounds are named after the files without the suffix.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    QString outputPath;
+    int index = arguments.indexOf("-o");
+    if (index >= 0 && index + 1 < arguments.count()) {
+        outputPath = arguments.at(index + 1);
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+    }
+
+    if (outputPath.isEmpty() || arguments.isEmpty()) {
+        qWarning("Usage: soundcooker -o bank.gesb sounds.wav...");
+        return 1;
+    }
+
+    QStringList names;
+    QList<AudioBuffer*> buffers;
+    int result = 0;
+
+    foreach (const QString &path, arguments) {
+        AudioBuffer *buffer = AudioBuffer::loadWav(path, &app, true);
+        if (!buffer || !buffer->isNativeFormat()) {
+            qWarning("Could not convert the sound %s", qPrintable(path));
+            result = 1;
+            continue;
+        }
+
+        names.append(QFileInfo(path).completeBaseName());
+        buffers.append(buffer);
+    }
+
+    QByteArray data = SoundBank::write(names, buffers);
+    if (data.isEmpty()) {
+        qWarning("No sounds to write");
+        return 1;
+    }
+
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) < 0) {
+        qWarning("Could not write %s", qPrintable(outputPath));
+        return 1;
+    }
+
+    return result;
+}
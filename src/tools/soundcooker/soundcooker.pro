@@ -0,0 +1,22 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Offline tool that cooks the game sounds into a .gesb sound bank, run it
+# on the desktop: soundcooker -o ../../audio/sounds.gesb ../../audio/*.wav
+
+
+TARGET = soundcooker
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+GE_PATH = $$PWD/../../geaudio
+include(../../geaudio/qtgameenableraudio.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,328 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <limits.h>
+#include <QtCore/qmath.h>
+#include "blockencoder.h"
+
+// ETC1 intensity modifier tables, the columns are in the order of the
+// pixel index values.
+static const int Etc1Modifiers[8][4] = {
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+
+static inline int clampByte(int value)
+{
+    return qBound(0, value, 255);
+}
+
+
+static inline int colorDistance(int r1, int g1, int b1, int r2, int g2, int b2)
+{
+    return (r1 - r2) * (r1 - r2) + (g1 - g2) * (g1 - g2) +
+           (b1 - b2) * (b1 - b2);
+}
+
+
+/*!
+  Fits one ETC1 sub-block in the individual mode. The base color is the
+  average of the pixels quantized to 4 bits per channel, and the modifier
+  table with the lowest error is chosen. Returns the error of the fit.
+*/
+static int fitEtc1SubBlock(const QRgb *pixels, const int *members,
+                           int *base, int *table, int *indices)
+{
+    int sum[3] = { 0, 0, 0 };
+    for (int i = 0; i < 8; i++) {
+        QRgb pixel = pixels[members[i]];
+        sum[0] += qRed(pixel);
+        sum[1] += qGreen(pixel);
+        sum[2] += qBlue(pixel);
+    }
+
+    int color[3];
+    for (int c = 0; c < 3; c++) {
+        base[c] = qBound(0, (sum[c] + 8 * 17 / 2) / (8 * 17), 15);
+        color[c] = base[c] * 17;
+    }
+
+    int bestError = INT_MAX;
+    for (int t = 0; t < 8; t++) {
+        int error = 0;
+        int tableIndices[8];
+        for (int i = 0; i < 8 && error < bestError; i++) {
+            QRgb pixel = pixels[members[i]];
+            int bestPixelError = INT_MAX;
+            for (int m = 0; m < 4; m++) {
+                int modifier = Etc1Modifiers[t][m];
+                int pixelError = colorDistance(
+                            clampByte(color[0] + modifier),
+                            clampByte(color[1] + modifier),
+                            clampByte(color[2] + modifier),
+                            qRed(pixel), qGreen(pixel), qBlue(pixel));
+                if (pixelError < bestPixelError) {
+                    bestPixelError = pixelError;
+                    tableIndices[i] = m;
+                }
+            }
+            error += bestPixelError;
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            *table = t;
+            for (int i = 0; i < 8; i++) {
+                indices[i] = tableIndices[i];
+            }
+        }
+    }
+
+    return bestError;
+}
+
+
+void encodeEtc1Block(const QRgb *pixels, uchar *out)
+{
+    // Try both the vertical (2x4) and horizontal (4x2) sub-block split.
+    quint32 bestHigh = 0;
+    quint32 bestLow = 0;
+    int bestError = INT_MAX;
+
+    for (int flip = 0; flip < 2; flip++) {
+        int members[2][8];
+        int counts[2] = { 0, 0 };
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int sub = flip ? (y >= 2) : (x >= 2);
+                members[sub][counts[sub]++] = y * 4 + x;
+            }
+        }
+
+        int base[2][3];
+        int table[2];
+        int indices[2][8];
+        int error = 0;
+        for (int sub = 0; sub < 2; sub++) {
+            error += fitEtc1SubBlock(pixels, members[sub], base[sub],
+                                     &table[sub], indices[sub]);
+        }
+
+        if (error >= bestError) {
+            continue;
+        }
+        bestError = error;
+
+        bestHigh = (base[0][0] << 28) | (base[1][0] << 24) |
+                   (base[0][1] << 20) | (base[1][1] << 16) |
+                   (base[0][2] << 12) | (base[1][2] << 8) |
+                   (table[0] << 5) | (table[1] << 2) | flip;
+
+        // The pixel indices are stored in column order, the most
+        // significant bits in the upper half.
+        bestLow = 0;
+        for (int sub = 0; sub < 2; sub++) {
+            for (int i = 0; i < 8; i++) {
+                int pixel = members[sub][i];
+                int bit = (pixel % 4) * 4 + pixel / 4;
+                int index = indices[sub][i];
+                bestLow |= quint32(index >> 1) << (16 + bit);
+                bestLow |= quint32(index & 1) << bit;
+            }
+        }
+    }
+
+    // ETC1 blocks are stored in big-endian order.
+    for (int i = 0; i < 4; i++) {
+        out[i] = uchar(bestHigh >> (24 - i * 8));
+        out[4 + i] = uchar(bestLow >> (24 - i * 8));
+    }
+}
+
+
+static inline quint16 toRgb565(const float *color)
+{
+    int r = qBound(0, qRound(color[0] * 31.0f / 255.0f), 31);
+    int g = qBound(0, qRound(color[1] * 63.0f / 255.0f), 63);
+    int b = qBound(0, qRound(color[2] * 31.0f / 255.0f), 31);
+    return quint16((r << 11) | (g << 5) | b);
+}
+
+
+static inline void fromRgb565(quint16 value, int *color)
+{
+    int r = (value >> 11) & 31;
+    int g = (value >> 5) & 63;
+    int b = value & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+
+/*!
+  Writes the 8 byte color part of a DXT block. The end points are the
+  extremes of the pixels along their principal axis, and the block is
+  always encoded in the four color mode.
+*/
+static void encodeDxtColorBlock(const QRgb *pixels, uchar *out)
+{
+    float mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        mean[0] += qRed(pixels[i]);
+        mean[1] += qGreen(pixels[i]);
+        mean[2] += qBlue(pixels[i]);
+    }
+    for (int c = 0; c < 3; c++) {
+        mean[c] /= 16.0f;
+    }
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        float r = qRed(pixels[i]) - mean[0];
+        float g = qGreen(pixels[i]) - mean[1];
+        float b = qBlue(pixels[i]) - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+
+    // Find the principal axis with a few power iterations.
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 4; iteration++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = qMax(qAbs(x), qMax(qAbs(y), qAbs(z)));
+        if (length <= 0.0f) {
+            break;
+        }
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    float minDot = 0.0f;
+    float maxDot = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float dot = (qRed(pixels[i]) - mean[0]) * axis[0] +
+                    (qGreen(pixels[i]) - mean[1]) * axis[1] +
+                    (qBlue(pixels[i]) - mean[2]) * axis[2];
+        minDot = qMin(minDot, dot);
+        maxDot = qMax(maxDot, dot);
+    }
+
+    float lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] +
+                          axis[2] * axis[2];
+    float end0[3];
+    float end1[3];
+    for (int c = 0; c < 3; c++) {
+        float scale = lengthSquared > 0.0f ? axis[c] / lengthSquared : 0.0f;
+        end0[c] = mean[c] + maxDot * scale;
+        end1[c] = mean[c] + minDot * scale;
+    }
+
+    quint16 color0 = toRgb565(end0);
+    quint16 color1 = toRgb565(end1);
+    if (color0 < color1) {
+        qSwap(color0, color1);
+    }
+
+    quint32 indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        fromRgb565(color0, palette[0]);
+        fromRgb565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int bestIndex = 0;
+            int bestError = INT_MAX;
+            for (int p = 0; p < 4; p++) {
+                int error = colorDistance(palette[p][0], palette[p][1],
+                                          palette[p][2], qRed(pixels[i]),
+                                          qGreen(pixels[i]), qBlue(pixels[i]));
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= quint32(bestIndex) << (i * 2);
+        }
+    }
+
+    out[0] = uchar(color0);
+    out[1] = uchar(color0 >> 8);
+    out[2] = uchar(color1);
+    out[3] = uchar(color1 >> 8);
+    for (int i = 0; i < 4; i++) {
+        out[4 + i] = uchar(indices >> (i * 8));
+    }
+}
+
+
+void encodeDxt1Block(const QRgb *pixels, uchar *out)
+{
+    encodeDxtColorBlock(pixels, out);
+}
+
+
+void encodeDxt5Block(const QRgb *pixels, uchar *out)
+{
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = qMax(alpha0, qAlpha(pixels[i]));
+        alpha1 = qMin(alpha1, qAlpha(pixels[i]));
+    }
+
+    // Eight interpolated alpha values, alpha0 > alpha1 selects that mode.
+    quint64 indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8];
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int bestIndex = 0;
+            int bestError = INT_MAX;
+            for (int p = 0; p < 8; p++) {
+                int error = qAbs(palette[p] - qAlpha(pixels[i]));
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= quint64(bestIndex) << (i * 3);
+        }
+    }
+
+    out[0] = uchar(alpha0);
+    out[1] = uchar(alpha1);
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = uchar(indices >> (i * 8));
+    }
+
+    encodeDxtColorBlock(pixels, out + 8);
+}
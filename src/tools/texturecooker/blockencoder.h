@@ -0,0 +1,30 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef BLOCKENCODER_H
+#define BLOCKENCODER_H
+
+#include <QtGlobal>
+#include <QRgb>
+
+/*
+  Encoders for a single block of 4x4 pixels. The pixels are given in row
+  order, and the encoded block is written to the output in the byte order
+  expected by the GL.
+*/
+
+// Writes 8 bytes of ETC1 data, the alpha of the pixels is ignored.
+void encodeEtc1Block(const QRgb *pixels, uchar *out);
+
+// Writes 8 bytes of DXT1 (S3TC) data, the alpha of the pixels is ignored.
+void encodeDxt1Block(const QRgb *pixels, uchar *out);
+
+// Writes 16 bytes of DXT5 (S3TC) data.
+void encodeDxt5Block(const QRgb *pixels, uchar *out);
+
+#endif // BLOCKENCODER_H
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QStringList>
+#include "texturecooker.h"
+
+/*!
+  Cooks the images given on the command line into .qtex containers next to
+  the images, or into the directory given with -o. With -rgba an
+  uncompressed RGBA encoding is added for GLs without texture compression.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+
+    QString outputDir;
+    int index = arguments.indexOf("-o");
+    if (index >= 0 && index + 1 < arguments.count()) {
+        outputDir = arguments.at(index + 1);
+        arguments.removeAt(index + 1);
+        arguments.removeAt(index);
+    }
+
+    bool rgbaFallback = arguments.removeAll("-rgba") > 0;
+
+    if (arguments.isEmpty()) {
+        qWarning("Usage: texturecooker [-o outdir] [-rgba] images...");
+        return 1;
+    }
+
+    TextureCooker cooker;
+    cooker.setRgbaFallback(rgbaFallback);
+    int result = 0;
+    foreach (const QString &path, arguments) {
+        QImage image(path);
+        if (image.isNull()) {
+            qWarning("Could not read the image %s", qPrintable(path));
+            result = 1;
+            continue;
+        }
+
+        QFileInfo info(path);
+        QDir dir = outputDir.isEmpty() ? info.dir() : QDir(outputDir);
+        QString outputPath = dir.filePath(info.completeBaseName() + ".qtex");
+
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly) ||
+                file.write(cooker.cook(image)) < 0) {
+            qWarning("Could not write %s", qPrintable(outputPath));
+            result = 1;
+            continue;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,349 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#include "blockencoder.h"
+#include "texturecooker.h"
+
+// The container and image layouts must match the loaders in
+// qt3d/src/threed/textures/qgltextureutils.cpp.
+static const quint32 CookedVersion = 1;
+static const quint32 CookedHasAlpha = 0x00000001;
+static const quint32 CookedHeaderSize = 16;
+static const quint32 CookedEntrySize = 12;
+
+static const quint32 EncodingEtc1 = 0x31435445;     // "ETC1"
+static const quint32 EncodingDxt1 = 0x31545844;     // "DXT1"
+static const quint32 EncodingDxt5 = 0x35545844;     // "DXT5"
+static const quint32 EncodingRgba = 0x41424752;     // "RGBA"
+
+static const quint32 PvrMagic = 0x21525650;         // "PVR!"
+static const quint32 PvrHeaderSize = 52;
+static const quint32 PvrFormatRgba8888 = 0x00000012;
+static const quint32 PvrFormatEtc1 = 0x00000036;
+static const quint32 PvrHasMipmaps = 0x00000100;
+static const quint32 PvrAlphaInTexture = 0x00008000;
+static const quint32 PvrVerticalFlip = 0x00010000;
+
+static const quint32 DdsHeaderSize = 124;
+static const quint32 DdsFlags = 0x000A1007;         // Caps, size, pixel format,
+                                                    // mipmap count, linear size
+static const quint32 DdsPixelFormatSize = 32;
+static const quint32 DdsPixelFormatFourCC = 0x00000004;
+static const quint32 DdsCaps = 0x00401008;          // Texture, mipmap, complex
+
+
+static inline void appendUInt32(QByteArray &data, quint32 value)
+{
+    data.append(char(value));
+    data.append(char(value >> 8));
+    data.append(char(value >> 16));
+    data.append(char(value >> 24));
+}
+
+
+static inline int nextPowerOfTwo(int value)
+{
+    int result = 1;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+
+/*!
+  \class TextureCooker
+  \brief Converts images offline into cooked texture containers (.qtex),
+         which QGLTexture2D::setCompressedFile() uploads without decoding
+         or scaling the image at run time.
+
+         The container holds the texture in the ETC1 (opaque images only)
+         and DXT1 or DXT5 encodings, each with the full mipmap chain down to
+         1x1. The loader picks the first encoding the GL supports. When it
+         supports none, the loader refuses the container and the game falls
+         back to the source image, so an uncompressed RGBA encoding, which
+         would be several times the size of the image file, is only written
+         last when enabled with setRgbaFallback().
+*/
+
+
+/*!
+  Constructor.
+*/
+TextureCooker::TextureCooker()
+    : m_RgbaFallback(false)
+{
+}
+
+
+/*!
+  Sets whether an uncompressed RGBA encoding is written as the last entry,
+  for when the source image is not shipped next to the container.
+*/
+void TextureCooker::setRgbaFallback(bool enabled)
+{
+    m_RgbaFallback = enabled;
+}
+
+
+/*!
+  Returns true if an uncompressed RGBA encoding is written.
+*/
+bool TextureCooker::rgbaFallback() const
+{
+    return m_RgbaFallback;
+}
+
+
+/*!
+  Returns the cooked container of the image, or an empty array if the
+  image is null.
+*/
+QByteArray TextureCooker::cook(const QImage &image) const
+{
+    if (image.isNull()) {
+        return QByteArray();
+    }
+
+    QList<QImage> levels = mipChain(image);
+
+    bool hasAlpha = false;
+    if (image.hasAlphaChannel()) {
+        const QImage &base = levels.first();
+        for (int y = 0; y < base.height() && !hasAlpha; y++) {
+            const QRgb *line = reinterpret_cast<const QRgb*>(
+                        base.constScanLine(y));
+            for (int x = 0; x < base.width(); x++) {
+                if (qAlpha(line[x]) != 255) {
+                    hasAlpha = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    QList<quint32> encodings;
+    QList<QByteArray> entries;
+    if (!hasAlpha) {
+        encodings.append(EncodingEtc1);
+        entries.append(encodePvr(levels, Etc1Encoding, false));
+        encodings.append(EncodingDxt1);
+        entries.append(encodeDds(levels, Dxt1Encoding));
+    }
+    else {
+        encodings.append(EncodingDxt5);
+        entries.append(encodeDds(levels, Dxt5Encoding));
+    }
+    if (m_RgbaFallback) {
+        encodings.append(EncodingRgba);
+        entries.append(encodePvr(levels, RgbaEncoding, hasAlpha));
+    }
+
+    QByteArray data("QTEX");
+    appendUInt32(data, CookedVersion);
+    appendUInt32(data, hasAlpha ? CookedHasAlpha : 0);
+    appendUInt32(data, entries.count());
+
+    quint32 offset = CookedHeaderSize + entries.count() * CookedEntrySize;
+    for (int i = 0; i < entries.count(); i++) {
+        appendUInt32(data, encodings[i]);
+        appendUInt32(data, offset);
+        appendUInt32(data, entries[i].size());
+        offset += entries[i].size();
+    }
+
+    foreach (const QByteArray &entry, entries) {
+        data.append(entry);
+    }
+
+    return data;
+}
+
+
+/*!
+  Returns the mipmap levels of the image. The image is scaled to power of
+  two dimensions and mirrored, so that the first row of each level is the
+  bottom row of the texture as the GL expects.
+*/
+QList<QImage> TextureCooker::mipChain(const QImage &image) const
+{
+    QImage level = image.convertToFormat(QImage::Format_ARGB32);
+
+    QSize size(nextPowerOfTwo(level.width()), nextPowerOfTwo(level.height()));
+    if (size != level.size()) {
+        level = level.scaled(size, Qt::IgnoreAspectRatio,
+                             Qt::SmoothTransformation);
+    }
+    level = level.mirrored(false, true);
+
+    QList<QImage> levels;
+    levels.append(level);
+    while (level.width() > 1 || level.height() > 1) {
+        level = level.scaled(qMax(level.width() / 2, 1),
+                             qMax(level.height() / 2, 1),
+                             Qt::IgnoreAspectRatio,
+                             Qt::SmoothTransformation);
+        levels.append(level);
+    }
+
+    return levels;
+}
+
+
+/*!
+  Returns the levels as a PVR image in the ETC1 or RGBA encoding.
+*/
+QByteArray TextureCooker::encodePvr(const QList<QImage> &levels,
+                                    Encoding encoding, bool hasAlpha) const
+{
+    QByteArray pixels;
+    foreach (const QImage &level, levels) {
+        if (encoding == RgbaEncoding) {
+            for (int y = 0; y < level.height(); y++) {
+                const QRgb *line = reinterpret_cast<const QRgb*>(
+                            level.constScanLine(y));
+                for (int x = 0; x < level.width(); x++) {
+                    pixels.append(char(qRed(line[x])));
+                    pixels.append(char(qGreen(line[x])));
+                    pixels.append(char(qBlue(line[x])));
+                    pixels.append(char(qAlpha(line[x])));
+                }
+            }
+        }
+        else {
+            pixels.append(encodeBlocks(level, encoding));
+        }
+    }
+
+    const QImage &base = levels.first();
+    quint32 flags = PvrVerticalFlip;
+    flags |= (encoding == RgbaEncoding) ? PvrFormatRgba8888 : PvrFormatEtc1;
+    if (levels.count() > 1) {
+        flags |= PvrHasMipmaps;
+    }
+    if (hasAlpha) {
+        flags |= PvrAlphaInTexture;
+    }
+
+    QByteArray data;
+    appendUInt32(data, PvrHeaderSize);
+    appendUInt32(data, base.height());
+    appendUInt32(data, base.width());
+    appendUInt32(data, levels.count() - 1);
+    appendUInt32(data, flags);
+    appendUInt32(data, pixels.size());
+    appendUInt32(data, encoding == RgbaEncoding ? 32 : 4);
+    if (encoding == RgbaEncoding) {
+        appendUInt32(data, 0x000000FF);
+        appendUInt32(data, 0x0000FF00);
+        appendUInt32(data, 0x00FF0000);
+        appendUInt32(data, hasAlpha ? 0xFF000000 : 0);
+    }
+    else {
+        appendUInt32(data, 0);
+        appendUInt32(data, 0);
+        appendUInt32(data, 0);
+        appendUInt32(data, 0);
+    }
+    appendUInt32(data, PvrMagic);
+    appendUInt32(data, 1);
+    data.append(pixels);
+
+    return data;
+}
+
+
+/*!
+  Returns the levels as a DDS image in the DXT1 or DXT5 encoding.
+*/
+QByteArray TextureCooker::encodeDds(const QList<QImage> &levels,
+                                    Encoding encoding) const
+{
+    QByteArray pixels;
+    int baseSize = 0;
+    foreach (const QImage &level, levels) {
+        pixels.append(encodeBlocks(level, encoding));
+        if (!baseSize) {
+            baseSize = pixels.size();
+        }
+    }
+
+    const QImage &base = levels.first();
+    QByteArray data("DDS ");
+    appendUInt32(data, DdsHeaderSize);
+    appendUInt32(data, DdsFlags);
+    appendUInt32(data, base.height());
+    appendUInt32(data, base.width());
+    appendUInt32(data, baseSize);
+    appendUInt32(data, 0);
+    appendUInt32(data, levels.count());
+    for (int i = 0; i < 11; i++) {
+        appendUInt32(data, 0);
+    }
+
+    appendUInt32(data, DdsPixelFormatSize);
+    appendUInt32(data, DdsPixelFormatFourCC);
+    appendUInt32(data, encoding == Dxt1Encoding ? EncodingDxt1 : EncodingDxt5);
+    for (int i = 0; i < 5; i++) {
+        appendUInt32(data, 0);
+    }
+
+    appendUInt32(data, DdsCaps);
+    for (int i = 0; i < 4; i++) {
+        appendUInt32(data, 0);
+    }
+
+    data.append(pixels);
+    return data;
+}
+
+
+/*!
+  Returns the 4x4 blocks of one level in the given block encoding. Levels
+  smaller than a block are padded by repeating the edge pixels.
+*/
+QByteArray TextureCooker::encodeBlocks(const QImage &level,
+                                       Encoding encoding) const
+{
+    int blockSize = (encoding == Dxt5Encoding) ? 16 : 8;
+    int blocksX = (level.width() + 3) / 4;
+    int blocksY = (level.height() + 3) / 4;
+
+    QByteArray data(blocksX * blocksY * blockSize, 0);
+    uchar *out = reinterpret_cast<uchar*>(data.data());
+
+    QRgb block[16];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            for (int y = 0; y < 4; y++) {
+                int py = qMin(by * 4 + y, level.height() - 1);
+                const QRgb *line = reinterpret_cast<const QRgb*>(
+                            level.constScanLine(py));
+                for (int x = 0; x < 4; x++) {
+                    block[y * 4 + x] =
+                            line[qMin(bx * 4 + x, level.width() - 1)];
+                }
+            }
+
+            switch (encoding) {
+            case Etc1Encoding:
+                encodeEtc1Block(block, out);
+                break;
+            case Dxt1Encoding:
+                encodeDxt1Block(block, out);
+                break;
+            default:
+                encodeDxt5Block(block, out);
+                break;
+            }
+            out += blockSize;
+        }
+    }
+
+    return data;
+}
@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+ * All rights reserved.
+ *
+ * For the applicable distribution terms see the license text file included in
+ * the distribution.
+ */
+
+#ifndef TEXTURECOOKER_H
+#define TEXTURECOOKER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+
+class TextureCooker
+{
+public:
+    TextureCooker();
+
+    void setRgbaFallback(bool enabled);
+    bool rgbaFallback() const;
+
+    QByteArray cook(const QImage &image) const;
+
+protected:
+    enum Encoding {
+        Etc1Encoding,
+        Dxt1Encoding,
+        Dxt5Encoding,
+        RgbaEncoding
+    };
+
+    QList<QImage> mipChain(const QImage &image) const;
+
+    QByteArray encodePvr(const QList<QImage> &levels, Encoding encoding,
+                         bool hasAlpha) const;
+    QByteArray encodeDds(const QList<QImage> &levels,
+                         Encoding encoding) const;
+    QByteArray encodeBlocks(const QImage &level, Encoding encoding) const;
+
+protected:
+    bool m_RgbaFallback;
+};
+
+#endif // TEXTURECOOKER_H
@@ -0,0 +1,25 @@
+#
+# Copyright (c) 2011-2014 Microsoft Mobile and/or its subsidiary(-ies).
+# All rights reserved.
+#
+# For the applicable distribution terms see the license text file included in
+# the distribution.
+
+# Offline tool that cooks the game textures into .qtex containers, run it
+# on the desktop: texturecooker -o ../../gfx ../../gfx/*.png
+
+
+TARGET = texturecooker
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += \
+    main.cpp \
+    texturecooker.cpp \
+    blockencoder.cpp
+
+HEADERS += \
+    texturecooker.h \
+    blockencoder.h